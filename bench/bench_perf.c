@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+
+#include "bench_perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file bench_perf.c
+ * @brief perf_event_open() wrapper for the benchmarks.
+ */
+
+/** Column names, indexed like the event enum */
+static const char *const g_names[BENCH_PERF_EVENTS] = {
+    "cycles", "instr", "L1D-miss", "LLC-miss", "dTLB-miss", "br-miss",
+};
+
+#ifdef __linux__
+
+/**
+ * @brief Encodes a cache event.
+ *
+ * @param cache  PERF_COUNT_HW_CACHE_* cache id
+ * @param op     PERF_COUNT_HW_CACHE_OP_* operation
+ * @param result PERF_COUNT_HW_CACHE_RESULT_* result
+ * @return perf_event_attr::config value
+ */
+static uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+/**
+ * @brief Opens one counter.
+ *
+ * @param type   perf_event_attr::type
+ * @param config perf_event_attr::config
+ * @return File descriptor, or -1 if unavailable
+ */
+static int open_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return (fd < 0) ? -1 : (int)fd;
+}
+
+int bench_perf_open(bench_perf_t *p) {
+    memset(p, 0, sizeof(*p));
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        p->fd[e] = -1;
+    }
+
+    const char *env = getenv("BENCH_PERF");
+    if (env != NULL && strcmp(env, "0") == 0) {
+        return 0;
+    }
+
+    p->fd[BENCH_PERF_CYCLES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    p->fd[BENCH_PERF_INSTRUCTIONS] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    p->fd[BENCH_PERF_L1D_MISSES] = open_event(
+        PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                    PERF_COUNT_HW_CACHE_RESULT_MISS));
+    p->fd[BENCH_PERF_LLC_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    p->fd[BENCH_PERF_DTLB_MISSES] = open_event(
+        PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                    PERF_COUNT_HW_CACHE_RESULT_MISS));
+    p->fd[BENCH_PERF_BRANCH_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        p->available += p->fd[e] >= 0;
+    }
+    return p->available;
+}
+
+void bench_perf_start(bench_perf_t *p) {
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        if (p->fd[e] >= 0) {
+            ioctl(p->fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(p->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void bench_perf_stop(bench_perf_t *p) {
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        if (p->fd[e] >= 0) {
+            ioctl(p->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        // value, time enabled, time running
+        uint64_t buf[3] = {0, 0, 0};
+        p->value[e] = 0;
+        if (p->fd[e] < 0 || read(p->fd[e], buf, sizeof(buf)) !=
+                                (ssize_t)sizeof(buf)) {
+            continue;
+        }
+        p->value[e] = (buf[2] == 0 || buf[2] >= buf[1])
+                          ? buf[0]
+                          : (uint64_t)((double)buf[0] * (double)buf[1] /
+                                       (double)buf[2]);
+    }
+}
+
+void bench_perf_close(bench_perf_t *p) {
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        if (p->fd[e] >= 0) {
+            close(p->fd[e]);
+            p->fd[e] = -1;
+        }
+    }
+    p->available = 0;
+}
+
+#else /* !__linux__ */
+
+int bench_perf_open(bench_perf_t *p) {
+    memset(p, 0, sizeof(*p));
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        p->fd[e] = -1;
+    }
+    return 0;
+}
+
+void bench_perf_start(bench_perf_t *p) { (void)p; }
+
+void bench_perf_stop(bench_perf_t *p) { (void)p; }
+
+void bench_perf_close(bench_perf_t *p) { (void)p; }
+
+#endif /* __linux__ */
+
+void bench_perf_status(const bench_perf_t *p) {
+    if (p->available == 0) {
+        printf("perf counters: unavailable\n");
+        return;
+    }
+    printf("perf counters: %d of %d\n", p->available, BENCH_PERF_EVENTS);
+}
+
+void bench_perf_report(const bench_perf_t *p, size_t ops) {
+    if (p->available == 0 || ops == 0) {
+        return;
+    }
+
+    printf("%8s", "");
+    for (int e = 0; e < BENCH_PERF_EVENTS; e++) {
+        if (p->fd[e] >= 0) {
+            printf(" %s %.2f", g_names[e],
+                   (double)p->value[e] / (double)ops);
+        } else {
+            printf(" %s -", g_names[e]);
+        }
+    }
+    if (p->fd[BENCH_PERF_CYCLES] >= 0 &&
+        p->fd[BENCH_PERF_INSTRUCTIONS] >= 0 &&
+        p->value[BENCH_PERF_CYCLES] > 0) {
+        printf(" IPC %.2f", (double)p->value[BENCH_PERF_INSTRUCTIONS] /
+                                (double)p->value[BENCH_PERF_CYCLES]);
+    }
+    printf(" per op\n");
+}
@@ -0,0 +1,88 @@
+#ifndef BENCH_PERF_H
+#define BENCH_PERF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file bench_perf.h
+ * @brief Hardware performance counters around a benchmark loop.
+ *
+ * Counters are opened individually with perf_event_open(), so a CPU or
+ * kernel lacking one of them (virtual machines often have no cache or
+ * TLB events) only loses that column. When none can be opened, or when
+ * the environment variable BENCH_PERF is set to 0, all calls do nothing
+ * and bench_perf_report() prints nothing.
+ */
+
+/**
+ * @brief Measured events.
+ */
+enum {
+    BENCH_PERF_CYCLES,        /**< Core cycles */
+    BENCH_PERF_INSTRUCTIONS,  /**< Retired instructions */
+    BENCH_PERF_L1D_MISSES,    /**< L1 data cache read misses */
+    BENCH_PERF_LLC_MISSES,    /**< Last level cache misses */
+    BENCH_PERF_DTLB_MISSES,   /**< Data TLB read misses */
+    BENCH_PERF_BRANCH_MISSES, /**< Mispredicted branches */
+    BENCH_PERF_EVENTS         /**< Number of events */
+};
+
+/**
+ * @brief Open counters of one benchmark process.
+ */
+typedef struct {
+    int fd[BENCH_PERF_EVENTS];         /**< Counter fds, -1 if missing */
+    uint64_t value[BENCH_PERF_EVENTS]; /**< Counts of the last interval */
+    int available;                     /**< Number of open counters */
+} bench_perf_t;
+
+/**
+ * @brief Opens the counters for the calling thread.
+ *
+ * @param p Counters
+ * @return Number of counters opened (0 if perf events are unavailable)
+ */
+int bench_perf_open(bench_perf_t *p);
+
+/**
+ * @brief Zeroes and starts all counters.
+ *
+ * @param p Counters
+ */
+void bench_perf_start(bench_perf_t *p);
+
+/**
+ * @brief Stops the counters and stores their values.
+ *
+ * Values are scaled up if the kernel had to multiplex the counters.
+ *
+ * @param p Counters
+ */
+void bench_perf_stop(bench_perf_t *p);
+
+/**
+ * @brief Prints the last interval's counts divided by @p ops.
+ *
+ * Missing counters are shown as "-".
+ *
+ * @param p   Counters
+ * @param ops Number of operations in the interval
+ */
+void bench_perf_report(const bench_perf_t *p, size_t ops);
+
+/**
+ * @brief Prints which counters are available.
+ *
+ * @param p Counters
+ */
+void bench_perf_status(const bench_perf_t *p);
+
+/**
+ * @brief Closes the counters.
+ *
+ * @param p Counters
+ */
+void bench_perf_close(bench_perf_t *p);
+
+#endif /* BENCH_PERF_H */
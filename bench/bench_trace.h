@@ -0,0 +1,114 @@
+#ifndef BENCH_TRACE_H
+#define BENCH_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @file bench_trace.h
+ * @brief Binary file formats shared by prefix_gen and prefix_replay.
+ *
+ * A file is a bench_file_header_t followed by @c count records: a
+ * bench_prefix_t per prefix for tables, a uint32_t address per lookup for
+ * traces. Values are stored in host byte order.
+ */
+
+/** Magic number of a table file ("PFXT") */
+#define BENCH_TABLE_MAGIC 0x54584650u
+
+/** Magic number of a trace file ("PFXQ") */
+#define BENCH_TRACE_MAGIC 0x51584650u
+
+/** Current format version */
+#define BENCH_FORMAT_VERSION 1u
+
+/**
+ * @brief Header at the start of every file.
+ */
+typedef struct {
+    uint32_t magic;   /**< BENCH_TABLE_MAGIC or BENCH_TRACE_MAGIC */
+    uint32_t version; /**< BENCH_FORMAT_VERSION */
+    uint64_t count;   /**< Number of records that follow */
+} bench_file_header_t;
+
+/**
+ * @brief One prefix of a table file.
+ */
+typedef struct {
+    uint32_t base;  /**< Base address */
+    uint8_t mask;   /**< Mask length (0-32) */
+    uint8_t pad[3]; /**< Zero */
+} bench_prefix_t;
+
+/**
+ * @brief Writes a file.
+ *
+ * @param path    Output path
+ * @param magic   File type
+ * @param records Records to write
+ * @param size    Size of one record
+ * @param count   Number of records
+ * @return 0 on success, -1 on error (reported on stderr)
+ */
+static inline int bench_file_write(const char *path, uint32_t magic,
+                                   const void *records, size_t size,
+                                   uint64_t count) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    bench_file_header_t h = {magic, BENCH_FORMAT_VERSION, count};
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+             fwrite(records, size, (size_t)count, f) == (size_t)count;
+    if (fclose(f) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: write failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a whole file into memory.
+ *
+ * @param path  Input path
+ * @param magic Expected file type
+ * @param size  Size of one record
+ * @param count Set to the number of records
+ * @return Records (free() them), or NULL on error (reported on stderr)
+ */
+static inline void *bench_file_read(const char *path, uint32_t magic,
+                                    size_t size, uint64_t *count) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    bench_file_header_t h;
+    void *records = NULL;
+    if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != magic ||
+        h.version != BENCH_FORMAT_VERSION) {
+        fprintf(stderr, "%s: not a %s file\n", path,
+                (magic == BENCH_TABLE_MAGIC) ? "table" : "trace");
+    } else if ((records = malloc(h.count == 0 ? 1 : (size_t)h.count * size)) ==
+               NULL) {
+        fprintf(stderr, "%s: out of memory\n", path);
+    } else if (fread(records, size, (size_t)h.count, f) != (size_t)h.count) {
+        fprintf(stderr, "%s: truncated\n", path);
+        free(records);
+        records = NULL;
+    } else {
+        *count = h.count;
+    }
+
+    fclose(f);
+    return records;
+}
+
+#endif /* BENCH_TRACE_H */
@@ -0,0 +1,100 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file bench_util.h
+ * @brief Timing, random number and option helpers shared by the
+ * benchmarks.
+ *
+ * Files including this header must define _POSIX_C_SOURCE >= 199309L
+ * before any system header, for clock_gettime().
+ */
+
+/**
+ * @brief Reads a monotonic clock.
+ *
+ * @return Current time in nanoseconds
+ */
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Reads the CPU timestamp counter.
+ *
+ * The TSC ticks at a constant reference rate, which is close to but not
+ * always the core clock.
+ *
+ * @return Timestamp on x86, 0 elsewhere
+ */
+static inline uint64_t bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Returns the next value of a xorshift64* generator.
+ *
+ * @param state Generator state (must not be 0)
+ * @return Pseudo-random 32-bit value
+ */
+static inline uint32_t bench_rand(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/**
+ * @brief Returns the network mask for a prefix length.
+ *
+ * @param len Prefix length (0-32)
+ * @return Mask with the top @p len bits set
+ */
+static inline uint32_t bench_mask(int len) {
+    return (len == 0) ? 0 : ~0U << (32 - len);
+}
+
+/**
+ * @brief qsort() comparator for 32-bit addresses.
+ */
+static inline int bench_compare_ip(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Parses a node allocation mode argument.
+ *
+ * @param arg  "heap" or "hugepage" (NULL means heap)
+ * @param opts Set to the matching table options
+ * @return 0 on success, -1 if @p arg is not recognized
+ */
+static inline int bench_alloc_opts(const char *arg, prefix_table_opts_t *opts) {
+    opts->alloc = PREFIX_ALLOC_HEAP;
+    opts->arena_chunk = 0;
+    opts->flags = 0;
+    if (arg == NULL || strcmp(arg, "heap") == 0) {
+        return 0;
+    }
+    if (strcmp(arg, "hugepage") == 0) {
+        opts->alloc = PREFIX_ALLOC_HUGEPAGE;
+        return 0;
+    }
+    return -1;
+}
+
+#endif /* BENCH_UTIL_H */
@@ -0,0 +1,473 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench_perf.h"
+#include "bench_trace.h"
+#include "bench_util.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file pcap_bench.c
+ * @brief Lookup benchmark driven by the addresses of a packet capture.
+ *
+ * Usage: pcap_bench capture.{pcap,pcapng} [table.bin] [passes]
+ *
+ * Reads the IPv4 destination and source addresses of every packet, then
+ * times check(), check_batch() and check_all_batch() over them, and
+ * check_sorted() over a sorted copy (sorted once, before the passes). The
+ * table is a file written by prefix_gen; without one, the /24 of every
+ * captured address is added, so every lookup matches.
+ *
+ * Supported link types: Ethernet (with VLAN tags), raw IP and Linux
+ * cooked capture v1/v2. Other packets are skipped.
+ */
+
+/** Link types (see tcpdump.org/linktypes.html) */
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LINUX_SLL 113
+#define LINKTYPE_IPV4 228
+#define LINKTYPE_LINUX_SLL2 276
+
+/** Maximum number of pcapng interfaces tracked */
+#define MAX_INTERFACES 64
+
+/**
+ * @brief Addresses extracted from a capture.
+ *
+ * dst and src are the two halves of one allocation, so all addresses are
+ * contiguous.
+ */
+typedef struct {
+    uint32_t *dst;   /**< Destination addresses */
+    uint32_t *src;   /**< Source addresses */
+    size_t count;    /**< Number of IPv4 packets */
+    size_t capacity; /**< Allocated entries per half */
+    size_t skipped;  /**< Packets that were not IPv4 */
+} packets_t;
+
+/**
+ * @brief Reads a 16-bit value.
+ *
+ * @param p    Data
+ * @param swap Nonzero if the value is in the other byte order
+ * @return Value
+ */
+static uint16_t rd16(const uint8_t *p, int swap) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return swap ? (uint16_t)(v >> 8 | v << 8) : v;
+}
+
+/**
+ * @brief Reads a 32-bit value.
+ *
+ * @param p    Data
+ * @param swap Nonzero if the value is in the other byte order
+ * @return Value
+ */
+static uint32_t rd32(const uint8_t *p, int swap) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+/**
+ * @brief Reads a big-endian (network order) 16-bit value.
+ *
+ * @param p Data
+ * @return Value
+ */
+static uint16_t be16(const uint8_t *p) { return (uint16_t)(p[0] << 8 | p[1]); }
+
+/**
+ * @brief Reads a big-endian (network order) 32-bit value.
+ *
+ * @param p Data
+ * @return Value
+ */
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 |
+           p[3];
+}
+
+/**
+ * @brief Extracts the addresses of one captured frame.
+ *
+ * @param pk       Output
+ * @param linktype Link type of the frame
+ * @param data     Captured bytes
+ * @param len      Number of captured bytes
+ * @return 0 on success, -1 if out of memory
+ */
+static int add_packet(packets_t *pk, uint32_t linktype, const uint8_t *data,
+                      size_t len) {
+    size_t off;
+    uint16_t proto;
+
+    switch (linktype) {
+    case LINKTYPE_ETHERNET:
+        if (len < 14) {
+            goto skip;
+        }
+        proto = be16(data + 12);
+        off = 14;
+        // 802.1Q / 802.1ad tags
+        while ((proto == 0x8100 || proto == 0x88A8) && len >= off + 4) {
+            proto = be16(data + off + 2);
+            off += 4;
+        }
+        break;
+    case LINKTYPE_LINUX_SLL:
+        if (len < 16) {
+            goto skip;
+        }
+        proto = be16(data + 14);
+        off = 16;
+        break;
+    case LINKTYPE_LINUX_SLL2:
+        if (len < 20) {
+            goto skip;
+        }
+        proto = be16(data);
+        off = 20;
+        break;
+    case LINKTYPE_RAW:
+    case LINKTYPE_IPV4:
+        proto = 0x0800;
+        off = 0;
+        break;
+    default:
+        goto skip;
+    }
+
+    if (proto != 0x0800 || len < off + 20 || (data[off] >> 4) != 4) {
+        goto skip;
+    }
+
+    if (pk->count == pk->capacity) {
+        size_t cap = (pk->capacity == 0) ? 65536 : pk->capacity * 2;
+        uint32_t *buf = malloc(2 * cap * sizeof(uint32_t));
+        if (buf == NULL) {
+            return -1;
+        }
+        if (pk->count > 0) {
+            memcpy(buf, pk->dst, pk->count * sizeof(uint32_t));
+            memcpy(buf + cap, pk->src, pk->count * sizeof(uint32_t));
+        }
+        free(pk->dst);
+        pk->dst = buf;
+        pk->src = buf + cap;
+        pk->capacity = cap;
+    }
+    pk->src[pk->count] = be32(data + off + 12);
+    pk->dst[pk->count] = be32(data + off + 16);
+    pk->count++;
+    return 0;
+
+skip:
+    pk->skipped++;
+    return 0;
+}
+
+/**
+ * @brief Parses a classic pcap file.
+ *
+ * @param pk   Output
+ * @param buf  File contents
+ * @param size File size
+ * @return 0 on success, -1 on error
+ */
+static int parse_pcap(packets_t *pk, const uint8_t *buf, size_t size) {
+    uint32_t magic = rd32(buf, 0);
+    int swap = magic == 0xD4C3B2A1 || magic == 0x4D3CB2A1;
+    uint32_t linktype = rd32(buf + 20, swap) & 0x0FFFFFFF;
+
+    size_t pos = 24;
+    while (pos + 16 <= size) {
+        uint32_t caplen = rd32(buf + pos + 8, swap);
+        pos += 16;
+        if (caplen > size - pos) {
+            fprintf(stderr, "truncated packet, stopping\n");
+            break;
+        }
+        if (add_packet(pk, linktype, buf + pos, caplen) != 0) {
+            return -1;
+        }
+        pos += caplen;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a pcapng file.
+ *
+ * @param pk   Output
+ * @param buf  File contents
+ * @param size File size
+ * @return 0 on success, -1 on error
+ */
+static int parse_pcapng(packets_t *pk, const uint8_t *buf, size_t size) {
+    uint32_t linktypes[MAX_INTERFACES];
+    int n_if = 0;
+    int swap = 0;
+
+    size_t pos = 0;
+    while (pos + 12 <= size) {
+        uint32_t type = rd32(buf + pos, swap);
+        if (type == 0x0A0D0D0A) {
+            // Section header: byte order and interface numbering restart
+            swap = rd32(buf + pos + 8, 0) != 0x1A2B3C4D;
+            n_if = 0;
+        }
+        uint32_t len = rd32(buf + pos + 4, swap);
+        if (len < 12 || len > size - pos) {
+            fprintf(stderr, "truncated block, stopping\n");
+            break;
+        }
+        const uint8_t *body = buf + pos + 8;
+        size_t body_len = len - 12;
+
+        if (type == 1 && body_len >= 2 && n_if < MAX_INTERFACES) {
+            // Interface description
+            linktypes[n_if++] = rd16(body, swap);
+        } else if (type == 6 && body_len >= 20) {
+            // Enhanced packet
+            uint32_t ifc = rd32(body, swap);
+            uint32_t caplen = rd32(body + 12, swap);
+            if (ifc < (uint32_t)n_if && caplen <= body_len - 20 &&
+                add_packet(pk, linktypes[ifc], body + 20, caplen) != 0) {
+                return -1;
+            }
+        } else if (type == 3 && body_len >= 4 && n_if > 0) {
+            // Simple packet, always interface 0
+            uint32_t caplen = rd32(body, swap);
+            if (caplen > body_len - 4) {
+                caplen = (uint32_t)(body_len - 4);
+            }
+            if (add_packet(pk, linktypes[0], body + 4, caplen) != 0) {
+                return -1;
+            }
+        }
+        pos += len;
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads a capture file.
+ *
+ * @param path Capture path
+ * @param pk   Output
+ * @return 0 on success, -1 on error (reported on stderr)
+ */
+static int read_capture(const char *path, packets_t *pk) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *buf = (size > 0) ? malloc((size_t)size) : NULL;
+    if (buf == NULL || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "%s: cannot read\n", path);
+        fclose(f);
+        free(buf);
+        return -1;
+    }
+    fclose(f);
+
+    int ret = -1;
+    uint32_t magic = (size >= 24) ? rd32(buf, 0) : 0;
+    if (magic == 0xA1B2C3D4 || magic == 0xD4C3B2A1 || magic == 0xA1B23C4D ||
+        magic == 0x4D3CB2A1) {
+        ret = parse_pcap(pk, buf, (size_t)size);
+    } else if (magic == 0x0A0D0D0A) {
+        ret = parse_pcapng(pk, buf, (size_t)size);
+    } else {
+        fprintf(stderr, "%s: not a pcap or pcapng file\n", path);
+        free(buf);
+        return -1;
+    }
+    if (ret != 0) {
+        fprintf(stderr, "%s: out of memory after %zu packets\n", path,
+                pk->count);
+    }
+    free(buf);
+    return ret;
+}
+
+/**
+ * @brief Interval being measured.
+ */
+typedef struct {
+    bench_perf_t perf; /**< Hardware counters */
+    uint64_t ns;       /**< Start time */
+    uint64_t cycles;   /**< Start TSC */
+} measure_t;
+
+/**
+ * @brief Starts measuring an interval.
+ *
+ * @param m Measurement
+ */
+static void measure_start(measure_t *m) {
+    bench_perf_start(&m->perf);
+    m->ns = bench_now_ns();
+    m->cycles = bench_cycles();
+}
+
+/**
+ * @brief Ends an interval and prints its result line.
+ *
+ * @param m    Measurement
+ * @param name Benchmark name
+ * @param ops  Number of lookups
+ */
+static void measure_stop(measure_t *m, const char *name, size_t ops) {
+    uint64_t cycles = bench_cycles() - m->cycles;
+    uint64_t ns = bench_now_ns() - m->ns;
+    bench_perf_stop(&m->perf);
+
+    // Intervals below the clock resolution have no meaningful rate
+    printf("%-16s %10zu lookups", name, ops);
+    if (ns != 0) {
+        printf(" %8.2f Mpps", (double)ops * 1e3 / (double)ns);
+    } else {
+        printf(" %8s Mpps", "-");
+    }
+    if (cycles != 0 && ops != 0) {
+        printf(" %8.1f cycles/lookup", (double)cycles / (double)ops);
+    }
+    printf("\n");
+    bench_perf_report(&m->perf, ops);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s capture [table.bin] [passes]\n", argv[0]);
+        return 1;
+    }
+    int passes = (argc > 3) ? atoi(argv[3]) : 1;
+    if (passes <= 0) {
+        passes = 1;
+    }
+
+    packets_t pk = {NULL, NULL, 0, 0, 0};
+    if (read_capture(argv[1], &pk) != 0) {
+        // Already reported by read_capture()
+        free(pk.dst);
+        return 1;
+    }
+    if (pk.count == 0) {
+        fprintf(stderr, "%s: no IPv4 packets (%zu skipped)\n", argv[1],
+                pk.skipped);
+        free(pk.dst);
+        return 1;
+    }
+    printf("packets: %zu IPv4, %zu skipped\n", pk.count, pk.skipped);
+
+    if (prefix_mgmt_init() != 0) {
+        free(pk.dst);
+        return 1;
+    }
+    if (argc > 2) {
+        uint64_t n = 0;
+        bench_prefix_t *prefixes = bench_file_read(
+            argv[2], BENCH_TABLE_MAGIC, sizeof(bench_prefix_t), &n);
+        if (prefixes == NULL) {
+            prefix_mgmt_cleanup();
+            free(pk.dst);
+            return 1;
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            add(prefixes[i].base, (char)prefixes[i].mask);
+        }
+        free(prefixes);
+    } else {
+        for (size_t i = 0; i < pk.count; i++) {
+            add(pk.dst[i] & bench_mask(24), 24);
+            add(pk.src[i] & bench_mask(24), 24);
+        }
+    }
+
+    // Both halves, destinations first
+    size_t n_ips = 2 * pk.count;
+    uint32_t *ips = malloc(n_ips * sizeof(uint32_t));
+    uint32_t *sorted = malloc(n_ips * sizeof(uint32_t));
+    char *masks = malloc(n_ips * 33);
+    int *counts = malloc(n_ips * sizeof(int));
+    if (ips == NULL || sorted == NULL || masks == NULL || counts == NULL) {
+        fprintf(stderr, "out of memory\n");
+        prefix_mgmt_cleanup();
+        free(pk.dst);
+        free(ips);
+        free(sorted);
+        free(masks);
+        free(counts);
+        return 1;
+    }
+    memcpy(ips, pk.dst, pk.count * sizeof(uint32_t));
+    memcpy(ips + pk.count, pk.src, pk.count * sizeof(uint32_t));
+
+    uint64_t sort_ns = bench_now_ns();
+    memcpy(sorted, ips, n_ips * sizeof(uint32_t));
+    qsort(sorted, n_ips, sizeof(*sorted), bench_compare_ip);
+    sort_ns = bench_now_ns() - sort_ns;
+    printf("sorted copy: %.2f ms\n", (double)sort_ns / 1e6);
+
+    measure_t m;
+    bench_perf_open(&m.perf);
+    bench_perf_status(&m.perf);
+
+    long checksum = 0;
+    for (int p = 0; p < passes; p++) {
+        measure_start(&m);
+        for (size_t i = 0; i < pk.count; i++) {
+            checksum += check(pk.dst[i]);
+        }
+        measure_stop(&m, "check dst", pk.count);
+
+        measure_start(&m);
+        for (size_t i = 0; i < n_ips; i++) {
+            checksum += check(ips[i]);
+        }
+        measure_stop(&m, "check dst+src", n_ips);
+
+        measure_start(&m);
+        check_batch(ips, n_ips, masks);
+        measure_stop(&m, "check_batch", n_ips);
+        for (size_t i = 0; i < n_ips; i++) {
+            checksum += masks[i];
+        }
+
+        measure_start(&m);
+        check_sorted(sorted, n_ips, masks);
+        measure_stop(&m, "check_sorted", n_ips);
+        for (size_t i = 0; i < n_ips; i++) {
+            checksum += masks[i];
+        }
+
+        measure_start(&m);
+        check_all_batch(ips, n_ips, masks, 33, counts);
+        measure_stop(&m, "check_all_batch", n_ips);
+        for (size_t i = 0; i < n_ips; i++) {
+            checksum += counts[i];
+        }
+    }
+    printf("checksum: %ld\n", checksum);
+    bench_perf_close(&m.perf);
+
+    prefix_mgmt_cleanup();
+    free(pk.dst);
+    free(ips);
+    free(sorted);
+    free(masks);
+    free(counts);
+    return 0;
+}
@@ -0,0 +1,235 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench_perf.h"
+#include "bench_util.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file prefix_bench.c
+ * @brief Micro-benchmark of add(), check() and del() on random prefixes.
+ *
+ * Usage: prefix_bench [prefixes] [lookups] [heap|hugepage] [host%]
+ *        [tree|hosts|stride|hosts+stride]
+ *
+ * Half of the lookups hit a stored prefix, the other half are uniformly
+ * random addresses. The lookups are then sorted and timed again with
+ * check() ("check/s") and check_sorted() ("sorted"). host% of the
+ * prefixes are /32 (default 0, i.e. the routing-like mix below); "hosts"
+ * and "stride" create the table with #PREFIX_OPT_HOST_HASH and
+ * #PREFIX_OPT_STRIDE16. Build with CMAKE_BUILD_TYPE=Release for meaningful
+ * numbers. Hardware counters are reported per operation where the system
+ * allows perf_event_open().
+ */
+
+/**
+ * @brief Draws a random prefix length, biased towards /24 like routing
+ * tables.
+ *
+ * @param rng Generator state
+ * @return Prefix length (8-32)
+ */
+static int random_mask(uint64_t *rng) {
+    return (bench_rand(rng) % 2 == 0) ? 24 : 8 + (int)(bench_rand(rng) % 25);
+}
+
+/**
+ * @brief Parses the lookup structure argument.
+ *
+ * @param arg   "tree", "hosts", "stride" or "hosts+stride"
+ * @param flags Receives the matching PREFIX_OPT_* flags
+ * @return 0 on success, -1 if @p arg is not recognized
+ */
+static int lookup_flags(const char *arg, unsigned int *flags) {
+    static const char *const names[] = {"tree", "hosts", "stride",
+                                        "hosts+stride"};
+    for (unsigned int i = 0; i < 4; i++) {
+        if (strcmp(arg, names[i]) == 0) {
+            // Bit 0 of the index is the host set, bit 1 the stride index
+            *flags = ((i & 1) ? PREFIX_OPT_HOST_HASH : 0) |
+                     ((i & 2) ? PREFIX_OPT_STRIDE16 : 0);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Prints one result line.
+ *
+ * @param name Operation name
+ * @param ops  Number of operations
+ * @param ns   Elapsed time in nanoseconds
+ */
+static void report(const char *name, size_t ops, uint64_t ns) {
+    printf("%-8s %10zu ops %10.1f ns/op %8.2f Mops/s\n", name, ops,
+           (double)ns / (double)ops, (double)ops * 1e3 / (double)ns);
+}
+
+#ifdef PREFIX_MGMT_INSTRUMENT
+/**
+ * @brief Prints latency percentiles and mean depth of one operation.
+ *
+ * @param name Operation name
+ * @param s    Snapshot
+ * @param op   Operation
+ */
+static void report_instr(const char *name, const prefix_instr_snapshot_t *s,
+                         prefix_op_t op) {
+    const prefix_op_histogram_t *h = &s->op[op];
+    uint64_t hops = 0;
+    for (int d = 0; d < PREFIX_INSTR_DEPTH_BUCKETS; d++) {
+        hops += (uint64_t)d * h->depth[d];
+    }
+    printf("%-8s p50 %6llu p99 %6llu p99.9 %6llu %s  depth %.2f\n", name,
+           (unsigned long long)prefix_instr_percentile(h, 50.0),
+           (unsigned long long)prefix_instr_percentile(h, 99.0),
+           (unsigned long long)prefix_instr_percentile(h, 99.9),
+           s->cycles ? "cyc" : "ns",
+           (h->count == 0) ? 0.0 : (double)hops / (double)h->count);
+}
+#endif
+
+int main(int argc, char **argv) {
+    size_t n_prefixes = (argc > 1) ? strtoul(argv[1], NULL, 10) : 500000;
+    size_t n_lookups = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10000000;
+    unsigned long host_share = (argc > 4) ? strtoul(argv[4], NULL, 10) : 0;
+    const char *lookup_mode = (argc > 5) ? argv[5] : "tree";
+    prefix_table_opts_t opts;
+    unsigned int flags = 0;
+    if (n_prefixes == 0 || n_lookups == 0 || host_share > 100 ||
+        bench_alloc_opts((argc > 3) ? argv[3] : NULL, &opts) != 0 ||
+        lookup_flags(lookup_mode, &flags) != 0) {
+        fprintf(stderr,
+                "usage: %s [prefixes] [lookups] [heap|hugepage] [host%%] "
+                "[tree|hosts|stride|hosts+stride]\n",
+                argv[0]);
+        return 1;
+    }
+    opts.flags = flags;
+
+    unsigned int *bases = malloc(n_prefixes * sizeof(*bases));
+    char *masks = malloc(n_prefixes);
+    unsigned int *ips = malloc(n_lookups * sizeof(*ips));
+    if (bases == NULL || masks == NULL || ips == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n_prefixes; i++) {
+        masks[i] = (bench_rand(&rng) % 100 < host_share)
+                       ? 32
+                       : (char)random_mask(&rng);
+        bases[i] = bench_rand(&rng) & bench_mask(masks[i]);
+    }
+    for (size_t i = 0; i < n_lookups; i++) {
+        unsigned int r = bench_rand(&rng);
+        if (i % 2 == 0) {
+            size_t p = bench_rand(&rng) % n_prefixes;
+            ips[i] = bases[p] | (r & ~bench_mask(masks[p]));
+        } else {
+            ips[i] = r;
+        }
+    }
+
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    printf("hit counters: on\n");
+#else
+    printf("hit counters: off\n");
+#endif
+
+    bench_perf_t perf;
+    bench_perf_open(&perf);
+    bench_perf_status(&perf);
+
+    printf("node allocation: %s\n",
+           (opts.alloc == PREFIX_ALLOC_HUGEPAGE) ? "hugepage" : "heap");
+    printf("/32 prefixes: %lu%%, lookup structures: %s\n", host_share,
+           lookup_mode);
+
+    if (prefix_mgmt_init_ex(&opts) != 0) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+
+    bench_perf_start(&perf);
+    uint64_t t0 = bench_now_ns();
+    for (size_t i = 0; i < n_prefixes; i++) {
+        add(bases[i], masks[i]);
+    }
+    uint64_t ns = bench_now_ns() - t0;
+    bench_perf_stop(&perf);
+    report("add", n_prefixes, ns);
+    bench_perf_report(&perf, n_prefixes);
+
+    long checksum = 0;
+    bench_perf_start(&perf);
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < n_lookups; i++) {
+        checksum += check(ips[i]);
+    }
+    ns = bench_now_ns() - t0;
+    bench_perf_stop(&perf);
+    report("check", n_lookups, ns);
+    bench_perf_report(&perf, n_lookups);
+
+    // The same lookups in ascending order, one by one and as a sorted batch
+    qsort(ips, n_lookups, sizeof(*ips), bench_compare_ip);
+    long sorted_checksum = 0;
+    bench_perf_start(&perf);
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < n_lookups; i++) {
+        sorted_checksum += check(ips[i]);
+    }
+    ns = bench_now_ns() - t0;
+    bench_perf_stop(&perf);
+    report("check/s", n_lookups, ns);
+    bench_perf_report(&perf, n_lookups);
+
+    char *results = malloc(n_lookups);
+    if (results != NULL) {
+        bench_perf_start(&perf);
+        t0 = bench_now_ns();
+        check_sorted(ips, n_lookups, results);
+        ns = bench_now_ns() - t0;
+        bench_perf_stop(&perf);
+        report("sorted", n_lookups, ns);
+        bench_perf_report(&perf, n_lookups);
+        for (size_t i = 0; i < n_lookups; i++) {
+            sorted_checksum -= results[i];
+        }
+        free(results);
+    }
+
+    bench_perf_start(&perf);
+    t0 = bench_now_ns();
+    for (size_t i = 0; i < n_prefixes; i++) {
+        del(bases[i], masks[i]);
+    }
+    ns = bench_now_ns() - t0;
+    bench_perf_stop(&perf);
+    report("del", n_prefixes, ns);
+    bench_perf_report(&perf, n_prefixes);
+    bench_perf_close(&perf);
+
+    printf("checksum: %ld%s\n", checksum,
+           (sorted_checksum == 0) ? "" : " (sorted batch differs)");
+
+#ifdef PREFIX_MGMT_INSTRUMENT
+    prefix_instr_snapshot_t snap;
+    if (prefix_table_instr_snapshot(prefix_mgmt_table(), &snap) == 0) {
+        report_instr("add", &snap, PREFIX_OP_ADD);
+        report_instr("check", &snap, PREFIX_OP_CHECK);
+        report_instr("del", &snap, PREFIX_OP_DEL);
+    }
+#endif
+
+    prefix_mgmt_cleanup();
+    free(bases);
+    free(masks);
+    free(ips);
+    return 0;
+}
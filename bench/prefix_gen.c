@@ -0,0 +1,351 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench_trace.h"
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @file prefix_gen.c
+ * @brief Generator of BGP-like prefix tables and lookup traces.
+ *
+ * Usage:
+ *   prefix_gen table [-n prefixes] [-s seed] [-N nested] -o table.bin
+ *   prefix_gen trace -t table.bin [-n lookups] [-s seed] [-l locality]
+ *                    [-w flows] [-m miss] -o trace.bin
+ *
+ * Tables follow the mask length distribution of the public IPv4 routing
+ * table (about 60% /24, most of the rest /16-/23). Prefixes are clustered
+ * in provider blocks of skewed popularity, and a share of them are more
+ * specifics of earlier prefixes.
+ *
+ * Traces model flows: a lookup repeats an active flow with probability
+ * @c locality, otherwise it starts a new flow, which replaces a random
+ * active one. New flows go to an address inside a random table prefix,
+ * or with probability @c miss to a uniformly random address.
+ */
+
+/**
+ * @brief Share of each mask length in a full routing table, per 100000.
+ */
+static const unsigned int g_mask_weight[33] = {
+    0,    0,    0,    0,    0,     0,     0,     0,     2, /* /0-/8 */
+    2,    5,    12,   35,   70,    130,   230,   1400,     /* /9-/16 */
+    850,  1450, 2600, 4200, 4600,  11600, 10500, 62300,    /* /17-/24 */
+    2,    2,    2,    2,    2,     2,     0,     2,        /* /25-/32 */
+};
+
+/**
+ * @brief Draws a mask length from the routing table distribution.
+ *
+ * @param rng Generator state
+ * @return Mask length (8-32)
+ */
+static int draw_mask(uint64_t *rng) {
+    unsigned int r = bench_rand(rng) % 100000;
+    for (int m = 0; m <= 32; m++) {
+        if (r < g_mask_weight[m]) {
+            return m;
+        }
+        r -= g_mask_weight[m];
+    }
+    return 24;
+}
+
+/**
+ * @brief Draws a random unicast address (1.0.0.0-223.255.255.255 without
+ * 10/8 and 127/8).
+ *
+ * @param rng Generator state
+ * @return Address
+ */
+static uint32_t draw_unicast(uint64_t *rng) {
+    for (;;) {
+        uint32_t a = bench_rand(rng);
+        uint32_t first = a >> 24;
+        if (first != 0 && first != 10 && first != 127 && first < 224) {
+            return a;
+        }
+    }
+}
+
+/**
+ * @brief Set of (base, mask) pairs used to drop duplicate prefixes.
+ */
+typedef struct {
+    uint64_t *slot; /**< Open-addressing table, 0 = empty */
+    size_t mask;    /**< Number of slots minus one */
+} prefix_set_t;
+
+/**
+ * @brief Adds a prefix to the set.
+ *
+ * @param s    Set
+ * @param base Base address
+ * @param mask Mask length
+ * @return 1 if the prefix was new, 0 if it was already present
+ */
+static int set_insert(prefix_set_t *s, uint32_t base, int mask) {
+    uint64_t key = ((uint64_t)base << 6 | (uint64_t)mask) + 1;
+    size_t i = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 20) & s->mask;
+    while (s->slot[i] != 0) {
+        if (s->slot[i] == key) {
+            return 0;
+        }
+        i = (i + 1) & s->mask;
+    }
+    s->slot[i] = key;
+    return 1;
+}
+
+/**
+ * @brief Generates a table.
+ *
+ * @param out    Receives @p n prefixes
+ * @param n      Number of prefixes
+ * @param nested Probability of generating a more specific of an earlier
+ *               prefix
+ * @param rng    Generator state
+ * @return 0 on success, -1 if out of memory
+ */
+static int gen_table(bench_prefix_t *out, size_t n, double nested,
+                     uint64_t *rng) {
+    // Provider blocks: /12-/19 aggregates, popularity ~ 1/rank
+    size_t n_blocks = n / 64 + 1;
+    uint32_t *block_base = malloc(n_blocks * sizeof(uint32_t));
+    int *block_mask = malloc(n_blocks * sizeof(int));
+    double *block_cdf = malloc(n_blocks * sizeof(double));
+
+    prefix_set_t seen = {NULL, 0};
+    size_t slots = 1;
+    while (slots < 2 * n) {
+        slots <<= 1;
+    }
+    seen.slot = calloc(slots, sizeof(uint64_t));
+    seen.mask = slots - 1;
+
+    if (block_base == NULL || block_mask == NULL || block_cdf == NULL ||
+        seen.slot == NULL) {
+        free(block_base);
+        free(block_mask);
+        free(block_cdf);
+        free(seen.slot);
+        return -1;
+    }
+
+    double total = 0;
+    for (size_t b = 0; b < n_blocks; b++) {
+        block_mask[b] = 12 + (int)(bench_rand(rng) % 8);
+        block_base[b] = draw_unicast(rng) & bench_mask(block_mask[b]);
+        total += 1.0 / (double)(b + 1);
+        block_cdf[b] = total;
+    }
+
+    size_t count = 0;
+    while (count < n) {
+        int mask = draw_mask(rng);
+        uint32_t base;
+
+        const bench_prefix_t *parent =
+            (count > 0 && (double)bench_rand(rng) / 4294967296.0 < nested)
+                ? &out[bench_rand(rng) % count]
+                : NULL;
+
+        if (parent != NULL && parent->mask < 24) {
+            // More specific of an existing prefix, down to /24
+            if (mask <= parent->mask) {
+                mask = parent->mask + 1 +
+                       (int)(bench_rand(rng) % (unsigned)(24 - parent->mask));
+            }
+            base = parent->base | (bench_rand(rng) & ~bench_mask(parent->mask));
+        } else {
+            // Binary search the block with the drawn popularity
+            double r = (double)bench_rand(rng) / 4294967296.0 * total;
+            size_t lo = 0, hi = n_blocks - 1;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (block_cdf[mid] < r) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            base = (mask < block_mask[lo])
+                       ? draw_unicast(rng)
+                       : block_base[lo] | (bench_rand(rng) &
+                                           ~bench_mask(block_mask[lo]));
+        }
+
+        base &= bench_mask(mask);
+        if (set_insert(&seen, base, mask)) {
+            out[count].base = base;
+            out[count].mask = (uint8_t)mask;
+            memset(out[count].pad, 0, sizeof(out[count].pad));
+            count++;
+        }
+    }
+
+    free(block_base);
+    free(block_mask);
+    free(block_cdf);
+    free(seen.slot);
+    return 0;
+}
+
+/**
+ * @brief Generates a lookup trace.
+ *
+ * @param out      Receives @p n addresses
+ * @param n        Number of lookups
+ * @param table    Prefixes new flows are directed to
+ * @param n_table  Number of prefixes (can be 0)
+ * @param locality Probability of repeating an active flow
+ * @param n_flows  Number of active flows
+ * @param miss     Probability of a new flow going to a random address
+ * @param rng      Generator state
+ * @return 0 on success, -1 if out of memory
+ */
+static int gen_trace(uint32_t *out, size_t n, const bench_prefix_t *table,
+                     size_t n_table, double locality, size_t n_flows,
+                     double miss, uint64_t *rng) {
+    uint32_t *flows = malloc(n_flows * sizeof(uint32_t));
+    if (flows == NULL) {
+        return -1;
+    }
+    size_t active = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        double u = (double)bench_rand(rng) / 4294967296.0;
+        if (active > 0 && u < locality) {
+            // Skewed towards low indices: a few flows dominate
+            double r = (double)bench_rand(rng) / 4294967296.0;
+            out[i] = flows[(size_t)(r * r * (double)active)];
+            continue;
+        }
+
+        uint32_t ip;
+        if (n_table == 0 || (double)bench_rand(rng) / 4294967296.0 < miss) {
+            ip = bench_rand(rng);
+        } else {
+            const bench_prefix_t *p = &table[bench_rand(rng) % n_table];
+            ip = p->base | (bench_rand(rng) & ~bench_mask(p->mask));
+        }
+
+        if (active < n_flows) {
+            flows[active++] = ip;
+        } else {
+            flows[bench_rand(rng) % n_flows] = ip;
+        }
+        out[i] = ip;
+    }
+
+    free(flows);
+    return 0;
+}
+
+/**
+ * @brief Prints usage and returns the exit code for bad arguments.
+ *
+ * @param prog Program name
+ * @return 1
+ */
+static int usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s table [-n prefixes] [-s seed] [-N nested] -o file\n"
+            "       %s trace -t table [-n lookups] [-s seed] [-l locality]\n"
+            "                [-w flows] [-m miss] -o file\n",
+            prog, prog);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 ||
+        (strcmp(argv[1], "table") != 0 && strcmp(argv[1], "trace") != 0)) {
+        return usage(argv[0]);
+    }
+    int is_table = strcmp(argv[1], "table") == 0;
+
+    size_t n = is_table ? 900000 : 10000000;
+    uint64_t seed = 1;
+    double nested = 0.4;
+    double locality = 0.9;
+    size_t n_flows = 65536;
+    double miss = 0.05;
+    const char *table_path = NULL;
+    const char *out_path = NULL;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "n:s:N:t:l:w:m:o:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+        case 'N':
+            nested = strtod(optarg, NULL);
+            break;
+        case 't':
+            table_path = optarg;
+            break;
+        case 'l':
+            locality = strtod(optarg, NULL);
+            break;
+        case 'w':
+            n_flows = strtoul(optarg, NULL, 10);
+            break;
+        case 'm':
+            miss = strtod(optarg, NULL);
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            return usage(argv[0]);
+        }
+    }
+    if (out_path == NULL || n == 0 || n_flows == 0 ||
+        (!is_table && table_path == NULL)) {
+        return usage(argv[0]);
+    }
+
+    // xorshift state must not be zero
+    uint64_t rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+
+    if (is_table) {
+        bench_prefix_t *prefixes = malloc(n * sizeof(bench_prefix_t));
+        if (prefixes == NULL || gen_table(prefixes, n, nested, &rng) != 0) {
+            fprintf(stderr, "out of memory\n");
+            free(prefixes);
+            return 1;
+        }
+        int ret = bench_file_write(out_path, BENCH_TABLE_MAGIC, prefixes,
+                                   sizeof(bench_prefix_t), n);
+        free(prefixes);
+        return (ret == 0) ? 0 : 1;
+    }
+
+    uint64_t n_table = 0;
+    bench_prefix_t *table = bench_file_read(table_path, BENCH_TABLE_MAGIC,
+                                            sizeof(bench_prefix_t), &n_table);
+    if (table == NULL) {
+        return 1;
+    }
+    uint32_t *ips = malloc(n * sizeof(uint32_t));
+    if (ips == NULL || gen_trace(ips, n, table, (size_t)n_table, locality,
+                                 n_flows, miss, &rng) != 0) {
+        fprintf(stderr, "out of memory\n");
+        free(table);
+        free(ips);
+        return 1;
+    }
+    int ret =
+        bench_file_write(out_path, BENCH_TRACE_MAGIC, ips, sizeof(uint32_t), n);
+    free(table);
+    free(ips);
+    return (ret == 0) ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench_perf.h"
+#include "bench_trace.h"
+#include "bench_util.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file prefix_replay.c
+ * @brief Replays a lookup trace against a table written by prefix_gen.
+ *
+ * Usage: prefix_replay table.bin trace.bin [passes] [heap|hugepage]
+ *                      [none|dfs|bfs|veb|hot]
+ *
+ * Adds every prefix of the table, optionally re-lays out the nodes,
+ * prints the resulting tree shape, then times check() over the trace
+ * @c passes times. With @c hot, lookups are sampled and the table is
+ * reordered by visit frequency after every pass. Finally a succinct copy
+ * of the table is built and timed over the trace once.
+ */
+
+/** Layout argument value selecting profile-guided reordering */
+#define LAYOUT_HOT 100
+
+/**
+ * @brief Parses the layout argument.
+ *
+ * @param arg    "none", "dfs", "bfs", "veb", "hot" or NULL (= "none")
+ * @param layout Set to the layout, #LAYOUT_HOT or -1 for "none"
+ * @return 0 on success, -1 if @p arg is unknown
+ */
+static int parse_layout(const char *arg, int *layout) {
+    if (arg == NULL || strcmp(arg, "none") == 0) {
+        *layout = -1;
+    } else if (strcmp(arg, "dfs") == 0) {
+        *layout = PREFIX_LAYOUT_DFS;
+    } else if (strcmp(arg, "bfs") == 0) {
+        *layout = PREFIX_LAYOUT_BFS;
+    } else if (strcmp(arg, "veb") == 0) {
+        *layout = PREFIX_LAYOUT_VEB;
+    } else if (strcmp(arg, "hot") == 0) {
+        *layout = LAYOUT_HOT;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    prefix_table_opts_t opts;
+    int layout;
+    if (argc < 3 ||
+        bench_alloc_opts((argc > 4) ? argv[4] : NULL, &opts) != 0 ||
+        parse_layout((argc > 5) ? argv[5] : NULL, &layout) != 0) {
+        fprintf(stderr,
+                "usage: %s table.bin trace.bin [passes] [heap|hugepage] "
+                "[none|dfs|bfs|veb|hot]\n",
+                argv[0]);
+        return 1;
+    }
+    int passes = (argc > 3) ? atoi(argv[3]) : 1;
+    if (passes <= 0) {
+        passes = 1;
+    }
+
+    uint64_t n_prefixes = 0;
+    uint64_t n_lookups = 0;
+    bench_prefix_t *prefixes = bench_file_read(
+        argv[1], BENCH_TABLE_MAGIC, sizeof(bench_prefix_t), &n_prefixes);
+    uint32_t *ips = bench_file_read(argv[2], BENCH_TRACE_MAGIC,
+                                    sizeof(uint32_t), &n_lookups);
+    if (prefixes == NULL || ips == NULL || prefix_mgmt_init_ex(&opts) != 0) {
+        free(prefixes);
+        free(ips);
+        return 1;
+    }
+
+    bench_perf_t perf;
+    bench_perf_open(&perf);
+    bench_perf_status(&perf);
+
+    bench_perf_start(&perf);
+    uint64_t t0 = bench_now_ns();
+    for (uint64_t i = 0; i < n_prefixes; i++) {
+        if (add(prefixes[i].base, (char)prefixes[i].mask) != 0) {
+            fprintf(stderr, "add failed at prefix %llu\n",
+                    (unsigned long long)i);
+            break;
+        }
+    }
+    uint64_t ns = bench_now_ns() - t0;
+    bench_perf_stop(&perf);
+    printf("add      %10llu ops %10.1f ns/op\n",
+           (unsigned long long)n_prefixes,
+           (n_prefixes == 0) ? 0.0 : (double)ns / (double)n_prefixes);
+    bench_perf_report(&perf, (size_t)n_prefixes);
+
+    if (layout == LAYOUT_HOT) {
+        if (prefix_mgmt_profile_start(16, 65536) != 0) {
+            fprintf(stderr, "profiling failed\n");
+        }
+    } else if (layout >= 0) {
+        t0 = bench_now_ns();
+        if (prefix_mgmt_relayout((prefix_layout_t)layout) != 0) {
+            fprintf(stderr, "relayout failed\n");
+        }
+        printf("relayout %10.1f ms\n", (double)(bench_now_ns() - t0) / 1e6);
+    }
+
+    prefix_stats_t st;
+    memset(&st, 0, sizeof(st));
+    if (prefix_mgmt_stats(&st, PREFIX_STATS_DEPTH) == 0) {
+        printf("table    %zu prefixes, %zu nodes, %zu bytes, depth avg %.2f "
+               "max %d\n",
+               st.prefixes, st.nodes, st.bytes, st.avg_depth, st.max_depth);
+    }
+
+    long checksum = 0;
+    for (int p = 0; p < passes; p++) {
+        bench_perf_start(&perf);
+        t0 = bench_now_ns();
+        for (uint64_t i = 0; i < n_lookups; i++) {
+            checksum += check(ips[i]);
+        }
+        ns = bench_now_ns() - t0;
+        bench_perf_stop(&perf);
+        printf("check    %10llu ops %10.1f ns/op %8.2f Mops/s\n",
+               (unsigned long long)n_lookups,
+               (n_lookups == 0) ? 0.0 : (double)ns / (double)n_lookups,
+               (ns == 0) ? 0.0 : (double)n_lookups * 1e3 / (double)ns);
+        bench_perf_report(&perf, (size_t)n_lookups);
+
+        prefix_reorder_report_t r;
+        if (layout == LAYOUT_HOT && prefix_mgmt_reorder(&r) == 0) {
+            printf("reorder  %zu samples, %zu nodes visited, 50/90/99%% of "
+                   "visits in %zu/%zu/%zu nodes\n"
+                   "         lines %.2f -> %.2f, pages %.2f -> %.2f, "
+                   "walk %.1f -> %.1f ns\n",
+                   r.samples, r.visited_nodes, r.hot_nodes_50,
+                   r.hot_nodes_90, r.hot_nodes_99, r.lines_before,
+                   r.lines_after, r.pages_before, r.pages_after, r.ns_before,
+                   r.ns_after);
+        }
+    }
+    printf("checksum: %ld\n", checksum);
+
+    prefix_succinct_t *succinct = prefix_succinct_build(prefix_mgmt_table());
+    if (succinct != NULL) {
+        size_t n = prefix_succinct_prefixes(succinct);
+        size_t bytes = prefix_succinct_bytes(succinct);
+        printf("succinct %zu bytes, %.2f bytes/prefix (tree %.2f)\n", bytes,
+               (n == 0) ? 0.0 : (double)bytes / (double)n,
+               (st.prefixes == 0) ? 0.0
+                                  : (double)st.bytes / (double)st.prefixes);
+
+        long succinct_sum = 0;
+        bench_perf_start(&perf);
+        t0 = bench_now_ns();
+        for (uint64_t i = 0; i < n_lookups; i++) {
+            succinct_sum += prefix_succinct_check(succinct, ips[i]);
+        }
+        ns = bench_now_ns() - t0;
+        bench_perf_stop(&perf);
+        printf("succinct %10llu ops %10.1f ns/op %8.2f Mops/s%s\n",
+               (unsigned long long)n_lookups,
+               (n_lookups == 0) ? 0.0 : (double)ns / (double)n_lookups,
+               (ns == 0) ? 0.0 : (double)n_lookups * 1e3 / (double)ns,
+               (succinct_sum * passes == checksum) ? "" : " MISMATCH");
+        bench_perf_report(&perf, (size_t)n_lookups);
+        prefix_succinct_destroy(succinct);
+    }
+    bench_perf_close(&perf);
+
+    prefix_mgmt_cleanup();
+    free(prefixes);
+    free(ips);
+    return 0;
+}
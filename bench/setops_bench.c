@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench_trace.h"
+#include "bench_util.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @file setops_bench.c
+ * @brief Times prefix_table_combine() against add()/del() loops.
+ *
+ * Usage: setops_bench a.bin b.bin [heap|hugepage]
+ *
+ * Loads two tables written by prefix_gen, then computes each set
+ * operation twice: once with prefix_table_combine() and once the way a
+ * caller without it would, by adding and deleting prefixes one at a time
+ * (union in address mode is followed by an aggregation). The prefix
+ * counts of both results are printed so they can be compared.
+ */
+
+/**
+ * @brief Returns true if a table stores exactly the given prefix.
+ */
+static int has_prefix(const prefix_table_t *table, unsigned int base,
+                      char mask) {
+    prefix_iter_t it;
+    unsigned int b;
+    char m;
+    return prefix_iter_seek(&it, table, base, mask) == 0 &&
+           prefix_iter_next(&it, &b, &m) && b == base && m == mask;
+}
+
+/**
+ * @brief Adds every prefix of a file to a table.
+ */
+static void add_all(prefix_table_t *table, const bench_prefix_t *prefixes,
+                    uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+        prefix_table_add(table, prefixes[i].base, (char)prefixes[i].mask);
+    }
+}
+
+/**
+ * @brief Computes an operation with add() and del() calls.
+ *
+ * @param pa   Prefixes of the first operand
+ * @param na   Number of prefixes in @p pa
+ * @param pb   Prefixes of the second operand
+ * @param nb   Number of prefixes in @p pb
+ * @param tb   Second operand as a table, for lookups
+ * @param op   Operation
+ * @param mode Set elements (only union supports addresses)
+ * @param out  Empty table receiving the result
+ */
+static void loop_op(const bench_prefix_t *pa, uint64_t na,
+                    const bench_prefix_t *pb, uint64_t nb,
+                    const prefix_table_t *tb, prefix_set_op_t op,
+                    prefix_set_mode_t mode, prefix_table_t *out) {
+    switch (op) {
+    case PREFIX_SET_UNION:
+        add_all(out, pa, na);
+        add_all(out, pb, nb);
+        if (mode == PREFIX_SET_ADDRESSES) {
+            prefix_table_aggregate(out, out, PREFIX_AGGREGATE_MATCH, NULL);
+        }
+        break;
+    case PREFIX_SET_INTERSECT:
+        for (uint64_t i = 0; i < na; i++) {
+            if (has_prefix(tb, pa[i].base, (char)pa[i].mask)) {
+                prefix_table_add(out, pa[i].base, (char)pa[i].mask);
+            }
+        }
+        break;
+    case PREFIX_SET_DIFF:
+        add_all(out, pa, na);
+        for (uint64_t i = 0; i < nb; i++) {
+            prefix_table_del(out, pb[i].base, (char)pb[i].mask);
+        }
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    prefix_table_opts_t opts;
+    if (argc < 3 ||
+        bench_alloc_opts((argc > 3) ? argv[3] : NULL, &opts) != 0) {
+        fprintf(stderr, "usage: %s a.bin b.bin [heap|hugepage]\n", argv[0]);
+        return 1;
+    }
+
+    uint64_t na = 0;
+    uint64_t nb = 0;
+    bench_prefix_t *pa = bench_file_read(argv[1], BENCH_TABLE_MAGIC,
+                                         sizeof(bench_prefix_t), &na);
+    bench_prefix_t *pb = bench_file_read(argv[2], BENCH_TABLE_MAGIC,
+                                         sizeof(bench_prefix_t), &nb);
+    prefix_table_t *a = prefix_table_create_ex(&opts);
+    prefix_table_t *b = prefix_table_create_ex(&opts);
+    if (pa == NULL || pb == NULL || a == NULL || b == NULL) {
+        free(pa);
+        free(pb);
+        prefix_table_destroy(a);
+        prefix_table_destroy(b);
+        return 1;
+    }
+    add_all(a, pa, na);
+    add_all(b, pb, nb);
+
+    prefix_stats_t sa;
+    prefix_stats_t sb;
+    prefix_table_stats(a, &sa, 0);
+    prefix_table_stats(b, &sb, 0);
+    printf("a        %zu prefixes, %zu nodes\n", sa.prefixes, sa.nodes);
+    printf("b        %zu prefixes, %zu nodes\n", sb.prefixes, sb.nodes);
+
+    static const char *const op_names[] = {"union", "intersect", "diff"};
+    static const char *const mode_names[] = {"prefixes", "addresses"};
+    for (int mode = PREFIX_SET_PREFIXES; mode <= PREFIX_SET_ADDRESSES;
+         mode++) {
+        for (int op = PREFIX_SET_UNION; op <= PREFIX_SET_DIFF; op++) {
+            prefix_table_t *out = prefix_table_create_ex(&opts);
+            uint64_t t0 = bench_now_ns();
+            int ret = prefix_table_combine(a, b, out, (prefix_set_op_t)op,
+                                           (prefix_set_mode_t)mode);
+            uint64_t combine_ns = bench_now_ns() - t0;
+            prefix_stats_t so;
+            prefix_table_stats(out, &so, 0);
+            printf("%-9s %-9s combine %8.1f ms %8zu prefixes%s\n",
+                   op_names[op], mode_names[mode], (double)combine_ns / 1e6,
+                   so.prefixes, (ret == 0) ? "" : " (failed)");
+            prefix_table_destroy(out);
+
+            // No one-prefix-at-a-time equivalent for these two
+            if (mode == PREFIX_SET_ADDRESSES && op != PREFIX_SET_UNION) {
+                continue;
+            }
+            out = prefix_table_create_ex(&opts);
+            t0 = bench_now_ns();
+            loop_op(pa, na, pb, nb, b, (prefix_set_op_t)op,
+                    (prefix_set_mode_t)mode, out);
+            uint64_t loop_ns = bench_now_ns() - t0;
+            prefix_table_stats(out, &so, 0);
+            printf("%-9s %-9s loop    %8.1f ms %8zu prefixes\n",
+                   op_names[op], mode_names[mode], (double)loop_ns / 1e6,
+                   so.prefixes);
+            prefix_table_destroy(out);
+        }
+    }
+
+    prefix_table_destroy(a);
+    prefix_table_destroy(b);
+    free(pa);
+    free(pb);
+    return 0;
+}
@@ -2,6 +2,8 @@
 #define PREFIX_MGMT_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @file prefix_mgmt.h
@@ -37,6 +39,13 @@ extern "C" {
  *
  * @var radix_node::mask
  * Prefix length (0-32) if is_prefix is true, -1 otherwise
+ *
+ * @var radix_node::covered
+ * Addresses of the node's range matched by a prefix at or below the node
+ * (not maintained in the root)
+ *
+ * @var radix_node::id
+ * Index of the node's hit counters (only with PREFIX_MGMT_HIT_COUNTERS)
  */
 typedef struct radix_node {
     struct radix_node *left;  /**< Child for bit sequence starting with 0 */
@@ -47,6 +56,11 @@ typedef struct radix_node {
 
     bool is_prefix; /**< True if this represents a complete prefix */
     char mask;      /**< Mask length if is_prefix is true */
+
+    unsigned int covered; /**< Covered addresses below this node */
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    unsigned int id; /**< Index of the node's hit counters */
+#endif
 } radix_node_t;
 
 /**
@@ -90,6 +104,15 @@ int add(unsigned int base, char mask);
  */
 int del(unsigned int base, char mask);
 
+/**
+ * @brief Removes an IPv4 prefix and every longer prefix inside it.
+ *
+ * @param base  Base address of the covering prefix
+ * @param mask  Mask length (0–32)
+ * @return Number of prefixes removed, -1 on invalid arguments
+ */
+int del_covered(unsigned int base, char mask);
+
 /**
  * @brief Checks if the given IP address is contained within any stored prefix.
  *
@@ -101,6 +124,1100 @@ int del(unsigned int base, char mask);
  */
 char check(unsigned int ip);
 
+/**
+ * @brief prefix_table_check_batch() on the global table.
+ *
+ * @param ips       Addresses to check
+ * @param n         Number of addresses
+ * @param masks_out Receives the result for ips[i] in masks_out[i]
+ * @return 0 on success, -1 on invalid arguments
+ */
+int check_batch(const unsigned int *ips, size_t n, char *masks_out);
+
+/**
+ * @brief prefix_table_check_sorted() on the global table.
+ *
+ * @param ips       Addresses to check, preferably in ascending order
+ * @param n         Number of addresses
+ * @param masks_out Receives the result for ips[i] in masks_out[i]
+ * @return 0 on success, -1 on invalid arguments
+ */
+int check_sorted(const unsigned int *ips, size_t n, char *masks_out);
+
+/**
+ * @brief Opaque handle to an independent prefix collection.
+ *
+ * The global functions above (add(), del(), check(), ...) operate on a
+ * single table created by prefix_mgmt_init(). The prefix_table_* functions
+ * below do the same on a caller-owned table, so several collections can
+ * exist side by side.
+ */
+typedef struct prefix_table prefix_table_t;
+
+/**
+ * @brief Creates an empty prefix table.
+ *
+ * @return New table, or NULL if memory allocation fails
+ */
+prefix_table_t *prefix_table_create(void);
+
+/**
+ * @brief Where a table allocates its nodes from.
+ */
+typedef enum {
+    PREFIX_ALLOC_HEAP = 0,    /**< One calloc() per node */
+    PREFIX_ALLOC_HUGEPAGE = 1 /**< Arena of 2 MB pages */
+} prefix_alloc_mode_t;
+
+/**
+ * @brief Table option flag: keep /32 prefixes in a hash set as well.
+ *
+ * check() probes the set first, so an address stored as a host prefix is
+ * found with one probe instead of a walk to the bottom of the tree. Other
+ * addresses pay for the probe before the tree walk. The tree still holds
+ * every prefix, so all other functions are unaffected.
+ *
+ * Ignored when built with PREFIX_MGMT_HIT_COUNTERS: check() then walks the
+ * tree to count the hit on the matching node, so the set is not built.
+ */
+#define PREFIX_OPT_HOST_HASH 1u
+
+/**
+ * @brief Table option flag: index the tree by the first 16 address bits.
+ *
+ * A 65536-entry array records, for every /16, the deepest node reached
+ * within the first 16 bits and the longest match found up to there.
+ * check() resumes the walk from that entry instead of the root. add(),
+ * del() and the other operations keep the index current. Costs 1 MB per
+ * table.
+ *
+ * Ignored when built with PREFIX_MGMT_HIT_COUNTERS, like
+ * #PREFIX_OPT_HOST_HASH: check() walks from the root to count the hits on
+ * the nodes within the first 16 bits too.
+ */
+#define PREFIX_OPT_STRIDE16 2u
+
+/**
+ * @brief Options for prefix_table_create_ex().
+ *
+ * A zero-initialized struct gives the same table as prefix_table_create().
+ * The arena growth step is rounded up to a multiple of 2 MB.
+ */
+typedef struct {
+    prefix_alloc_mode_t alloc; /**< Node allocation mode */
+    size_t arena_chunk;        /**< Arena growth step in bytes (0 = 2 MB) */
+    unsigned int flags;        /**< PREFIX_OPT_* flags, or 0 */
+} prefix_table_opts_t;
+
+/**
+ * @brief Creates an empty prefix table with the given options.
+ *
+ * With #PREFIX_ALLOC_HUGEPAGE nodes are carved out of large chunks mapped
+ * with MAP_HUGETLB, so a lookup touching many nodes needs few TLB
+ * entries. If no huge pages are reserved, chunks are 2 MB aligned normal
+ * memory marked with madvise(MADV_HUGEPAGE) for transparent huge pages.
+ * Freed nodes are reused; memory goes back to the system only when the
+ * table is destroyed.
+ *
+ * @param opts Options (NULL for defaults)
+ * @return New table, or NULL if @p opts is invalid (unknown mode or flag)
+ *         or memory allocation fails
+ */
+prefix_table_t *prefix_table_create_ex(const prefix_table_opts_t *opts);
+
+/**
+ * @brief Initializes the prefix management system with table options.
+ *
+ * Like prefix_mgmt_init(), but the global table is created with
+ * prefix_table_create_ex().
+ *
+ * @param opts Options (NULL for defaults)
+ * @return 0 on success, -1 if @p opts is invalid or allocation fails
+ */
+int prefix_mgmt_init_ex(const prefix_table_opts_t *opts);
+
+/**
+ * @brief Frees a table and all its nodes.
+ *
+ * @param table Table to free (can be NULL)
+ */
+void prefix_table_destroy(prefix_table_t *table);
+
+/**
+ * @brief Adds an IPv4 prefix to a table.
+ *
+ * @param table Table to modify
+ * @param base  Base address of the prefix
+ * @param mask  Mask length (0–32)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_add(prefix_table_t *table, unsigned int base, char mask);
+
+/**
+ * @brief Removes an IPv4 prefix from a table.
+ *
+ * @param table Table to modify
+ * @param base  Base address of the prefix
+ * @param mask  Mask length (0–32)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_del(prefix_table_t *table, unsigned int base, char mask);
+
+/**
+ * @brief Removes a prefix and every longer prefix inside it from a table.
+ *
+ * The subtree below @p base/@p mask is found with one walk from the root,
+ * detached and freed in one pass, and the node it hung from is merged
+ * with its remaining child if it no longer branches. Much cheaper than
+ * calling prefix_table_del() for each covered prefix. @p base/@p mask
+ * itself need not be stored.
+ *
+ * @param table Table to modify
+ * @param base  Base address of the covering prefix
+ * @param mask  Mask length (0–32)
+ * @return Number of prefixes removed, -1 on invalid arguments
+ */
+int prefix_table_del_covered(prefix_table_t *table, unsigned int base,
+                             char mask);
+
+/**
+ * @brief Longest-prefix match of an address against a table.
+ *
+ * @param table Table to search
+ * @param ip    IPv4 address to check
+ * @return Mask of the longest matching prefix (0–32), or -1 if none
+ */
+char prefix_table_check(const prefix_table_t *table, unsigned int ip);
+
+/**
+ * @brief prefix_table_check() for many addresses.
+ *
+ * @param table     Table to search
+ * @param ips       Addresses to check
+ * @param n         Number of addresses
+ * @param masks_out Receives the result for ips[i] in masks_out[i]
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_check_batch(const prefix_table_t *table,
+                             const unsigned int *ips, size_t n,
+                             char *masks_out);
+
+/**
+ * @brief prefix_table_check_batch() sharing the walk between neighbours.
+ *
+ * Keeps the path of the previous lookup on a stack: each address backs
+ * up only to the deepest node whose bits it shares and continues from
+ * there with the longest match found so far. For ascending addresses the
+ * tree is visited roughly in order, each node once per run of addresses
+ * below it, instead of from the root every time. Results do not depend
+ * on the order; unsorted input is just slower. The host set and stride
+ * index are not used.
+ *
+ * @param table     Table to search
+ * @param ips       Addresses to check, preferably in ascending order
+ * @param n         Number of addresses
+ * @param masks_out Receives the result for ips[i] in masks_out[i]
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_check_sorted(const prefix_table_t *table,
+                              const unsigned int *ips, size_t n,
+                              char *masks_out);
+
+/**
+ * @brief Gets the root node of a table.
+ *
+ * @param table Table
+ * @return Pointer to root node, or NULL if @p table is NULL
+ */
+radix_node_t *prefix_table_root(const prefix_table_t *table);
+
+/**
+ * @brief Gets the table used by the global API.
+ *
+ * @return Global table, or NULL if prefix_mgmt_init() was not called
+ */
+prefix_table_t *prefix_mgmt_table(void);
+
+/**
+ * @brief Kind of change reported by prefix_table_diff().
+ */
+typedef enum {
+    PREFIX_DIFF_ADD = 0, /**< Prefix exists only in the target table */
+    PREFIX_DIFF_DEL = 1  /**< Prefix exists only in the source table */
+} prefix_diff_op_t;
+
+/**
+ * @brief Callback receiving one change from prefix_table_diff().
+ *
+ * @param op   Whether the prefix has to be added or deleted
+ * @param base Base address of the prefix
+ * @param mask Mask length (0–32)
+ * @param ctx  User pointer passed to prefix_table_diff()
+ */
+typedef void (*prefix_diff_cb)(prefix_diff_op_t op, unsigned int base,
+                               char mask, void *ctx);
+
+/**
+ * @brief Computes the changes that turn one table into another.
+ *
+ * Both trees are walked together, so prefixes present in both tables cost
+ * one comparison and subtrees present on one side only are reported without
+ * further comparisons. Changes are reported in address order (lower base
+ * first, shorter mask first for equal bases). Applying every reported change
+ * to @p from with add()/del() makes it hold the same prefixes as @p to.
+ *
+ * @param from Current table
+ * @param to   Desired table
+ * @param cb   Called once per changed prefix
+ * @param ctx  User pointer passed to @p cb
+ * @return Number of changes reported, or -1 on invalid arguments
+ */
+int prefix_table_diff(const prefix_table_t *from, const prefix_table_t *to,
+                      prefix_diff_cb cb, void *ctx);
+
+/**
+ * @brief What prefix_table_aggregate() has to preserve.
+ */
+typedef enum {
+    /** Every check() result, including the returned mask */
+    PREFIX_AGGREGATE_EXACT = 0,
+    /** Only whether check() matches; masks may change */
+    PREFIX_AGGREGATE_MATCH = 1
+} prefix_aggregate_mode_t;
+
+/**
+ * @struct prefix_aggregate_report
+ * @brief Table size before and after prefix_table_aggregate().
+ */
+typedef struct prefix_aggregate_report {
+    size_t prefixes_before; /**< Prefixes in the source table */
+    size_t prefixes_after;  /**< Prefixes in the aggregated table */
+    size_t nodes_before;    /**< Radix nodes in the source table */
+    size_t nodes_after;     /**< Radix nodes in the aggregated table */
+} prefix_aggregate_report_t;
+
+/**
+ * @brief Replaces a table's contents with the smallest equivalent set.
+ *
+ * In #PREFIX_AGGREGATE_EXACT mode only prefixes that are completely covered
+ * by longer prefixes are dropped; since check() returns the mask, no other
+ * prefix can be removed or merged without changing some result.
+ *
+ * In #PREFIX_AGGREGATE_MATCH mode the result is the minimal set of
+ * prefixes covering exactly the same addresses: prefixes inside other
+ * prefixes are dropped and complete sibling pairs are merged into their
+ * parent (e.g. two /25s into a /24), recursively.
+ *
+ * @param src    Table to aggregate
+ * @param dst    Table receiving the result; its previous contents are
+ *               replaced. May be equal to @p src for in-place aggregation.
+ * @param mode   What has to be preserved
+ * @param report Receives prefix and node counts (can be NULL)
+ * @return 0 on success, -1 on invalid arguments or allocation failure
+ *         (@p dst is then unchanged)
+ */
+int prefix_table_aggregate(const prefix_table_t *src, prefix_table_t *dst,
+                           prefix_aggregate_mode_t mode,
+                           prefix_aggregate_report_t *report);
+
+/**
+ * @brief Set operation computed by prefix_table_combine().
+ */
+typedef enum {
+    /** In @c a or in @c b */
+    PREFIX_SET_UNION = 0,
+    /** In both @c a and @c b */
+    PREFIX_SET_INTERSECT = 1,
+    /** In @c a but not in @c b */
+    PREFIX_SET_DIFF = 2
+} prefix_set_op_t;
+
+/**
+ * @brief What prefix_table_combine() treats as set elements.
+ */
+typedef enum {
+    /** Stored prefixes, compared by base and mask */
+    PREFIX_SET_PREFIXES = 0,
+    /** Addresses matched by check() */
+    PREFIX_SET_ADDRESSES = 1
+} prefix_set_mode_t;
+
+/**
+ * @brief Combines two tables into a third one.
+ *
+ * Both trees are walked together, so the cost depends on the number of
+ * nodes, not on the number of add() calls the result would need. Parts
+ * of a tree with nothing opposite them in the other one are copied node
+ * by node.
+ *
+ * In #PREFIX_SET_PREFIXES mode the result holds the prefixes selected by
+ * @p op, e.g. the intersection of {10/8, 10.1/16} and {10/8} is {10/8}.
+ *
+ * In #PREFIX_SET_ADDRESSES mode the result matches exactly the addresses
+ * selected by @p op, as the minimal prefix set of
+ * #PREFIX_AGGREGATE_MATCH. E.g. the difference of {10/8} and {10.0/9} is
+ * {10.128/9}.
+ *
+ * @param a    First operand
+ * @param b    Second operand
+ * @param dst  Table receiving the result; its previous contents are
+ *             replaced. May be equal to @p a or @p b.
+ * @param op   Set operation
+ * @param mode Set elements
+ * @return 0 on success, -1 on invalid arguments or allocation failure
+ *         (@p dst is then unchanged)
+ */
+int prefix_table_combine(const prefix_table_t *a, const prefix_table_t *b,
+                         prefix_table_t *dst, prefix_set_op_t op,
+                         prefix_set_mode_t mode);
+
+/**
+ * @brief Maximum number of nodes on a root-to-leaf path.
+ *
+ * The root plus at most one node per address bit.
+ */
+#define PREFIX_ITER_MAX_DEPTH 33
+
+/**
+ * @struct prefix_iter_frame
+ * @brief One node on the iterator's explicit stack.
+ *
+ * @var prefix_iter_frame::node
+ * Node on the current path
+ *
+ * @var prefix_iter_frame::path
+ * Address bits from the root to the end of the node
+ *
+ * @var prefix_iter_frame::end
+ * Depth at which the node's bits end
+ *
+ * @var prefix_iter_frame::state
+ * Next step: 0 report node, 1 visit left, 2 visit right, 3 done
+ */
+typedef struct prefix_iter_frame {
+    const radix_node_t *node; /**< Node on the current path */
+    unsigned int path;        /**< Address bits up to the end of the node */
+    unsigned char end;        /**< Depth at which the node's bits end */
+    unsigned char state;      /**< Next step to take for this node */
+} prefix_iter_frame_t;
+
+/**
+ * @struct prefix_iter
+ * @brief Allocation-free iterator over the prefixes of a table.
+ *
+ * Prefixes are returned in address order: lower base first, shorter mask
+ * first for equal bases. The iterator keeps the current root-to-node path
+ * in a fixed stack, so it never allocates and never copies the tree. The
+ * table must not be modified while an iterator is in use.
+ */
+typedef struct prefix_iter {
+    prefix_iter_frame_t stack[PREFIX_ITER_MAX_DEPTH]; /**< Current path */
+    int top; /**< Number of frames on the stack */
+} prefix_iter_t;
+
+/**
+ * @brief Positions an iterator before the first prefix of a table.
+ *
+ * @param it    Iterator to initialize
+ * @param table Table to iterate (NULL gives an empty iteration)
+ */
+void prefix_iter_init(prefix_iter_t *it, const prefix_table_t *table);
+
+/**
+ * @brief Positions an iterator before the first prefix not below a key.
+ *
+ * After seeking, iteration yields every prefix (b, m) with b > @p base, or
+ * b == @p base and m >= @p mask, in address order. The descent visits at
+ * most one node per level.
+ *
+ * @param it    Iterator to initialize
+ * @param table Table to iterate
+ * @param base  Base address of the key
+ * @param mask  Mask length of the key (0–32)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_iter_seek(prefix_iter_t *it, const prefix_table_t *table,
+                     unsigned int base, char mask);
+
+/**
+ * @brief Advances an iterator to the next prefix.
+ *
+ * @param it   Iterator
+ * @param base Receives the base address
+ * @param mask Receives the mask length
+ * @return true if a prefix was returned, false at the end
+ */
+bool prefix_iter_next(prefix_iter_t *it, unsigned int *base, char *mask);
+
+/**
+ * @brief Returns up to @p max following prefixes at once.
+ *
+ * @param it    Iterator
+ * @param bases Receives base addresses
+ * @param masks Receives mask lengths
+ * @param max   Capacity of @p bases and @p masks
+ * @return Number of prefixes returned (less than @p max only at the end)
+ */
+size_t prefix_iter_next_batch(prefix_iter_t *it, unsigned int *bases,
+                              char *masks, size_t max);
+
+/**
+ * @brief Callback receiving one prefix from a query.
+ *
+ * @param base Base address of the prefix
+ * @param mask Mask length (0–32)
+ * @param ctx  User pointer passed to the query
+ */
+typedef void (*prefix_cb)(unsigned int base, char mask, void *ctx);
+
+/**
+ * @brief Reports every stored prefix that lies inside a given prefix.
+ *
+ * A single descent finds the subtree of @p base/@p mask, which is then
+ * walked without recursion. Prefixes are reported in address order; the
+ * query prefix itself is included if stored.
+ *
+ * @param table Table to search
+ * @param base  Base address of the query prefix
+ * @param mask  Mask length of the query prefix (0–32)
+ * @param cb    Called once per prefix found (can be NULL to only count)
+ * @param ctx   User pointer passed to @p cb
+ * @return Number of prefixes found, or -1 on invalid arguments
+ */
+int prefix_table_find_covered(const prefix_table_t *table, unsigned int base,
+                              char mask, prefix_cb cb, void *ctx);
+
+/**
+ * @brief Reports every stored prefix that contains a given prefix.
+ *
+ * Uses the same single descent as check(), stopping at depth @p mask.
+ * Prefixes are reported from the shortest mask to the longest; the query
+ * prefix itself is included if stored.
+ *
+ * @param table Table to search
+ * @param base  Base address of the query prefix
+ * @param mask  Mask length of the query prefix (0–32)
+ * @param cb    Called once per prefix found (can be NULL to only count)
+ * @param ctx   User pointer passed to @p cb
+ * @return Number of prefixes found, or -1 on invalid arguments
+ */
+int prefix_table_find_covering(const prefix_table_t *table,
+                               unsigned int base, char mask, prefix_cb cb,
+                               void *ctx);
+
+/**
+ * @brief prefix_table_find_covered() on the global table.
+ *
+ * @param base Base address of the query prefix
+ * @param mask Mask length of the query prefix (0–32)
+ * @param cb   Called once per prefix found (can be NULL to only count)
+ * @param ctx  User pointer passed to @p cb
+ * @return Number of prefixes found, or -1 on invalid arguments
+ */
+int find_covered(unsigned int base, char mask, prefix_cb cb, void *ctx);
+
+/**
+ * @brief prefix_table_find_covering() on the global table.
+ *
+ * @param base Base address of the query prefix
+ * @param mask Mask length of the query prefix (0–32)
+ * @param cb   Called once per prefix found (can be NULL to only count)
+ * @param ctx  User pointer passed to @p cb
+ * @return Number of prefixes found, or -1 on invalid arguments
+ */
+int find_covering(unsigned int base, char mask, prefix_cb cb, void *ctx);
+
+/**
+ * @brief Finds every stored prefix that contains an address.
+ *
+ * Collects the masks of all prefixes met during the single descent that
+ * check() makes, so the last mask written is the check() result unless
+ * the output was truncated.
+ *
+ * @param table     Table to search
+ * @param ip        IPv4 address to check
+ * @param masks_out Receives masks in increasing order
+ * @param max       Capacity of @p masks_out (33 is always enough)
+ * @return Number of containing prefixes (only the first @p max are
+ *         written), or -1 on invalid arguments
+ */
+int prefix_table_check_all(const prefix_table_t *table, unsigned int ip,
+                           char *masks_out, int max);
+
+/**
+ * @brief prefix_table_check_all() for many addresses.
+ *
+ * @param table     Table to search
+ * @param ips       Addresses to check
+ * @param n         Number of addresses
+ * @param masks_out Receives @p max masks per address: masks of ips[i]
+ *                  start at masks_out[i * max]
+ * @param max       Masks stored per address
+ * @param counts    Receives the prefix_table_check_all() result per address
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_check_all_batch(const prefix_table_t *table,
+                                 const unsigned int *ips, size_t n,
+                                 char *masks_out, int max, int *counts);
+
+/**
+ * @brief prefix_table_check_all() on the global table.
+ *
+ * @param ip        IPv4 address to check
+ * @param masks_out Receives masks in increasing order
+ * @param max       Capacity of @p masks_out (33 is always enough)
+ * @return Number of containing prefixes (only the first @p max are
+ *         written), or -1 on invalid arguments
+ */
+int check_all(unsigned int ip, char *masks_out, int max);
+
+/**
+ * @brief prefix_table_check_all_batch() on the global table.
+ *
+ * @param ips       Addresses to check
+ * @param n         Number of addresses
+ * @param masks_out Receives @p max masks per address
+ * @param max       Masks stored per address
+ * @param counts    Receives the number of containing prefixes per address
+ * @return 0 on success, -1 on invalid arguments
+ */
+int check_all_batch(const unsigned int *ips, size_t n, char *masks_out,
+                    int max, int *counts);
+
+/**
+ * @brief Callback receiving one segment of a range query.
+ *
+ * @param first First address of the segment
+ * @param last  Last address of the segment (inclusive)
+ * @param mask  check() result for every address of the segment
+ * @param ctx   User pointer passed to the query
+ */
+typedef void (*prefix_range_cb)(unsigned int first, unsigned int last,
+                                char mask, void *ctx);
+
+/**
+ * @brief Summary of a range query.
+ */
+typedef struct {
+    bool covered;    /**< Every address of the range matches a prefix */
+    char min_mask;   /**< Shortest longest match in the range, -1 if none */
+    char max_mask;   /**< Longest match in the range, -1 if none */
+    size_t segments; /**< Number of segments reported */
+} prefix_range_report_t;
+
+/**
+ * @brief Longest-prefix match of every address of a range.
+ *
+ * Splits [@p lo, @p hi] into maximal segments of addresses with the same
+ * check() result (-1 for unmatched addresses) and reports them in address
+ * order. One depth-first walk visits only the nodes whose address range
+ * overlaps the query, so the cost depends on the number of prefixes in
+ * and around the range, not on its size.
+ *
+ * @param table Table to search
+ * @param lo    First address of the range
+ * @param hi    Last address of the range (inclusive)
+ * @param out   Receives the summary (can be NULL)
+ * @param cb    Called once per segment (can be NULL)
+ * @param ctx   User pointer passed to @p cb
+ * @return 0 on success, -1 on invalid arguments (@p lo > @p hi)
+ */
+int prefix_table_check_range(const prefix_table_t *table, unsigned int lo,
+                             unsigned int hi, prefix_range_report_t *out,
+                             prefix_range_cb cb, void *ctx);
+
+/**
+ * @brief prefix_table_check_range() on the global table.
+ *
+ * @param lo  First address of the range
+ * @param hi  Last address of the range (inclusive)
+ * @param out Receives the summary (can be NULL)
+ * @param cb  Called once per segment (can be NULL)
+ * @param ctx User pointer passed to @p cb
+ * @return 0 on success, -1 on invalid arguments
+ */
+int check_range(unsigned int lo, unsigned int hi, prefix_range_report_t *out,
+                prefix_range_cb cb, void *ctx);
+
+/**
+ * @brief Number of addresses of a prefix matched by the table.
+ *
+ * Addresses matched by several (nested) prefixes count once, so
+ * @p mask 0 gives the size of the whole covered address space. The counts
+ * are kept in the nodes by add() and del(); the query follows a single
+ * path and takes O(depth).
+ *
+ * @param table Table to search
+ * @param base  Base address of the query prefix
+ * @param mask  Mask length of the query prefix
+ * @param count Receives the number of covered addresses (up to 2^32)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int prefix_table_count_covered(const prefix_table_t *table,
+                               unsigned int base, char mask,
+                               uint64_t *count);
+
+/**
+ * @brief prefix_table_count_covered() on the global table.
+ *
+ * @param base  Base address of the query prefix
+ * @param mask  Mask length of the query prefix
+ * @param count Receives the number of covered addresses
+ * @return 0 on success, -1 on invalid arguments or if not initialized
+ */
+int count_covered(unsigned int base, char mask, uint64_t *count);
+
+/**
+ * @brief Callback receiving the hit count of one prefix.
+ *
+ * @param base Base address of the prefix
+ * @param mask Mask length (0–32)
+ * @param hits Number of check() calls that returned this prefix
+ * @param ctx  User pointer passed to prefix_table_hits()
+ */
+typedef void (*prefix_hits_cb)(unsigned int base, char mask, uint64_t hits,
+                               void *ctx);
+
+/**
+ * @brief Reports the hit count of every stored prefix.
+ *
+ * Requires the library to be built with PREFIX_MGMT_HIT_COUNTERS
+ * (CMake option ENABLE_HIT_COUNTERS). check() then counts, per prefix,
+ * how often it was the longest match. The first 64 threads each count
+ * into a shard of their own; all later threads share one more shard and
+ * count into it with atomic adds. This function sums the shards. Counts
+ * read while other threads call check() may lag slightly behind.
+ *
+ * @param table Table to report
+ * @param cb    Called once per prefix, in address order
+ * @param ctx   User pointer passed to @p cb
+ * @return Number of prefixes reported, or -1 if @p table is NULL or hit
+ *         counters are not compiled in
+ */
+int prefix_table_hits(const prefix_table_t *table, prefix_hits_cb cb,
+                      void *ctx);
+
+/**
+ * @brief Sets all hit counters of a table to zero.
+ *
+ * Must not run concurrently with check() on the same table.
+ *
+ * @param table Table to reset
+ * @return 0 on success, -1 if @p table is NULL or hit counters are not
+ *         compiled in
+ */
+int prefix_table_hits_reset(prefix_table_t *table);
+
+/** Number of buckets of a latency histogram */
+#define PREFIX_INSTR_LATENCY_BUCKETS 160
+
+/** Number of buckets of a depth histogram (0–32 node hops) */
+#define PREFIX_INSTR_DEPTH_BUCKETS 33
+
+/**
+ * @brief Operations measured by the instrumentation.
+ */
+typedef enum {
+    PREFIX_OP_CHECK = 0, /**< prefix_table_check() */
+    PREFIX_OP_ADD = 1,   /**< prefix_table_add() */
+    PREFIX_OP_DEL = 2,   /**< prefix_table_del() */
+    PREFIX_OP_COUNT = 3  /**< Number of measured operations */
+} prefix_op_t;
+
+/**
+ * @brief Latency and depth histograms of one operation.
+ *
+ * Latency buckets are log-linear: values 0–3 have a bucket each, above
+ * that every power of two is split into four equal buckets. The last
+ * bucket also collects everything beyond it. Use
+ * prefix_instr_bucket_floor() to map a bucket to its lower bound.
+ *
+ * depth[n] counts the calls that followed n child links from the root.
+ */
+typedef struct {
+    uint64_t count; /**< Number of calls */
+    uint64_t latency[PREFIX_INSTR_LATENCY_BUCKETS]; /**< Calls per latency */
+    uint64_t depth[PREFIX_INSTR_DEPTH_BUCKETS];     /**< Calls per depth */
+} prefix_op_histogram_t;
+
+/**
+ * @brief Instrumentation data of one table.
+ */
+typedef struct {
+    prefix_op_histogram_t op[PREFIX_OP_COUNT]; /**< Indexed by prefix_op_t */
+    bool cycles; /**< true if latencies are TSC cycles, false if ns */
+} prefix_instr_snapshot_t;
+
+/**
+ * @brief Reads the instrumentation data of a table.
+ *
+ * Requires the library to be built with PREFIX_MGMT_INSTRUMENT (CMake
+ * option ENABLE_INSTRUMENTATION). check(), add() and del() on the table
+ * then record their latency and the number of nodes they visited. Shards
+ * are only exclusive for the first 64 threads: each of them records into
+ * its own shard, and all later threads share one more shard, updated with
+ * atomic adds. This function sums the shards.
+ * Calls on a NULL table and on the global table before init are not
+ * recorded.
+ *
+ * @param table Table to read
+ * @param out   Filled with the summed histograms
+ * @return 0 on success, -1 if an argument is NULL or instrumentation is
+ *         not compiled in
+ */
+int prefix_table_instr_snapshot(const prefix_table_t *table,
+                                prefix_instr_snapshot_t *out);
+
+/**
+ * @brief Clears the instrumentation data of a table.
+ *
+ * Calls running concurrently on the same table may or may not be counted.
+ *
+ * @param table Table to reset
+ * @return 0 on success, -1 if @p table is NULL or instrumentation is not
+ *         compiled in
+ */
+int prefix_table_instr_reset(prefix_table_t *table);
+
+/**
+ * @brief Returns the smallest latency counted in a histogram bucket.
+ *
+ * @param bucket Bucket index (0 to PREFIX_INSTR_LATENCY_BUCKETS - 1)
+ * @return Lower bound of the bucket, in the unit of the snapshot
+ */
+uint64_t prefix_instr_bucket_floor(int bucket);
+
+/**
+ * @brief Estimates a latency percentile from a histogram.
+ *
+ * @param h Histogram
+ * @param p Percentile (0.0–100.0)
+ * @return Lower bound of the bucket holding the percentile, or 0 if the
+ *         histogram is empty
+ */
+uint64_t prefix_instr_percentile(const prefix_op_histogram_t *h, double p);
+
+/** Flag for prefix_table_stats(): also compute the depth fields */
+#define PREFIX_STATS_DEPTH 1u
+
+/**
+ * @brief Size and shape of a table.
+ *
+ * Depth is the number of nodes below the root on the way to a prefix,
+ * i.e. what check() walks to reach it.
+ */
+typedef struct {
+    size_t prefixes;        /**< Stored prefixes */
+    size_t nodes;           /**< Allocated nodes, root included */
+    size_t branch_nodes;    /**< Nodes holding no prefix */
+    size_t dead_nodes;      /**< Non-root branch nodes with < 2 children */
+    size_t bytes;           /**< Memory allocated for the table */
+    size_t node_bytes;      /**< Part of bytes holding nodes */
+    size_t mask_count[33];  /**< Prefixes per mask length */
+    int max_depth;          /**< Deepest prefix, -1 if not computed */
+    double avg_depth;       /**< Mean prefix depth, 0 if not computed */
+    size_t depth_count[33]; /**< Prefixes per depth, if computed */
+} prefix_stats_t;
+
+/**
+ * @brief Reports the size and shape of a table.
+ *
+ * Counts are maintained by add() and del(), so the call is O(1) unless
+ * #PREFIX_STATS_DEPTH is given, which walks the tree.
+ *
+ * dead_nodes counts nodes del() left behind: they hold no prefix and
+ * would be merged away if the table were rebuilt (e.g. with
+ * prefix_table_aggregate()), but still cost a step in every lookup
+ * passing through them.
+ *
+ * @param table Table to inspect
+ * @param out   Filled with the statistics
+ * @param flags 0 or #PREFIX_STATS_DEPTH
+ * @return 0 on success, -1 if an argument is NULL
+ */
+int prefix_table_stats(const prefix_table_t *table, prefix_stats_t *out,
+                       unsigned int flags);
+
+/**
+ * @brief Reports the size and shape of the global table.
+ *
+ * @param out   Filled with the statistics
+ * @param flags 0 or #PREFIX_STATS_DEPTH
+ * @return 0 on success, -1 if @p out is NULL or the system is not
+ *         initialized
+ */
+int prefix_mgmt_stats(prefix_stats_t *out, unsigned int flags);
+
+/**
+ * @brief Node order produced by prefix_table_relayout().
+ */
+typedef enum {
+    PREFIX_LAYOUT_DFS = 0, /**< Pre-order, left child first */
+    PREFIX_LAYOUT_BFS = 1, /**< Level by level */
+    PREFIX_LAYOUT_VEB = 2  /**< van Emde Boas (recursive half-height split) */
+} prefix_layout_t;
+
+/**
+ * @brief Moves all nodes of a table into one buffer in lookup order.
+ *
+ * Nodes otherwise sit wherever they were allocated, i.e. in insertion
+ * order. After a bulk load, copying them into a single 2 MB aligned buffer
+ * (huge pages when available, as with #PREFIX_ALLOC_HUGEPAGE) makes a
+ * lookup touch fewer cache lines and pages. #PREFIX_LAYOUT_VEB keeps
+ * every root-to-leaf path within few blocks for any block size.
+ *
+ * Nodes added later fill the unused end of the buffer first. Calling the
+ * function again replaces the buffer. Stored prefixes and hit counters
+ * are unchanged, but running iterators become invalid.
+ *
+ * Must not run concurrently with any other operation on the table.
+ *
+ * @param table  Table to re-lay out
+ * @param layout Node order
+ * @return 0 on success, -1 if an argument is invalid or allocation fails
+ *         (the table is then unchanged)
+ */
+int prefix_table_relayout(prefix_table_t *table, prefix_layout_t layout);
+
+/**
+ * @brief Re-lays out the global table.
+ *
+ * @param layout Node order
+ * @return 0 on success, -1 on invalid argument, allocation failure or if
+ *         the system is not initialized
+ */
+int prefix_mgmt_relayout(prefix_layout_t layout);
+
+/**
+ * @brief Starts sampling the addresses passed to check() on a table.
+ *
+ * One in @p period calls (counted per thread) stores its address in a
+ * ring of @p samples entries, overwriting the oldest. While profiling is
+ * off, check() pays a single branch. Calling it again restarts sampling
+ * with the new parameters.
+ *
+ * Must not run concurrently with check() on the same table.
+ *
+ * @param table   Table to profile
+ * @param period  Sampling period (1 = every call)
+ * @param samples Number of addresses kept
+ * @return 0 on success, -1 if an argument is invalid or allocation fails
+ */
+int prefix_table_profile_start(prefix_table_t *table, unsigned int period,
+                               size_t samples);
+
+/**
+ * @brief Stops sampling and drops the samples.
+ *
+ * Must not run concurrently with check() on the same table.
+ *
+ * @param table Table
+ * @return 0 on success, -1 if @p table is NULL
+ */
+int prefix_table_profile_stop(prefix_table_t *table);
+
+/**
+ * @brief Result of prefix_table_reorder().
+ *
+ * Lines and pages are the distinct 64-byte cache lines and 4 KB pages
+ * holding the nodes a sampled lookup touches. Times are the mean cost of
+ * walking the tree for one sampled address.
+ */
+typedef struct {
+    size_t samples;       /**< Sampled lookups used */
+    size_t visited_nodes; /**< Nodes touched by at least one of them */
+    size_t hot_nodes_50;  /**< Fewest nodes taking 50% of the node visits */
+    size_t hot_nodes_90;  /**< Fewest nodes taking 90% of the node visits */
+    size_t hot_nodes_99;  /**< Fewest nodes taking 99% of the node visits */
+    double lines_before;  /**< Mean lines per lookup, old layout */
+    double lines_after;   /**< Mean lines per lookup, new layout */
+    double pages_before;  /**< Mean pages per lookup, old layout */
+    double pages_after;   /**< Mean pages per lookup, new layout */
+    double ns_before;     /**< Mean walk time in ns, old layout */
+    double ns_after;      /**< Mean walk time in ns, new layout */
+} prefix_reorder_report_t;
+
+/**
+ * @brief Re-lays out a table so its most visited nodes sit together.
+ *
+ * The sampled addresses are replayed to count how often each node is
+ * touched, and the nodes are copied, hottest first, into a new buffer as
+ * with prefix_table_relayout(). A child is never hotter than its parent,
+ * so the busiest paths end up in the first cache lines and pages; nodes
+ * no sample reached follow in depth-first order. The samples are then
+ * cleared, so calling this periodically tracks the current traffic.
+ *
+ * Must not run concurrently with any other operation on the table.
+ *
+ * @param table  Table with profiling started
+ * @param report Filled with the hit distribution and the effect of the
+ *               reorder (can be NULL)
+ * @return 0 on success, -1 if @p table is NULL, profiling is not started
+ *         or allocation fails (the table keeps its contents)
+ */
+int prefix_table_reorder(prefix_table_t *table,
+                         prefix_reorder_report_t *report);
+
+/**
+ * @brief Starts sampling check() on the global table.
+ *
+ * @param period  Sampling period
+ * @param samples Number of addresses kept
+ * @return 0 on success, -1 on invalid argument, allocation failure or if
+ *         the system is not initialized
+ */
+int prefix_mgmt_profile_start(unsigned int period, size_t samples);
+
+/**
+ * @brief Stops sampling check() on the global table.
+ *
+ * @return 0 on success, -1 if the system is not initialized
+ */
+int prefix_mgmt_profile_stop(void);
+
+/**
+ * @brief Reorders the global table by the sampled lookups.
+ *
+ * @param report Filled with the result (can be NULL)
+ * @return 0 on success, -1 on failure or if the system is not
+ *         initialized
+ */
+int prefix_mgmt_reorder(prefix_reorder_report_t *report);
+
+/**
+ * @brief Read-only, compact copy of a table.
+ */
+typedef struct prefix_succinct prefix_succinct_t;
+
+/**
+ * @brief Builds a succinct copy of a table.
+ *
+ * The tree topology is kept as two bits per node with a rank directory
+ * (LOUDS) instead of pointers, and node path bits are packed without
+ * padding, so a node costs a few bits plus about two per path bit. The
+ * copy does not change when the table does; build a new one after
+ * updates. Lookups do not record hit counters or instrumentation.
+ *
+ * @param table Table to copy
+ * @return New copy, or NULL if @p table is NULL or allocation fails
+ */
+prefix_succinct_t *prefix_succinct_build(const prefix_table_t *table);
+
+/**
+ * @brief Frees a succinct copy.
+ *
+ * @param s Copy to free (can be NULL)
+ */
+void prefix_succinct_destroy(prefix_succinct_t *s);
+
+/**
+ * @brief Finds the longest prefix matching an address in a succinct copy.
+ *
+ * Same result as prefix_table_check() on the table at build time. Safe to
+ * call from several threads at once.
+ *
+ * @param s  Succinct copy
+ * @param ip Address
+ * @return Mask of the longest match, or -1 if none (or @p s is NULL)
+ */
+char prefix_succinct_check(const prefix_succinct_t *s, unsigned int ip);
+
+/**
+ * @brief Returns the memory used by a succinct copy.
+ *
+ * @param s Succinct copy
+ * @return Size in bytes, 0 if @p s is NULL
+ */
+size_t prefix_succinct_bytes(const prefix_succinct_t *s);
+
+/**
+ * @brief Returns the number of prefixes in a succinct copy.
+ *
+ * @param s Succinct copy
+ * @return Number of prefixes, 0 if @p s is NULL
+ */
+size_t prefix_succinct_prefixes(const prefix_succinct_t *s);
+
+#ifdef __SIZEOF_INT128__
+/**
+ * @brief IPv6 address as two 64-bit halves, each in host byte order.
+ */
+typedef struct {
+    uint64_t hi; /**< First 64 bits of the address */
+    uint64_t lo; /**< Last 64 bits of the address */
+} prefix6_addr_t;
+
+/**
+ * @brief Collection of IPv6 prefixes.
+ *
+ * The same radix tree as prefix_table_t, instantiated for 128-bit keys;
+ * only built where the compiler has 128-bit integers (GCC, Clang). The
+ * table options, hit counters and other IPv4 table features are not
+ * available.
+ */
+typedef struct prefix6_table prefix6_table_t;
+
+/**
+ * @brief Creates an empty IPv6 table.
+ *
+ * @return New table, or NULL if allocation fails
+ */
+prefix6_table_t *prefix6_table_create(void);
+
+/**
+ * @brief Frees an IPv6 table and all its prefixes.
+ *
+ * @param table Table to free (can be NULL)
+ */
+void prefix6_table_destroy(prefix6_table_t *table);
+
+/**
+ * @brief Adds a prefix to an IPv6 table.
+ *
+ * @param table Table to modify
+ * @param base  Base address, host bits zero
+ * @param mask  Mask length (0-128)
+ * @return 0 on success, -1 on invalid arguments or allocation failure
+ */
+int prefix6_table_add(prefix6_table_t *table, prefix6_addr_t base, int mask);
+
+/**
+ * @brief Removes a prefix from an IPv6 table.
+ *
+ * @param table Table to modify
+ * @param base  Base address, host bits zero
+ * @param mask  Mask length (0-128)
+ * @return 0 on success (also if the prefix was not stored), -1 on invalid
+ *         arguments
+ */
+int prefix6_table_del(prefix6_table_t *table, prefix6_addr_t base, int mask);
+
+/**
+ * @brief Finds the longest prefix matching an IPv6 address.
+ *
+ * @param table Table to search
+ * @param ip    Address
+ * @return Mask of the longest match, or -1 if none (or @p table is NULL)
+ */
+int prefix6_table_check(const prefix6_table_t *table, prefix6_addr_t ip);
+
+/**
+ * @brief Returns the number of prefixes in an IPv6 table.
+ *
+ * @param table Table
+ * @return Number of prefixes, 0 if @p table is NULL
+ */
+size_t prefix6_table_prefixes(const prefix6_table_t *table);
+
+/**
+ * @brief Returns the number of nodes in an IPv6 table.
+ *
+ * @param table Table
+ * @return Number of nodes, root included; 0 if @p table is NULL
+ */
+size_t prefix6_table_nodes(const prefix6_table_t *table);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
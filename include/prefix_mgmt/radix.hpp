@@ -0,0 +1,233 @@
+#ifndef PREFIX_MGMT_RADIX_HPP
+#define PREFIX_MGMT_RADIX_HPP
+
+#include "prefix_mgmt/prefix_mgmt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @file radix.hpp
+ * @brief Radix tree for any supported key width (C++17).
+ *
+ * RadixTree<Ipv4Key> holds IPv4 prefixes in a prefix_table_t,
+ * RadixTree<Ipv6Key> IPv6 ones in a prefix6_table_t. Both C tables are
+ * instances of the same radix core (src/radix_core.h), so the tree is
+ * written once; KeyTraits maps each key type to its table functions at
+ * compile time, without any run-time dispatch.
+ *
+ * add(), del() and check() give the results of the C functions,
+ * including those for invalid arguments.
+ *
+ * @code
+ * prefix_mgmt::RadixTree<prefix_mgmt::Ipv6Key> v6;
+ * prefix_mgmt::Ipv6Key doc = prefix_mgmt::ipv6_key(0x20010DB800000000ULL, 0);
+ * v6.add(doc, 32);                         // 2001:db8::/32
+ * int mask = v6.check(doc | 1);            // 32
+ * @endcode
+ */
+
+namespace prefix_mgmt {
+
+/** IPv4 address, most significant bit first */
+using Ipv4Key = std::uint32_t;
+
+#ifdef __SIZEOF_INT128__
+/** IPv6 address, most significant bit first */
+__extension__ typedef unsigned __int128 Ipv6Key;
+
+/**
+ * @brief Builds an IPv6 key from its two 64-bit halves.
+ *
+ * @param hi First 64 bits of the address
+ * @param lo Last 64 bits of the address
+ * @return Key
+ */
+constexpr Ipv6Key ipv6_key(std::uint64_t hi, std::uint64_t lo) {
+    return (static_cast<Ipv6Key>(hi) << 64) | lo;
+}
+#endif
+
+/**
+ * @brief C table holding keys of one type.
+ *
+ * Specializations provide the table type and its functions; the mask is
+ * checked against the key width before it is narrowed.
+ *
+ * @tparam Key Unsigned integer type holding one address
+ */
+template <class Key> struct KeyTraits;
+
+template <> struct KeyTraits<std::uint32_t> {
+    using Table = prefix_table_t;
+
+    static Table *create() { return prefix_table_create(); }
+    static void destroy(Table *t) { prefix_table_destroy(t); }
+
+    static int add(Table *t, std::uint32_t base, int mask) {
+        return valid(mask)
+                   ? prefix_table_add(t, base, static_cast<char>(mask))
+                   : -1;
+    }
+
+    static int del(Table *t, std::uint32_t base, int mask) {
+        return valid(mask)
+                   ? prefix_table_del(t, base, static_cast<char>(mask))
+                   : -1;
+    }
+
+    static int check(const Table *t, std::uint32_t ip) {
+        return prefix_table_check(t, ip);
+    }
+
+    static std::size_t prefixes(const Table *t) {
+        prefix_stats_t st;
+        return (prefix_table_stats(t, &st, 0) == 0) ? st.prefixes : 0;
+    }
+
+    static std::size_t nodes(const Table *t) {
+        prefix_stats_t st;
+        return (prefix_table_stats(t, &st, 0) == 0) ? st.nodes : 0;
+    }
+
+  private:
+    static bool valid(int mask) { return mask >= 0 && mask <= 32; }
+};
+
+#ifdef __SIZEOF_INT128__
+template <> struct KeyTraits<Ipv6Key> {
+    using Table = prefix6_table_t;
+
+    static Table *create() { return prefix6_table_create(); }
+    static void destroy(Table *t) { prefix6_table_destroy(t); }
+
+    static int add(Table *t, Ipv6Key base, int mask) {
+        return prefix6_table_add(t, addr(base), mask);
+    }
+
+    static int del(Table *t, Ipv6Key base, int mask) {
+        return prefix6_table_del(t, addr(base), mask);
+    }
+
+    static int check(const Table *t, Ipv6Key ip) {
+        return prefix6_table_check(t, addr(ip));
+    }
+
+    static std::size_t prefixes(const Table *t) {
+        return prefix6_table_prefixes(t);
+    }
+
+    static std::size_t nodes(const Table *t) {
+        return prefix6_table_nodes(t);
+    }
+
+  private:
+    static prefix6_addr_t addr(Ipv6Key key) {
+        prefix6_addr_t a;
+        a.hi = static_cast<std::uint64_t>(key >> 64);
+        a.lo = static_cast<std::uint64_t>(key);
+        return a;
+    }
+};
+#endif
+
+/**
+ * @class RadixTree
+ * @brief Longest-prefix-match tree over keys of one width.
+ *
+ * Move-only owner of one C table; the table is created by the first
+ * add() or del() and freed with the object. A default-constructed or
+ * moved-from tree has no table: check() returns -1 and prefixes() and
+ * nodes() return 0, as the C functions do for a NULL table.
+ *
+ * @tparam Key Key type with a KeyTraits specialization
+ */
+template <class Key> class RadixTree {
+    using Traits = KeyTraits<Key>;
+    using Table = typename Traits::Table;
+
+  public:
+    RadixTree() = default;
+    ~RadixTree() { Traits::destroy(table_); }
+
+    RadixTree(const RadixTree &) = delete;
+    RadixTree &operator=(const RadixTree &) = delete;
+
+    RadixTree(RadixTree &&other) noexcept
+        : table_(std::exchange(other.table_, nullptr)) {}
+
+    RadixTree &operator=(RadixTree &&other) noexcept {
+        if (this != &other) {
+            Traits::destroy(table_);
+            table_ = std::exchange(other.table_, nullptr);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Adds a prefix.
+     *
+     * @param base Base address, host bits zero
+     * @param mask Mask length (0 to the key width)
+     * @return 0 on success, -1 on invalid arguments or allocation failure
+     */
+    int add(Key base, int mask) {
+        Table *t = table();
+        return (t == nullptr) ? -1 : Traits::add(t, base, mask);
+    }
+
+    /**
+     * @brief Removes a prefix.
+     *
+     * Like del() in C, the node is removed or merged with its only child;
+     * its parent is left as it is.
+     *
+     * @param base Base address, host bits zero
+     * @param mask Mask length (0 to the key width)
+     * @return 0 on success (also if the prefix was not stored), -1 on
+     *         invalid arguments or allocation failure
+     */
+    int del(Key base, int mask) {
+        Table *t = table();
+        return (t == nullptr) ? -1 : Traits::del(t, base, mask);
+    }
+
+    /**
+     * @brief Finds the longest prefix containing an address.
+     *
+     * @param ip Address
+     * @return Mask of the longest match, or -1 if none
+     */
+    int check(Key ip) const {
+        return (table_ == nullptr) ? -1 : Traits::check(table_, ip);
+    }
+
+    /** @brief Returns the number of stored prefixes (0 without a table). */
+    std::size_t prefixes() const {
+        return (table_ == nullptr) ? 0 : Traits::prefixes(table_);
+    }
+
+    /**
+     * @brief Returns the number of nodes, root included (0 without a
+     * table).
+     */
+    std::size_t nodes() const {
+        return (table_ == nullptr) ? 0 : Traits::nodes(table_);
+    }
+
+  private:
+    /** @brief Returns the table, creating it on first use. */
+    Table *table() {
+        if (table_ == nullptr) {
+            table_ = Traits::create();
+        }
+        return table_;
+    }
+
+    Table *table_ = nullptr; /**< C table, NULL until first modified */
+};
+
+} // namespace prefix_mgmt
+
+#endif /* PREFIX_MGMT_RADIX_HPP */
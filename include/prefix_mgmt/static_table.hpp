@@ -0,0 +1,153 @@
+#ifndef PREFIX_MGMT_STATIC_TABLE_HPP
+#define PREFIX_MGMT_STATIC_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file static_table.hpp
+ * @brief Prefix lists turned into lookup tables at compile time (C++17).
+ *
+ * Meant for lists fixed at build time: bogons, RFC 1918, special-purpose
+ * ranges. The prefixes cut the address space into ranges with a constant
+ * longest match; the table stores the first address of every range and
+ * its mask, sorted, and check() is a branch-free binary search over them.
+ * Nothing is computed at run time and nothing is allocated.
+ *
+ * @code
+ * constexpr prefix_mgmt::StaticPrefix kPrivate[] = {
+ *     {0x0A000000, 8}, {0xAC100000, 12}, {0xC0A80000, 16}};
+ * constexpr prefix_mgmt::StaticTable private_nets(kPrivate);
+ * static_assert(private_nets.valid());
+ * static_assert(private_nets.check(0xC0A80101) == 16);
+ * @endcode
+ */
+
+namespace prefix_mgmt {
+
+/**
+ * @struct StaticPrefix
+ * @brief One prefix of a compile-time list.
+ */
+struct StaticPrefix {
+    std::uint32_t base; /**< Base address, host bits zero */
+    int mask;           /**< Mask length (0-32) */
+};
+
+/**
+ * @class StaticTable
+ * @brief Longest-prefix-match table for @p N prefixes, built by its
+ * constexpr constructor.
+ *
+ * check() returns the same result as check() on a tree holding the same
+ * prefixes. Prefixes that add() would reject (mask out of range, host
+ * bits set) are skipped the same way; valid() tells whether any were.
+ *
+ * @tparam N Number of prefixes in the list
+ */
+template <std::size_t N> class StaticTable {
+  public:
+    /** Most ranges N prefixes can produce */
+    static constexpr std::size_t kCapacity = 2 * N + 1;
+
+    /**
+     * @brief Builds the table.
+     *
+     * Cost is quadratic in @p N, which is fine for lists of a few hundred
+     * prefixes evaluated by the compiler.
+     *
+     * @param prefixes List of prefixes (duplicates allowed)
+     */
+    constexpr explicit StaticTable(const StaticPrefix (&prefixes)[N]) {
+        // Every range starts at 0, at a base or right after a prefix
+        std::uint64_t points[kCapacity] = {};
+        std::size_t n_points = 0;
+        points[n_points++] = 0;
+        for (std::size_t i = 0; i < N; i++) {
+            if (!is_valid(prefixes[i])) {
+                valid_ = false;
+                continue;
+            }
+            points[n_points++] = prefixes[i].base;
+            points[n_points++] = end_of(prefixes[i]);
+        }
+        for (std::size_t i = 1; i < n_points; i++) {
+            std::uint64_t p = points[i];
+            std::size_t j = i;
+            for (; j > 0 && points[j - 1] > p; j--) {
+                points[j] = points[j - 1];
+            }
+            points[j] = p;
+        }
+
+        for (std::size_t i = 0; i < n_points; i++) {
+            std::uint64_t p = points[i];
+            if (p > 0xFFFFFFFFULL || (i > 0 && p == points[i - 1])) {
+                continue;
+            }
+            signed char best = -1;
+            for (std::size_t k = 0; k < N; k++) {
+                const StaticPrefix &q = prefixes[k];
+                if (is_valid(q) && q.mask > best && p >= q.base &&
+                    p < end_of(q)) {
+                    best = static_cast<signed char>(q.mask);
+                }
+            }
+            if (count_ == 0 || masks_[count_ - 1] != best) {
+                starts_[count_] = static_cast<std::uint32_t>(p);
+                masks_[count_] = best;
+                count_++;
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the longest matching prefix.
+     *
+     * @param ip Address to look up
+     * @return Mask length of the longest match, or -1 if none
+     */
+    constexpr char check(std::uint32_t ip) const noexcept {
+        // Last range starting at or below ip; starts_[0] is always 0
+        std::size_t lo = 0;
+        std::size_t n = count_;
+        while (n > 1) {
+            std::size_t half = n / 2;
+            lo = (starts_[lo + half] <= ip) ? lo + half : lo;
+            n -= half;
+        }
+        return static_cast<char>(masks_[lo]);
+    }
+
+    /**
+     * @brief Tells whether every prefix of the list was accepted.
+     */
+    constexpr bool valid() const noexcept { return valid_; }
+
+    /**
+     * @brief Returns the number of ranges the address space was cut into.
+     */
+    constexpr std::size_t ranges() const noexcept { return count_; }
+
+  private:
+    static constexpr bool is_valid(const StaticPrefix &p) {
+        if (p.mask < 0 || p.mask > 32) {
+            return false;
+        }
+        return p.mask == 32 || (p.base & (0xFFFFFFFFU >> p.mask)) == 0;
+    }
+
+    static constexpr std::uint64_t end_of(const StaticPrefix &p) {
+        return static_cast<std::uint64_t>(p.base) +
+               (std::uint64_t{1} << (32 - p.mask));
+    }
+
+    std::uint32_t starts_[kCapacity] = {}; /**< First address of each range */
+    signed char masks_[kCapacity] = {};    /**< Longest match in each range */
+    std::size_t count_ = 0;                /**< Ranges in use */
+    bool valid_ = true;                    /**< No prefix was skipped */
+};
+
+} // namespace prefix_mgmt
+
+#endif /* PREFIX_MGMT_STATIC_TABLE_HPP */
@@ -0,0 +1,185 @@
+#ifndef PREFIX_MGMT_TABLE_HPP
+#define PREFIX_MGMT_TABLE_HPP
+
+#include "prefix_mgmt/prefix_mgmt.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define PREFIX_MGMT_HAS_SPAN 1
+#endif
+
+/**
+ * @file table.hpp
+ * @brief Header-only C++ owner of a prefix table (C++17).
+ *
+ * Wraps the prefix_table_* functions, so C++ code never touches the global
+ * table of prefix_mgmt_init() and any number of tables can coexist.
+ *
+ * @code
+ * prefix_mgmt::Table next;              // e.g. on a worker thread
+ * next.add(0x0A000000, 8);
+ * current = std::move(next);            // pointer handover, no copy
+ * char mask = current.check(0x0A000001);
+ * @endcode
+ */
+
+namespace prefix_mgmt {
+
+/**
+ * @class Table
+ * @brief Move-only owner of one prefix table.
+ *
+ * Moving a table hands over the tree pointer; nodes are never copied.
+ * A moved-from table owns nothing and every call on it fails like a call
+ * with a NULL table (-1). A table may be built on one thread and moved to
+ * another, but as with the C API it must not be modified or moved while
+ * another thread reads it.
+ */
+class Table {
+  public:
+    /**
+     * @brief Creates an empty table.
+     *
+     * @throws std::bad_alloc if the table cannot be allocated
+     */
+    Table() : table_(prefix_table_create()) {
+        if (table_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    /**
+     * @brief Creates an empty table with options.
+     *
+     * @param opts Options, see prefix_table_create_ex()
+     * @throws std::bad_alloc if the options are invalid or the table
+     *         cannot be allocated
+     */
+    explicit Table(const prefix_table_opts_t &opts)
+        : table_(prefix_table_create_ex(&opts)) {
+        if (table_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~Table() { prefix_table_destroy(table_); }
+
+    Table(const Table &) = delete;
+    Table &operator=(const Table &) = delete;
+
+    Table(Table &&other) noexcept
+        : table_(std::exchange(other.table_, nullptr)) {}
+
+    Table &operator=(Table &&other) noexcept {
+        if (this != &other) {
+            prefix_table_destroy(table_);
+            table_ = std::exchange(other.table_, nullptr);
+        }
+        return *this;
+    }
+
+    /** @brief See prefix_table_add(); -1 if @p mask is not 0-32. */
+    int add(std::uint32_t base, int mask) noexcept {
+        if (!valid_mask(mask)) {
+            return -1;
+        }
+        return prefix_table_add(table_, base, static_cast<char>(mask));
+    }
+
+    /** @brief See prefix_table_del(); -1 if @p mask is not 0-32. */
+    int del(std::uint32_t base, int mask) noexcept {
+        if (!valid_mask(mask)) {
+            return -1;
+        }
+        return prefix_table_del(table_, base, static_cast<char>(mask));
+    }
+
+    /** @brief See prefix_table_del_covered(); -1 if @p mask is not 0-32. */
+    int del_covered(std::uint32_t base, int mask) noexcept {
+        if (!valid_mask(mask)) {
+            return -1;
+        }
+        return prefix_table_del_covered(table_, base,
+                                        static_cast<char>(mask));
+    }
+
+    /** @brief See prefix_table_check(). */
+    char check(std::uint32_t ip) const noexcept {
+        return prefix_table_check(table_, ip);
+    }
+
+    /**
+     * @brief Looks up @p n addresses, see prefix_table_check_batch().
+     *
+     * @param ips   Addresses
+     * @param n     Number of addresses
+     * @param masks Receives the result for ips[i] in masks[i]
+     * @return 0 on success, -1 on invalid arguments
+     */
+    int check(const std::uint32_t *ips, std::size_t n,
+              std::int8_t *masks) const noexcept {
+        static_assert(sizeof(std::uint32_t) == sizeof(unsigned int),
+                      "addresses are passed as unsigned int");
+        return prefix_table_check_batch(
+            table_, reinterpret_cast<const unsigned int *>(ips), n,
+            reinterpret_cast<char *>(masks));
+    }
+
+#ifdef PREFIX_MGMT_HAS_SPAN
+    /**
+     * @brief Looks up every address of @p ips.
+     *
+     * @param ips   Addresses
+     * @param masks Receives one result per address
+     * @return 0 on success, -1 if @p masks is shorter than @p ips
+     */
+    int check(std::span<const std::uint32_t> ips,
+              std::span<std::int8_t> masks) const noexcept {
+        if (masks.size() < ips.size()) {
+            return -1;
+        }
+        return check(ips.data(), ips.size(), masks.data());
+    }
+#endif
+
+    /**
+     * @brief Returns the underlying table for the rest of the C API.
+     *
+     * @return Table, or NULL after a move
+     */
+    prefix_table_t *get() const noexcept { return table_; }
+
+    /**
+     * @brief Tells whether the object owns a table.
+     */
+    explicit operator bool() const noexcept { return table_ != nullptr; }
+
+    /**
+     * @brief Exchanges the tables of two objects.
+     */
+    void swap(Table &other) noexcept { std::swap(table_, other.table_); }
+
+  private:
+    /**
+     * @brief Checks a mask before it is narrowed to the C API's char.
+     */
+    static bool valid_mask(int mask) noexcept {
+        return mask >= 0 && mask <= 32;
+    }
+
+    prefix_table_t *table_; /**< Owned table, NULL after a move */
+};
+
+/**
+ * @brief Exchanges the tables of two objects.
+ */
+inline void swap(Table &a, Table &b) noexcept { a.swap(b); }
+
+} // namespace prefix_mgmt
+
+#endif /* PREFIX_MGMT_TABLE_HPP */
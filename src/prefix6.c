@@ -0,0 +1,209 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @file prefix6.c
+ * @brief IPv6 tables: the radix core instantiated for 128-bit keys.
+ */
+
+#ifdef __SIZEOF_INT128__
+
+/** IPv6 address, most significant bit first */
+__extension__ typedef unsigned __int128 radix6_key_t;
+
+/**
+ * @brief Node of an IPv6 table; the fields mean the same as in
+ * radix_node_t.
+ */
+typedef struct radix6_node {
+    struct radix6_node *left;
+    struct radix6_node *right;
+    radix6_key_t prefix;
+    unsigned char skip;
+    bool is_prefix;
+    short mask;
+} radix6_node_t;
+
+/**
+ * @struct prefix6_table
+ * @brief One IPv6 prefix collection.
+ */
+struct prefix6_table {
+    radix6_node_t *root; /**< Root node, holds the /0 prefix */
+    size_t prefixes;     /**< Stored prefixes */
+    size_t nodes;        /**< Allocated nodes, root included */
+};
+
+/**
+ * @brief Creates a new node.
+ *
+ * @param table Table the node will belong to
+ * @return Empty node, or NULL if allocation fails
+ */
+static radix6_node_t *create_node(prefix6_table_t *table) {
+    radix6_node_t *node = (radix6_node_t *)calloc(1, sizeof(radix6_node_t));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->mask = -1;
+    table->nodes++;
+    return node;
+}
+
+/**
+ * @brief Frees a single node (children are not touched).
+ *
+ * @param table Table the node belongs to
+ * @param node  Node to free
+ */
+static void release_node(prefix6_table_t *table, radix6_node_t *node) {
+    table->nodes--;
+    free(node);
+}
+
+/**
+ * @brief Marks a node as holding a prefix.
+ *
+ * @param table Table the node belongs to
+ * @param node  Node
+ * @param mask  Mask length of the prefix
+ */
+static void set_prefix(prefix6_table_t *table, radix6_node_t *node,
+                       int mask) {
+    table->prefixes += !node->is_prefix;
+    node->is_prefix = true;
+    node->mask = (short)mask;
+}
+
+/**
+ * @brief Removes the prefix of a node.
+ *
+ * @param table Table the node belongs to
+ * @param node  Node
+ */
+static void clear_prefix(prefix6_table_t *table, radix6_node_t *node) {
+    table->prefixes -= node->is_prefix;
+    node->is_prefix = false;
+    node->mask = -1;
+}
+
+/**
+ * @brief Counts the leading zero bits of a non-zero key.
+ *
+ * @param x Key
+ * @return Number of leading zero bits
+ */
+static inline int clz128(radix6_key_t x) {
+    unsigned long long hi = (unsigned long long)(x >> 64);
+    return (hi != 0) ? __builtin_clzll(hi)
+                     : 64 + __builtin_clzll((unsigned long long)x);
+}
+
+#define RADIX_NAME(x) radix6_##x
+#define RADIX_BITS_NAME(x) radix6_##x
+#define RADIX_KEY radix6_key_t
+#define RADIX_BITS 128
+#define RADIX_CLZ(x) clz128(x)
+#define RADIX_NODE radix6_node_t
+#define RADIX_TABLE prefix6_table_t
+#define RADIX_ROOT(t) ((t)->root)
+#define RADIX_CREATE_NODE(t) create_node(t)
+#define RADIX_RELEASE_NODE(t, n) release_node(t, n)
+#define RADIX_SET_PREFIX(t, n, mask) set_prefix(t, n, mask)
+#define RADIX_CLEAR_PREFIX(t, n) clear_prefix(t, n)
+#include "radix_bits.h"
+#include "radix_core.h"
+
+/**
+ * @brief Builds a key from an address.
+ *
+ * @param addr Address
+ * @return Key
+ */
+static inline radix6_key_t key_of(prefix6_addr_t addr) {
+    return ((radix6_key_t)addr.hi << 64) | addr.lo;
+}
+
+/**
+ * @brief Frees a node and all its children.
+ *
+ * @param table Table the nodes belong to
+ * @param node  Node to free (can be NULL)
+ */
+static void free_node(prefix6_table_t *table, radix6_node_t *node) {
+    if (node == NULL) {
+        return;
+    }
+    free_node(table, node->left);
+    free_node(table, node->right);
+    release_node(table, node);
+}
+
+prefix6_table_t *prefix6_table_create(void) {
+    prefix6_table_t *table =
+        (prefix6_table_t *)calloc(1, sizeof(prefix6_table_t));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->root = create_node(table);
+    if (table->root == NULL) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void prefix6_table_destroy(prefix6_table_t *table) {
+    if (table == NULL) {
+        return;
+    }
+    free_node(table, table->root);
+    free(table);
+}
+
+int prefix6_table_add(prefix6_table_t *table, prefix6_addr_t base,
+                      int mask) {
+    radix6_key_t key = key_of(base);
+    if (table == NULL || !radix6_is_valid_mask(mask) ||
+        !radix6_is_aligned(key, mask)) {
+        return -1;
+    }
+    int hops = 0;
+    return radix6_add(table, key, mask, &hops);
+}
+
+int prefix6_table_del(prefix6_table_t *table, prefix6_addr_t base,
+                      int mask) {
+    radix6_key_t key = key_of(base);
+    if (table == NULL || !radix6_is_valid_mask(mask) ||
+        !radix6_is_aligned(key, mask)) {
+        return -1;
+    }
+    int hops = 0;
+    return radix6_del(table, key, mask, &hops);
+}
+
+int prefix6_table_check(const prefix6_table_t *table, prefix6_addr_t ip) {
+    if (table == NULL) {
+        return -1;
+    }
+    int hops = 0;
+    const radix6_node_t *best = radix6_walk(table->root, 0, key_of(ip), &hops);
+    return (best == NULL) ? -1 : best->mask;
+}
+
+size_t prefix6_table_prefixes(const prefix6_table_t *table) {
+    return (table == NULL) ? 0 : table->prefixes;
+}
+
+size_t prefix6_table_nodes(const prefix6_table_t *table) {
+    return (table == NULL) ? 0 : table->nodes;
+}
+
+#else
+
+// ISO C does not allow an empty translation unit
+typedef int prefix6_unavailable_t;
+
+#endif
@@ -0,0 +1,121 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file prefix_aggregate.c
+ * @brief Reduction of a table to the smallest equivalent prefix set.
+ *
+ * A node's region is the address range below its full path. The region is
+ * "full" when every address in it is covered, either by the node's own
+ * prefix or by prefixes in both halves. A half can only be full if the
+ * child starts exactly one bit below, otherwise part of the half has no
+ * nodes at all.
+ */
+
+/**
+ * @brief State shared by one aggregation.
+ */
+typedef struct {
+    prefix_table_t *out;          /**< Table receiving the result */
+    prefix_aggregate_mode_t mode; /**< What has to be preserved */
+    int error;                    /**< Set if an add() failed */
+} aggregate_ctx_t;
+
+/**
+ * @brief Adds one prefix to the result.
+ *
+ * @param c    Aggregation state
+ * @param base Base address
+ * @param mask Mask length
+ */
+static void emit(aggregate_ctx_t *c, unsigned int base, int mask) {
+    if (prefix_table_add(c->out, base, (char)mask) != 0) {
+        c->error = 1;
+    }
+}
+
+/**
+ * @brief Aggregates a subtree.
+ *
+ * @param c     Aggregation state
+ * @param node  Subtree root
+ * @param start Depth at which @p node's bits begin
+ * @param path  Address bits above @p start
+ * @param covered True if an ancestor holds a prefix
+ * @return true if the node's region is full; in #PREFIX_AGGREGATE_MATCH
+ *         mode the caller then decides where the covering prefix goes
+ */
+static bool aggregate_walk(aggregate_ctx_t *c, const radix_node_t *node,
+                           int start, unsigned int path, bool covered) {
+    unsigned int full_path = node_path(path, start, node);
+    int end = start + node->skip;
+    bool below_covered = covered || node->is_prefix;
+
+    bool left = node->left != NULL &&
+                aggregate_walk(c, node->left, end, full_path, below_covered);
+    bool right =
+        node->right != NULL &&
+        aggregate_walk(c, node->right, end, full_path, below_covered);
+
+    // Both halves covered by longer prefixes
+    bool below_full = left && node->left->skip == 1 && right &&
+                      node->right->skip == 1;
+
+    if (c->mode == PREFIX_AGGREGATE_EXACT) {
+        if (node->is_prefix && !below_full) {
+            emit(c, full_path, node->mask);
+        }
+        return node->is_prefix || below_full;
+    }
+
+    if (node->is_prefix || below_full || covered) {
+        return node->is_prefix || below_full;
+    }
+
+    // Region not full - full children are the largest covering prefixes
+    if (left) {
+        emit(c, node_path(full_path, end, node->left), end + node->left->skip);
+    }
+    if (right) {
+        emit(c, node_path(full_path, end, node->right),
+             end + node->right->skip);
+    }
+    return false;
+}
+
+int prefix_table_aggregate(const prefix_table_t *src, prefix_table_t *dst,
+                           prefix_aggregate_mode_t mode,
+                           prefix_aggregate_report_t *report) {
+    if (src == NULL || dst == NULL ||
+        (mode != PREFIX_AGGREGATE_EXACT && mode != PREFIX_AGGREGATE_MATCH)) {
+        return -1;
+    }
+
+    prefix_table_t *out = table_create_like(dst);
+    if (out == NULL) {
+        return -1;
+    }
+
+    aggregate_ctx_t c = {out, mode, 0};
+    if (aggregate_walk(&c, src->root, 0, 0, false) &&
+        mode == PREFIX_AGGREGATE_MATCH) {
+        emit(&c, 0, 0);
+    }
+    if (c.error) {
+        prefix_table_destroy(out);
+        return -1;
+    }
+
+    prefix_aggregate_report_t r = {src->prefixes, out->prefixes, src->nodes,
+                                   out->nodes};
+
+    table_swap(dst, out);
+    prefix_table_destroy(out);
+
+    if (report != NULL) {
+        *report = r;
+    }
+    return 0;
+}
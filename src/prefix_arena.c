@@ -0,0 +1,137 @@
+#define _GNU_SOURCE
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+/**
+ * @file prefix_arena.c
+ * @brief Huge-page-backed node allocator.
+ *
+ * Nodes are handed out from the current chunk in order and recycled
+ * through a free list threaded through their @c left pointers. Chunks are
+ * only unmapped when the arena is destroyed.
+ */
+
+/**
+ * @struct arena_chunk
+ * @brief Header at the start of every mapped chunk.
+ */
+struct arena_chunk {
+    struct arena_chunk *next; /**< Previously mapped chunk */
+    size_t size;              /**< Mapping size */
+};
+
+/** Offset of the first node in a chunk, keeps nodes cache-line aligned */
+#define ARENA_HEADER 64
+
+/**
+ * @brief Maps 2 MB aligned memory, preferring explicit huge pages.
+ *
+ * @param size    Size (multiple of ARENA_PAGE)
+ * @param hugetlb Set to true if the memory is backed by MAP_HUGETLB
+ * @return Start of the mapping, or NULL on failure
+ */
+void *arena_map(size_t size, bool *hugetlb) {
+    *hugetlb = false;
+#ifdef MAP_HUGETLB
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        *hugetlb = true;
+        return p;
+    }
+#endif
+
+    // Over-map so a 2 MB aligned range can be cut out for THP
+    size_t span = size + ARENA_PAGE;
+    char *raw = mmap(NULL, span, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    uintptr_t start = ((uintptr_t)raw + ARENA_PAGE - 1) & ~(ARENA_PAGE - 1);
+    char *aligned = (char *)start;
+    if (aligned > raw) {
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    if (raw + span > aligned + size) {
+        munmap(aligned + size, (size_t)(raw + span - (aligned + size)));
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+/**
+ * @brief Unmaps memory returned by arena_map().
+ *
+ * @param start Start of the mapping (can be NULL)
+ * @param size  Size passed to arena_map()
+ */
+void arena_unmap(void *start, size_t size) {
+    if (start != NULL) {
+        munmap(start, size);
+    }
+}
+
+struct node_arena *arena_create(size_t chunk) {
+    struct node_arena *arena = calloc(1, sizeof(*arena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    if (chunk == 0) {
+        chunk = ARENA_PAGE;
+    }
+    arena->chunk_size = (chunk + ARENA_PAGE - 1) & ~(ARENA_PAGE - 1);
+    return arena;
+}
+
+void arena_destroy(struct node_arena *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    struct arena_chunk *c = arena->chunks;
+    while (c != NULL) {
+        struct arena_chunk *next = c->next;
+        munmap(c, c->size);
+        c = next;
+    }
+    free(arena);
+}
+
+radix_node_t *arena_alloc(struct node_arena *arena) {
+    radix_node_t *node = arena->free_list;
+    if (node != NULL) {
+        arena->free_list = node->left;
+        return node;
+    }
+
+    if (arena->cursor == NULL ||
+        (size_t)(arena->limit - arena->cursor) < sizeof(radix_node_t)) {
+        bool hugetlb;
+        struct arena_chunk *c = arena_map(arena->chunk_size, &hugetlb);
+        if (c == NULL) {
+            return NULL;
+        }
+        c->next = arena->chunks;
+        c->size = arena->chunk_size;
+        arena->chunks = c;
+        arena->mapped += arena->chunk_size;
+        arena->hugetlb += hugetlb ? arena->chunk_size : 0;
+        arena->cursor = (char *)c + ARENA_HEADER;
+        arena->limit = (char *)c + arena->chunk_size;
+    }
+
+    node = (radix_node_t *)arena->cursor;
+    arena->cursor += sizeof(radix_node_t);
+    return node;
+}
+
+void arena_free(struct node_arena *arena, radix_node_t *node) {
+    node->left = arena->free_list;
+    arena->free_list = node;
+}
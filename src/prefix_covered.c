@@ -0,0 +1,114 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+
+/**
+ * @file prefix_covered.c
+ * @brief Covered-address counts kept in the nodes.
+ *
+ * set_prefix() and cleanup_node() keep the count of the node they change
+ * right. add() and del() then refresh the nodes they passed on the way
+ * down, del_covered() the path to the removed subtree with
+ * covered_update(). Operations that build a tree on the side recompute
+ * every count with covered_rebuild().
+ */
+
+void covered_update(prefix_table_t *table, unsigned int base, int len) {
+    // Every node on the path starts before len and holds at least one bit
+    radix_node_t *path[32];
+    int n = 0;
+
+    radix_node_t *current = table->root;
+    int depth = 0;
+    while (depth < len) {
+        radix_node_t *child =
+            (get_bit(base, depth) == 0) ? current->left : current->right;
+        if (child == NULL) {
+            break;
+        }
+        // A node merged with its child may end below len
+        int bits = (child->skip < len - depth) ? child->skip : len - depth;
+        if (extract_bits(base, depth, bits) !=
+            child->prefix >> (child->skip - bits)) {
+            break;
+        }
+        path[n++] = child;
+        current = child;
+        depth += child->skip;
+    }
+
+    covered_refresh_path(path, n);
+}
+
+/**
+ * @brief Recomputes the counts of a subtree, children first.
+ *
+ * @param node Subtree root, not the table root (can be NULL)
+ */
+static void rebuild(radix_node_t *node) {
+    if (node == NULL) {
+        return;
+    }
+    rebuild(node->left);
+    rebuild(node->right);
+    covered_refresh(node);
+}
+
+void covered_rebuild(prefix_table_t *table) {
+    rebuild(table->root->left);
+    rebuild(table->root->right);
+}
+
+int prefix_table_count_covered(const prefix_table_t *table,
+                               unsigned int base, char mask,
+                               uint64_t *count) {
+    if (table == NULL || count == NULL || !is_valid_mask(mask) ||
+        !is_aligned(base, mask)) {
+        return -1;
+    }
+
+    const radix_node_t *current = table->root;
+    uint64_t all = (uint64_t)1 << (32 - mask);
+    if (current->is_prefix) {
+        *count = all;
+        return 0;
+    }
+    if (mask == 0) {
+        *count = (uint64_t)node_covered(current->left) +
+                 node_covered(current->right);
+        return 0;
+    }
+
+    // Go down to the first node reaching the mask; a prefix on the way
+    // covers the whole query
+    int depth = 0;
+    *count = 0;
+    for (;;) {
+        const radix_node_t *child =
+            (get_bit(base, depth) == 0) ? current->left : current->right;
+        if (child == NULL) {
+            return 0;
+        }
+        int remaining = mask - depth;
+        if (child->skip >= remaining) {
+            // The child's range lies inside the query
+            unsigned int head = child->prefix >> (child->skip - remaining);
+            if (head == extract_bits(base, depth, remaining)) {
+                *count = child->covered;
+            }
+            return 0;
+        }
+        if (extract_bits(base, depth, child->skip) != child->prefix) {
+            return 0;
+        }
+        if (child->is_prefix) {
+            *count = all;
+            return 0;
+        }
+        depth += child->skip;
+        current = child;
+    }
+}
+
+int count_covered(unsigned int base, char mask, uint64_t *count) {
+    return prefix_table_count_covered(prefix_mgmt_table(), base, mask, count);
+}
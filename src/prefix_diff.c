@@ -0,0 +1,160 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file prefix_diff.c
+ * @brief Difference between two prefix tables.
+ *
+ * The two trees are walked in lockstep. Both walks are kept at the same bit
+ * depth, which may lie inside a path-compressed node on either side, so the
+ * trees do not need to have the same shape to be compared.
+ */
+
+/**
+ * @brief State shared by one prefix_table_diff() call.
+ */
+typedef struct {
+    prefix_diff_cb cb; /**< User callback */
+    void *ctx;         /**< User pointer */
+    int changes;       /**< Number of changes reported so far */
+} diff_ctx_t;
+
+/**
+ * @brief Reports one changed prefix.
+ *
+ * @param c    Diff state
+ * @param op   Kind of change
+ * @param base Base address
+ * @param mask Mask length
+ */
+static void report(diff_ctx_t *c, prefix_diff_op_t op, unsigned int base,
+                   char mask) {
+    c->changes++;
+    if (c->cb != NULL) {
+        c->cb(op, base, mask, c->ctx);
+    }
+}
+
+/**
+ * @brief Reports every prefix of a subtree in address order.
+ *
+ * @param c     Diff state
+ * @param op    Kind of change
+ * @param node  Subtree root (can be NULL)
+ * @param start Depth at which @p node's bits begin
+ * @param path  Address bits above @p start
+ */
+static void report_subtree(diff_ctx_t *c, prefix_diff_op_t op,
+                           const radix_node_t *node, int start,
+                           unsigned int path) {
+    if (node == NULL) {
+        return;
+    }
+
+    unsigned int full = node_path(path, start, node);
+    int end = start + node->skip;
+
+    if (node->is_prefix) {
+        report(c, op, full, node->mask);
+    }
+    report_subtree(c, op, node->left, end, full);
+    report_subtree(c, op, node->right, end, full);
+}
+
+/**
+ * @brief Compares two subtrees positioned at the same bit depth.
+ *
+ * Each node covers depth @p d, i.e. its bits begin at or above @p d and end
+ * at or below it, and its bits above @p d agree with @p path.
+ *
+ * @param c     Diff state
+ * @param a     Node from the source table (can be NULL)
+ * @param as    Depth at which @p a's bits begin
+ * @param b     Node from the target table (can be NULL)
+ * @param bs    Depth at which @p b's bits begin
+ * @param d     Current depth
+ * @param path  Address bits above @p d
+ */
+static void diff_walk(diff_ctx_t *c, const radix_node_t *a, int as,
+                      const radix_node_t *b, int bs, int d,
+                      unsigned int path) {
+    if (a == NULL) {
+        report_subtree(c, PREFIX_DIFF_ADD, b, bs, path);
+        return;
+    }
+    if (b == NULL) {
+        report_subtree(c, PREFIX_DIFF_DEL, a, as, path);
+        return;
+    }
+
+    int ae = as + a->skip;
+    int be = bs + b->skip;
+    int end = (ae < be) ? ae : be;
+
+    if (d < end) {
+        // Both nodes continue below d - compare bits up to the shorter one
+        unsigned int a_bits = node_path(path, as, a);
+        unsigned int b_bits = node_path(path, bs, b);
+
+        if (((a_bits ^ b_bits) & net_mask(end)) != 0) {
+            // Paths diverge - subtrees are disjoint, lower one first
+            if (a_bits < b_bits) {
+                report_subtree(c, PREFIX_DIFF_DEL, a, as, path);
+                report_subtree(c, PREFIX_DIFF_ADD, b, bs, path);
+            } else {
+                report_subtree(c, PREFIX_DIFF_ADD, b, bs, path);
+                report_subtree(c, PREFIX_DIFF_DEL, a, as, path);
+            }
+            return;
+        }
+
+        d = end;
+        path = a_bits & net_mask(end);
+    }
+
+    if (ae == be) {
+        // Both nodes end here
+        if (a->is_prefix && !b->is_prefix) {
+            report(c, PREFIX_DIFF_DEL, path, a->mask);
+        } else if (b->is_prefix && !a->is_prefix) {
+            report(c, PREFIX_DIFF_ADD, path, b->mask);
+        }
+        diff_walk(c, a->left, d, b->left, d, d, path);
+        diff_walk(c, a->right, d, b->right, d, d, path);
+        return;
+    }
+
+    if (ae == d) {
+        // a ends here, b continues in a single direction
+        if (a->is_prefix) {
+            report(c, PREFIX_DIFF_DEL, path, a->mask);
+        }
+        bool b_right = get_bit(node_path(path, bs, b), d);
+        diff_walk(c, a->left, d, b_right ? NULL : b, bs, d, path);
+        diff_walk(c, a->right, d, b_right ? b : NULL, bs, d, path);
+        return;
+    }
+
+    // b ends here, a continues in a single direction
+    if (b->is_prefix) {
+        report(c, PREFIX_DIFF_ADD, path, b->mask);
+    }
+    bool a_right = get_bit(node_path(path, as, a), d);
+    diff_walk(c, a_right ? NULL : a, as, b->left, d, d, path);
+    diff_walk(c, a_right ? a : NULL, as, b->right, d, d, path);
+}
+
+int prefix_table_diff(const prefix_table_t *from, const prefix_table_t *to,
+                      prefix_diff_cb cb, void *ctx) {
+    if (from == NULL || to == NULL) {
+        return -1;
+    }
+
+    diff_ctx_t c = {cb, ctx, 0};
+    if (from != to) {
+        diff_walk(&c, from->root, 0, to->root, 0, 0, 0);
+    }
+    return c.changes;
+}
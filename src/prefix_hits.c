@@ -0,0 +1,260 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file prefix_hits.c
+ * @brief Optional per-prefix hit counters.
+ *
+ * Compiled to stubs unless PREFIX_MGMT_HIT_COUNTERS is defined.
+ */
+
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+
+/**
+ * @brief Creates empty counters for a new table.
+ *
+ * @return Counters, or NULL if allocation fails
+ */
+struct hit_counters *hits_create(void) {
+    return (struct hit_counters *)calloc(1, sizeof(struct hit_counters));
+}
+
+/**
+ * @brief Frees the counters of a table.
+ *
+ * @param hits Counters (can be NULL)
+ */
+void hits_destroy(struct hit_counters *hits) {
+    if (hits == NULL) {
+        return;
+    }
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        free(hits->shard[s]);
+    }
+    free(hits->free_ids);
+    free(hits);
+}
+
+/**
+ * @brief Grows every allocated shard to at least @p capacity counters.
+ *
+ * @param hits     Counters
+ * @param capacity Required number of counters per shard
+ * @return 0 on success, -1 if allocation fails
+ */
+static int grow(struct hit_counters *hits, unsigned int capacity) {
+    unsigned int new_capacity = (hits->capacity == 0) ? 1024 : hits->capacity;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        if (hits->shard[s] == NULL) {
+            continue;
+        }
+        uint64_t *grown = (uint64_t *)realloc(
+            hits->shard[s], new_capacity * sizeof(uint64_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        memset(grown + hits->capacity, 0,
+               (new_capacity - hits->capacity) * sizeof(uint64_t));
+        hits->shard[s] = grown;
+    }
+    hits->capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Assigns counters to a new node.
+ *
+ * Reuses the id of a freed node when possible.
+ *
+ * @param hits Counters of the node's table
+ * @param node New node
+ * @return 0 on success, -1 if allocation fails
+ */
+int hits_node_init(struct hit_counters *hits, radix_node_t *node) {
+    if (hits->free_count > 0) {
+        node->id = hits->free_ids[--hits->free_count];
+        return 0;
+    }
+    if (hits->next_id >= hits->capacity &&
+        grow(hits, hits->next_id + 1) != 0) {
+        return -1;
+    }
+    node->id = hits->next_id++;
+    return 0;
+}
+
+/**
+ * @brief Sets the counters of a node to zero in every shard.
+ *
+ * @param hits Counters of the node's table
+ * @param node Node
+ */
+void hits_node_clear(struct hit_counters *hits, radix_node_t *node) {
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        if (hits->shard[s] != NULL) {
+            hits->shard[s][node->id] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Returns the counters of a freed node for reuse.
+ *
+ * If the free list cannot grow the id is simply not reused.
+ *
+ * @param hits Counters of the node's table
+ * @param node Node being freed
+ */
+void hits_node_release(struct hit_counters *hits, radix_node_t *node) {
+    hits_node_clear(hits, node);
+
+    if (hits->free_count == hits->free_capacity) {
+        unsigned int capacity =
+            (hits->free_capacity == 0) ? 64 : hits->free_capacity * 2;
+        unsigned int *grown = (unsigned int *)realloc(
+            hits->free_ids, capacity * sizeof(unsigned int));
+        if (grown == NULL) {
+            return;
+        }
+        hits->free_ids = grown;
+        hits->free_capacity = capacity;
+    }
+    hits->free_ids[hits->free_count++] = node->id;
+}
+
+/**
+ * @brief Allocates the counter array of a shard on first use.
+ *
+ * @param hits  Counters of the table
+ * @param index Shard index
+ * @return Counter array, or NULL if allocation fails
+ */
+uint64_t *hits_shard_alloc(struct hit_counters *hits, int index) {
+    uint64_t **slot = &hits->shard[index];
+    uint64_t *shard = NULL;
+
+    uint64_t *fresh = (uint64_t *)calloc(hits->capacity, sizeof(uint64_t));
+    if (fresh == NULL) {
+        return NULL;
+    }
+    // Another thread of the shared shard may have won the race
+    if (!__atomic_compare_exchange_n(slot, &shard, fresh, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(fresh);
+    }
+    return __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Returns the memory held by the counters of a table.
+ *
+ * @param hits Counters
+ * @return Size in bytes
+ */
+size_t hits_bytes(const struct hit_counters *hits) {
+    size_t bytes = sizeof(*hits) + hits->free_capacity * sizeof(unsigned int);
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        if (__atomic_load_n(&hits->shard[s], __ATOMIC_ACQUIRE) != NULL) {
+            bytes += hits->capacity * sizeof(uint64_t);
+        }
+    }
+    return bytes;
+}
+
+/**
+ * @brief Sums the counters of one node over all shards.
+ *
+ * @param hits Counters of the node's table
+ * @param node Node
+ * @return Total count
+ */
+static uint64_t node_hits(const struct hit_counters *hits,
+                          const radix_node_t *node) {
+    uint64_t total = 0;
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        const uint64_t *shard = __atomic_load_n(&hits->shard[s],
+                                                __ATOMIC_ACQUIRE);
+        if (shard != NULL) {
+            total += __atomic_load_n(&shard[node->id], __ATOMIC_RELAXED);
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Reports the counters of every prefix of a subtree.
+ *
+ * @param hits  Counters of the table
+ * @param node  Subtree root (can be NULL)
+ * @param start Depth at which @p node's bits begin
+ * @param path  Address bits above @p start
+ * @param cb    User callback
+ * @param ctx   User pointer
+ * @return Number of prefixes reported
+ */
+static int report_subtree(const struct hit_counters *hits,
+                          const radix_node_t *node, int start,
+                          unsigned int path, prefix_hits_cb cb, void *ctx) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    unsigned int full = node_path(path, start, node);
+    int end = start + node->skip;
+    int reported = 0;
+
+    if (node->is_prefix) {
+        if (cb != NULL) {
+            cb(full, node->mask, node_hits(hits, node), ctx);
+        }
+        reported++;
+    }
+    reported += report_subtree(hits, node->left, end, full, cb, ctx);
+    reported += report_subtree(hits, node->right, end, full, cb, ctx);
+    return reported;
+}
+
+int prefix_table_hits(const prefix_table_t *table, prefix_hits_cb cb,
+                      void *ctx) {
+    if (table == NULL) {
+        return -1;
+    }
+    return report_subtree(table->hits, table->root, 0, 0, cb, ctx);
+}
+
+int prefix_table_hits_reset(prefix_table_t *table) {
+    if (table == NULL) {
+        return -1;
+    }
+    for (int s = 0; s < HIT_SHARDS; s++) {
+        if (table->hits->shard[s] != NULL) {
+            memset(table->hits->shard[s], 0,
+                   table->hits->capacity * sizeof(uint64_t));
+        }
+    }
+    return 0;
+}
+
+#else /* !PREFIX_MGMT_HIT_COUNTERS */
+
+int prefix_table_hits(const prefix_table_t *table, prefix_hits_cb cb,
+                      void *ctx) {
+    (void)table;
+    (void)cb;
+    (void)ctx;
+    return -1;
+}
+
+int prefix_table_hits_reset(prefix_table_t *table) {
+    (void)table;
+    return -1;
+}
+
+#endif /* PREFIX_MGMT_HIT_COUNTERS */
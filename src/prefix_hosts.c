@@ -0,0 +1,168 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file prefix_hosts.c
+ * @brief Hash set of /32 prefixes probed by check() before the tree.
+ *
+ * The set mirrors the /32 prefixes of the tree. add() and del() keep it
+ * up to date with every host prefix they store or remove, del_covered()
+ * with every /32 of the subtree it frees; operations that rebuild a table
+ * on the side refill it with host_set_rebuild().
+ */
+
+/** Slots allocated on the first insertion */
+#define HOSTS_MIN_CAPACITY 64
+
+struct host_set *host_set_create(void) {
+    return (struct host_set *)calloc(1, sizeof(struct host_set));
+}
+
+void host_set_destroy(struct host_set *hosts) {
+    if (hosts == NULL) {
+        return;
+    }
+    free(hosts->slots);
+    free(hosts);
+}
+
+/**
+ * @brief Stores an address known not to be in the set.
+ *
+ * @param slots    Slot array with at least one free slot
+ * @param capacity Number of slots
+ * @param ip       Non-zero address
+ */
+static void slot_put(unsigned int *slots, size_t capacity, unsigned int ip) {
+    size_t i = host_slot(ip, capacity);
+    while (slots[i] != 0) {
+        i = (i + 1) & (capacity - 1);
+    }
+    slots[i] = ip;
+}
+
+/**
+ * @brief Doubles the slot array (or allocates the first one).
+ *
+ * @param hosts Set
+ * @return 0 on success, -1 if allocation fails (the set is unchanged)
+ */
+static int grow(struct host_set *hosts) {
+    size_t capacity =
+        (hosts->capacity == 0) ? HOSTS_MIN_CAPACITY : hosts->capacity * 2;
+    unsigned int *slots = (unsigned int *)calloc(capacity, sizeof(*slots));
+    if (slots == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < hosts->capacity; i++) {
+        if (hosts->slots[i] != 0) {
+            slot_put(slots, capacity, hosts->slots[i]);
+        }
+    }
+    free(hosts->slots);
+    hosts->slots = slots;
+    hosts->capacity = capacity;
+    return 0;
+}
+
+void host_set_insert(struct host_set *hosts, unsigned int ip) {
+    if (ip == 0) {
+        hosts->has_zero = true;
+        return;
+    }
+    if (host_set_contains(hosts, ip)) {
+        return;
+    }
+    // Keep the load at or below one half; if growing fails the address
+    // is only in the tree, which check() falls back to
+    if ((hosts->count + 1) * 2 > hosts->capacity && grow(hosts) != 0) {
+        return;
+    }
+    slot_put(hosts->slots, hosts->capacity, ip);
+    hosts->count++;
+}
+
+/**
+ * @brief Empties a slot and moves later entries of its cluster back.
+ *
+ * Backward-shift deletion: no tombstones, so probes stay short.
+ *
+ * @param hosts Set
+ * @param hole  Slot to empty
+ */
+static void remove_at(struct host_set *hosts, size_t hole) {
+    size_t mask = hosts->capacity - 1;
+    for (size_t i = (hole + 1) & mask; hosts->slots[i] != 0;
+         i = (i + 1) & mask) {
+        // An entry may fill the hole if its home is not after the hole
+        size_t home = host_slot(hosts->slots[i], hosts->capacity);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            hosts->slots[hole] = hosts->slots[i];
+            hole = i;
+        }
+    }
+    hosts->slots[hole] = 0;
+    hosts->count--;
+}
+
+void host_set_remove(struct host_set *hosts, unsigned int ip) {
+    if (ip == 0) {
+        hosts->has_zero = false;
+        return;
+    }
+    if (hosts->count == 0) {
+        return;
+    }
+    size_t mask = hosts->capacity - 1;
+    for (size_t i = host_slot(ip, hosts->capacity); hosts->slots[i] != 0;
+         i = (i + 1) & mask) {
+        if (hosts->slots[i] == ip) {
+            remove_at(hosts, i);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Adds every /32 prefix of a subtree to a set.
+ *
+ * @param hosts Set
+ * @param node  Subtree root (can be NULL)
+ * @param path  Path bits above @p node
+ * @param start Depth at which the bits of @p node begin
+ */
+static void fill(struct host_set *hosts, const radix_node_t *node,
+                 unsigned int path, int start) {
+    if (node == NULL) {
+        return;
+    }
+    path = node_path(path, start, node);
+    start += node->skip;
+    if (node->is_prefix && node->mask == 32) {
+        host_set_insert(hosts, path);
+    }
+    fill(hosts, node->left, path, start);
+    fill(hosts, node->right, path, start);
+}
+
+void host_set_rebuild(prefix_table_t *table) {
+    struct host_set *hosts = table->hosts;
+    if (hosts == NULL) {
+        return;
+    }
+    hosts->count = 0;
+    hosts->has_zero = false;
+    if (hosts->slots != NULL) {
+        memset(hosts->slots, 0, hosts->capacity * sizeof(*hosts->slots));
+    }
+    fill(hosts, table->root->left, 0, 0);
+    fill(hosts, table->root->right, 0, 0);
+}
+
+size_t host_set_bytes(const struct host_set *hosts) {
+    return (hosts == NULL)
+               ? 0
+               : sizeof(*hosts) + hosts->capacity * sizeof(*hosts->slots);
+}
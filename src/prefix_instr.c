@@ -0,0 +1,186 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file prefix_instr.c
+ * @brief Optional latency and depth instrumentation.
+ *
+ * Snapshot and reset are compiled to stubs unless PREFIX_MGMT_INSTRUMENT
+ * is defined. The histogram helpers are always available.
+ */
+
+uint64_t prefix_instr_bucket_floor(int bucket) {
+    if (bucket < 4) {
+        return (bucket < 0) ? 0 : (uint64_t)bucket;
+    }
+    int exp = bucket / 4 + 1;
+    return (uint64_t)(4 + bucket % 4) << (exp - 2);
+}
+
+uint64_t prefix_instr_percentile(const prefix_op_histogram_t *h, double p) {
+    if (h == NULL || h->count == 0) {
+        return 0;
+    }
+
+    // Rank of the wanted call, 1-based
+    uint64_t rank = (uint64_t)((double)h->count * p / 100.0 + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int b = 0; b < PREFIX_INSTR_LATENCY_BUCKETS; b++) {
+        seen += h->latency[b];
+        if (seen >= rank) {
+            return prefix_instr_bucket_floor(b);
+        }
+    }
+    return prefix_instr_bucket_floor(PREFIX_INSTR_LATENCY_BUCKETS - 1);
+}
+
+#ifdef PREFIX_MGMT_INSTRUMENT
+
+/**
+ * @brief Creates empty histograms for a new table.
+ *
+ * @return Histograms, or NULL if allocation fails
+ */
+struct instr_stats *instr_create(void) {
+    return (struct instr_stats *)calloc(1, sizeof(struct instr_stats));
+}
+
+/**
+ * @brief Frees the histograms of a table.
+ *
+ * @param instr Histograms (can be NULL)
+ */
+void instr_destroy(struct instr_stats *instr) {
+    if (instr == NULL) {
+        return;
+    }
+    for (int s = 0; s < INSTR_SHARDS; s++) {
+        free(instr->shard[s]);
+    }
+    free(instr);
+}
+
+/**
+ * @brief Allocates the histograms of a shard on first use.
+ *
+ * @param instr Histograms of the table
+ * @param index Shard index
+ * @return One histogram per operation, or NULL if allocation fails
+ */
+prefix_op_histogram_t *instr_shard_alloc(struct instr_stats *instr,
+                                         int index) {
+    prefix_op_histogram_t **slot = &instr->shard[index];
+    prefix_op_histogram_t *shard = NULL;
+
+    prefix_op_histogram_t *fresh = (prefix_op_histogram_t *)calloc(
+        PREFIX_OP_COUNT, sizeof(prefix_op_histogram_t));
+    if (fresh == NULL) {
+        return NULL;
+    }
+    // Another thread of the shared shard may have won the race
+    if (!__atomic_compare_exchange_n(slot, &shard, fresh, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(fresh);
+    }
+    return __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Monotonic clock used where no TSC is available.
+ *
+ * @return Nanoseconds
+ */
+uint64_t instr_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the memory held by the histograms of a table.
+ *
+ * @param instr Histograms
+ * @return Size in bytes
+ */
+size_t instr_bytes(const struct instr_stats *instr) {
+    size_t bytes = sizeof(*instr);
+    for (int s = 0; s < INSTR_SHARDS; s++) {
+        if (__atomic_load_n(&instr->shard[s], __ATOMIC_ACQUIRE) != NULL) {
+            bytes += PREFIX_OP_COUNT * sizeof(prefix_op_histogram_t);
+        }
+    }
+    return bytes;
+}
+
+int prefix_table_instr_snapshot(const prefix_table_t *table,
+                                prefix_instr_snapshot_t *out) {
+    if (table == NULL || out == NULL) {
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+#if defined(__x86_64__) || defined(__i386__)
+    out->cycles = true;
+#endif
+
+    for (int s = 0; s < INSTR_SHARDS; s++) {
+        const prefix_op_histogram_t *shard =
+            __atomic_load_n(&table->instr->shard[s], __ATOMIC_ACQUIRE);
+        if (shard == NULL) {
+            continue;
+        }
+        for (int op = 0; op < PREFIX_OP_COUNT; op++) {
+            prefix_op_histogram_t *dst = &out->op[op];
+            const prefix_op_histogram_t *src = &shard[op];
+            dst->count += __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+            for (int b = 0; b < PREFIX_INSTR_LATENCY_BUCKETS; b++) {
+                dst->latency[b] +=
+                    __atomic_load_n(&src->latency[b], __ATOMIC_RELAXED);
+            }
+            for (int d = 0; d < PREFIX_INSTR_DEPTH_BUCKETS; d++) {
+                dst->depth[d] +=
+                    __atomic_load_n(&src->depth[d], __ATOMIC_RELAXED);
+            }
+        }
+    }
+    return 0;
+}
+
+int prefix_table_instr_reset(prefix_table_t *table) {
+    if (table == NULL) {
+        return -1;
+    }
+    for (int s = 0; s < INSTR_SHARDS; s++) {
+        if (table->instr->shard[s] != NULL) {
+            memset(table->instr->shard[s], 0,
+                   PREFIX_OP_COUNT * sizeof(prefix_op_histogram_t));
+        }
+    }
+    return 0;
+}
+
+#else /* !PREFIX_MGMT_INSTRUMENT */
+
+int prefix_table_instr_snapshot(const prefix_table_t *table,
+                                prefix_instr_snapshot_t *out) {
+    (void)table;
+    (void)out;
+    return -1;
+}
+
+int prefix_table_instr_reset(prefix_table_t *table) {
+    (void)table;
+    return -1;
+}
+
+#endif /* PREFIX_MGMT_INSTRUMENT */
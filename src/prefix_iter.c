@@ -0,0 +1,127 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file prefix_iter.c
+ * @brief Non-recursive, allocation-free walk over stored prefixes.
+ *
+ * The iterator keeps the path from the root to the current node on a fixed
+ * stack. Each frame remembers which step comes next for its node, so a
+ * pre-order walk (node, left subtree, right subtree) can be resumed after
+ * every returned prefix. Pre-order is address order for prefixes.
+ */
+
+/**
+ * @brief Pushes a node onto the iterator stack.
+ *
+ * @param it     Iterator
+ * @param node   Node to push
+ * @param parent Frame of the parent node, or NULL for the root
+ * @param state  First step to take for the node
+ */
+static void push(prefix_iter_t *it, const radix_node_t *node,
+                 const prefix_iter_frame_t *parent, unsigned char state) {
+    prefix_iter_frame_t *f = &it->stack[it->top++];
+    int start = (parent == NULL) ? 0 : parent->end;
+
+    f->node = node;
+    f->path = node_path((parent == NULL) ? 0 : parent->path, start, node);
+    f->end = (unsigned char)(start + node->skip);
+    f->state = state;
+}
+
+void prefix_iter_init(prefix_iter_t *it, const prefix_table_t *table) {
+    it->top = 0;
+    if (table != NULL) {
+        push(it, table->root, NULL, 0);
+    }
+}
+
+int prefix_iter_seek(prefix_iter_t *it, const prefix_table_t *table,
+                     unsigned int base, char mask) {
+    it->top = 0;
+    if (!is_valid_mask(mask) || !is_aligned(base, mask)) {
+        return -1;
+    }
+    if (table == NULL) {
+        return 0;
+    }
+
+    const radix_node_t *node = table->root;
+    const prefix_iter_frame_t *parent = NULL;
+
+    while (node != NULL) {
+        push(it, node, parent, 0);
+        prefix_iter_frame_t *f = &it->stack[it->top - 1];
+
+        // Compare the node's path with the key on their common length
+        int len = (f->end < mask) ? f->end : mask;
+        unsigned int node_bits = f->path & net_mask(len);
+        unsigned int key_bits = base & net_mask(len);
+
+        if (node_bits < key_bits) {
+            // Whole subtree sorts before the key
+            it->top--;
+            return 0;
+        }
+        if (node_bits > key_bits || f->end >= mask) {
+            // Whole subtree sorts at or after the key
+            return 0;
+        }
+
+        // Node lies strictly above the key - descend towards it
+        if (get_bit(base, f->end) == 0) {
+            f->state = 2;
+            node = node->left;
+        } else {
+            f->state = 3;
+            node = node->right;
+        }
+        parent = f;
+    }
+
+    return 0;
+}
+
+bool prefix_iter_next(prefix_iter_t *it, unsigned int *base, char *mask) {
+    while (it->top > 0) {
+        prefix_iter_frame_t *f = &it->stack[it->top - 1];
+        const radix_node_t *node = f->node;
+
+        switch (f->state++) {
+        case 0:
+            if (node->is_prefix) {
+                *base = f->path;
+                *mask = node->mask;
+                return true;
+            }
+            break;
+        case 1:
+            if (node->left != NULL) {
+                push(it, node->left, f, 0);
+            }
+            break;
+        case 2:
+            if (node->right != NULL) {
+                push(it, node->right, f, 0);
+            }
+            break;
+        default:
+            it->top--;
+            break;
+        }
+    }
+
+    return false;
+}
+
+size_t prefix_iter_next_batch(prefix_iter_t *it, unsigned int *bases,
+                              char *masks, size_t max) {
+    size_t n = 0;
+    while (n < max && prefix_iter_next(it, &bases[n], &masks[n])) {
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,208 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * @file prefix_layout.c
+ * @brief Copy of a tree into one buffer in a lookup-friendly order.
+ *
+ * The nodes are first listed in the requested order, then copied into a
+ * fresh buffer at their list position. Each old node's @c prefix field is
+ * overwritten with its new index (the node is discarded afterwards), so
+ * child pointers can be translated without a lookup table.
+ */
+
+/**
+ * @brief Node list being built.
+ */
+typedef struct {
+    radix_node_t **order; /**< Nodes in layout order */
+    size_t count;         /**< Nodes listed so far */
+} layout_ctx_t;
+
+/**
+ * @brief Lists a subtree in pre-order, left child first.
+ *
+ * @param c    Node list
+ * @param node Subtree root
+ */
+static void list_dfs(layout_ctx_t *c, radix_node_t *node) {
+    c->order[c->count++] = node;
+    if (node->left != NULL) {
+        list_dfs(c, node->left);
+    }
+    if (node->right != NULL) {
+        list_dfs(c, node->right);
+    }
+}
+
+/**
+ * @brief Lists the tree level by level, using the list itself as queue.
+ *
+ * @param c    Node list
+ * @param root Tree root
+ */
+static void list_bfs(layout_ctx_t *c, radix_node_t *root) {
+    c->order[c->count++] = root;
+    for (size_t i = 0; i < c->count; i++) {
+        radix_node_t *node = c->order[i];
+        if (node->left != NULL) {
+            c->order[c->count++] = node->left;
+        }
+        if (node->right != NULL) {
+            c->order[c->count++] = node->right;
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of node levels in a subtree.
+ *
+ * @param node Subtree root
+ * @return Height, 1 for a leaf
+ */
+static int height(const radix_node_t *node) {
+    int l = (node->left != NULL) ? height(node->left) : 0;
+    int r = (node->right != NULL) ? height(node->right) : 0;
+    return 1 + ((l > r) ? l : r);
+}
+
+static void list_veb(layout_ctx_t *c, radix_node_t *node, int levels);
+
+/**
+ * @brief Lays out, left to right, the subtrees hanging below the top
+ * @p top levels of @p node.
+ *
+ * @param c      Node list
+ * @param node   Node at relative depth @p depth
+ * @param depth  Levels above @p node within the top part
+ * @param top    Height of the top part
+ * @param bottom Height of the subtrees below it
+ */
+static void list_veb_bottom(layout_ctx_t *c, radix_node_t *node, int depth,
+                            int top, int bottom) {
+    if (depth == top) {
+        list_veb(c, node, bottom);
+        return;
+    }
+    if (node->left != NULL) {
+        list_veb_bottom(c, node->left, depth + 1, top, bottom);
+    }
+    if (node->right != NULL) {
+        list_veb_bottom(c, node->right, depth + 1, top, bottom);
+    }
+}
+
+/**
+ * @brief Lists a subtree in van Emde Boas order.
+ *
+ * The top half of the levels is laid out recursively, followed by each
+ * subtree below it, so any root-to-leaf path crosses O(log_B n) blocks of
+ * B nodes whatever B (cache line, page) is.
+ *
+ * @param c      Node list
+ * @param node   Subtree root
+ * @param levels Levels of the subtree still to lay out
+ */
+static void list_veb(layout_ctx_t *c, radix_node_t *node, int levels) {
+    if (levels == 1) {
+        c->order[c->count++] = node;
+        return;
+    }
+    int top = levels / 2;
+    list_veb(c, node, top);
+    list_veb_bottom(c, node, 0, top, levels - top);
+}
+
+/**
+ * @brief Copies the nodes of a table into a new buffer in the given order.
+ *
+ * On success the old nodes are released and @p order points to freed
+ * memory.
+ *
+ * @param table Table
+ * @param order All prefix_table::nodes nodes, root first
+ * @return 0 on success, -1 if the buffer cannot be mapped (the table is
+ *         then unchanged)
+ */
+int relayout_nodes(prefix_table_t *table, radix_node_t **order) {
+    size_t n = table->nodes;
+    size_t size = (n * sizeof(radix_node_t) + ARENA_PAGE - 1) &
+                  ~(ARENA_PAGE - 1);
+    bool hugetlb;
+    radix_node_t *dst = arena_map(size, &hugetlb);
+    if (dst == NULL) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = *order[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        order[i]->prefix = (unsigned int)i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (dst[i].left != NULL) {
+            dst[i].left = &dst[dst[i].left->prefix];
+        }
+        if (dst[i].right != NULL) {
+            dst[i].right = &dst[dst[i].right->prefix];
+        }
+    }
+
+    // Hit counter slots move with the copies, so only the memory goes
+    for (size_t i = 0; i < n; i++) {
+        node_memory_free(table, order[i]);
+    }
+    arena_unmap(table->layout.base, table->layout.size);
+
+    // The rest of the buffer takes nodes added later
+    size_t slots = size / sizeof(radix_node_t);
+    table->layout.base = (char *)dst;
+    table->layout.size = size;
+    table->layout.free_list = NULL;
+    table->layout.used = n;
+    for (size_t i = slots; i > n; i--) {
+        dst[i - 1].left = table->layout.free_list;
+        table->layout.free_list = &dst[i - 1];
+    }
+    table->root = &dst[0];
+    stride_update(table, 0, 0);
+    return 0;
+}
+
+int prefix_table_relayout(prefix_table_t *table, prefix_layout_t layout) {
+    if (table == NULL ||
+        (layout != PREFIX_LAYOUT_DFS && layout != PREFIX_LAYOUT_BFS &&
+         layout != PREFIX_LAYOUT_VEB)) {
+        return -1;
+    }
+
+    layout_ctx_t c = {
+        (radix_node_t **)malloc(table->nodes * sizeof(radix_node_t *)), 0};
+    if (c.order == NULL) {
+        return -1;
+    }
+
+    switch (layout) {
+    case PREFIX_LAYOUT_DFS:
+        list_dfs(&c, table->root);
+        break;
+    case PREFIX_LAYOUT_BFS:
+        list_bfs(&c, table->root);
+        break;
+    case PREFIX_LAYOUT_VEB:
+        list_veb(&c, table->root, height(table->root));
+        break;
+    }
+
+    int ret = relayout_nodes(table, c.order);
+    free(c.order);
+    return ret;
+}
+
+int prefix_mgmt_relayout(prefix_layout_t layout) {
+    return prefix_table_relayout(prefix_mgmt_table(), layout);
+}
@@ -1,4 +1,6 @@
 #include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
@@ -6,24 +8,87 @@
  * @file prefix_mgmt.c
  * @brief Implementation of IPv4 Prefix Management System functions.
  *
+ * The tree walks of add(), del() and check() are the 32-bit instance of
+ * radix_core.h; this file adds the table bookkeeping around them.
  */
 
 /**
- * @brief Root node of the radix tree.
+ * @brief Table used by the global API (add(), del(), check()).
  *
- * This is the starting point for all operations.
+ * Created by prefix_mgmt_init() and destroyed by prefix_mgmt_cleanup().
  */
-static radix_node_t *g_root = NULL;
+static prefix_table_t *g_table = NULL;
+
+#if defined(PREFIX_MGMT_HIT_COUNTERS) || defined(PREFIX_MGMT_INSTRUMENT)
+
+__thread int table_thread_slot = -1;
+
+/**
+ * @brief Next slot number to hand out to a thread.
+ */
+static uint64_t g_next_thread_slot = 0;
+
+/**
+ * @brief Assigns the calling thread its slot number.
+ *
+ * Numbers are never reused; beyond INT_MAX every thread gets INT_MAX,
+ * which only ever indexes a shared shard.
+ *
+ * @return Slot number
+ */
+int thread_slot_assign(void) {
+    uint64_t slot =
+        __atomic_fetch_add(&g_next_thread_slot, 1, __ATOMIC_RELAXED);
+    table_thread_slot = (slot < INT_MAX) ? (int)slot : INT_MAX;
+    return table_thread_slot;
+}
+
+#endif
+
+/**
+ * @brief Gets memory for one node.
+ *
+ * Free slots of the relayout buffer are used first, so nodes added after
+ * a relayout stay close to the rest of the tree.
+ *
+ * @param table Table the node will belong to
+ * @return Uninitialized node, or NULL if allocation fails
+ */
+static radix_node_t *node_memory_alloc(prefix_table_t *table) {
+    radix_node_t *node = table->layout.free_list;
+    if (node != NULL) {
+        table->layout.free_list = node->left;
+        table->layout.used++;
+        return node;
+    }
+    if (table->arena != NULL) {
+        return arena_alloc(table->arena);
+    }
+    return (radix_node_t *)calloc(1, sizeof(radix_node_t));
+}
+
+void node_memory_free(prefix_table_t *table, radix_node_t *node) {
+    if (in_layout(table, node)) {
+        node->left = table->layout.free_list;
+        table->layout.free_list = node;
+        table->layout.used--;
+    } else if (table->arena != NULL) {
+        arena_free(table->arena, node);
+    } else {
+        free(node);
+    }
+}
 
 /**
  * @brief Creates a new radix node.
  *
  * Allocates memory and sets all fields to default values.
  *
+ * @param table Table the node will belong to
  * @return Pointer to new node, or NULL if allocation fails
  */
-static radix_node_t *create_node(void) {
-    radix_node_t *node = (radix_node_t *)calloc(1, sizeof(radix_node_t));
+radix_node_t *create_node(prefix_table_t *table) {
+    radix_node_t *node = node_memory_alloc(table);
     if (node == NULL) {
         return NULL;
     }
@@ -33,467 +98,649 @@ static radix_node_t *create_node(void) {
     node->skip = 0;
     node->is_prefix = false;
     node->mask = -1;
+    node->covered = 0;
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    if (hits_node_init(table->hits, node) != 0) {
+        node_memory_free(table, node);
+        return NULL;
+    }
+#endif
+    table->nodes++;
     return node;
 }
 
 /**
- * @brief Frees a node and all its children.
+ * @brief Frees a single node (children are not touched).
  *
- * @param node Node to free (can be NULL)
+ * @param table Table the node belongs to
+ * @param node  Node to free
  */
-static void free_node(radix_node_t *node) {
-    if (node == NULL) {
-        return;
-    }
-    free_node(node->left);
-    free_node(node->right);
-    free(node);
+void release_node(prefix_table_t *table, radix_node_t *node) {
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    hits_node_release(table->hits, node);
+#endif
+    table->nodes--;
+    node_memory_free(table, node);
 }
 
 /**
- * @brief Gets a single bit from an IP address.
- *
- * Bits are numbered 0-31, where 0 is the leftmost bit.
+ * @brief Marks a node as holding a prefix.
  *
- * @param ip IP address
- * @param bit_pos Bit position (0-31)
- * @return 0 or 1
+ * @param table Table the node belongs to
+ * @param node  Node
+ * @param mask  Mask length of the prefix
  */
-static int get_bit(unsigned int ip, int bit_pos) {
-    return (ip >> (31 - bit_pos)) & 1;
+void set_prefix(prefix_table_t *table, radix_node_t *node, char mask) {
+    if (!node->is_prefix) {
+        table->prefixes++;
+        table->mask_count[(int)mask]++;
+    }
+    node->is_prefix = true;
+    node->mask = mask;
+    if (mask > 0) {
+        node->covered = 1u << (32 - mask);
+    }
 }
 
 /**
- * @brief Extracts multiple bits from an IP address.
+ * @brief Removes the prefix of a node.
  *
- * @param ip IP address
- * @param start_bit Starting position
- * @param num_bits How many bits to extract
- * @return Extracted bits
+ * @param table Table the node belongs to
+ * @param node  Node
  */
-static unsigned int extract_bits(unsigned int ip, int start_bit, int num_bits) {
-    if (num_bits == 0)
-        return 0;
-    if (num_bits == 32 && start_bit == 0)
-        return ip;
-    unsigned int mask = (1U << num_bits) - 1;
-    return (ip >> (32 - start_bit - num_bits)) & mask;
+void clear_prefix(prefix_table_t *table, radix_node_t *node) {
+    if (node->is_prefix) {
+        table->prefixes--;
+        table->mask_count[(int)node->mask]--;
+    }
+    node->is_prefix = false;
+    node->mask = -1;
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    hits_node_clear(table->hits, node);
+#endif
 }
 
 /**
- * @brief Counts how many bits match between two prefixes.
- *
- * Compares bits starting from start_bit and stops at first difference.
+ * @brief Frees a node and all its children.
  *
- * @param prefix1 First prefix
- * @param prefix2 Second prefix
- * @param start_bit Where to start comparing
- * @param max_bits Maximum bits to compare
- * @return Number of matching bits
+ * @param table Table the nodes belong to
+ * @param node  Node to free (can be NULL)
  */
-static int count_matching_bits(unsigned int prefix1, unsigned int prefix2,
-                               int start_bit, int max_bits) {
-    int match = 0;
-    for (int i = 0; i < max_bits; i++) {
-        if (get_bit(prefix1, start_bit + i) !=
-            get_bit(prefix2, start_bit + i)) {
-            break;
-        }
-        match++;
+static void free_node(prefix_table_t *table, radix_node_t *node) {
+    if (node == NULL) {
+        return;
     }
-    return match;
+    free_node(table, node->left);
+    free_node(table, node->right);
+    release_node(table, node);
 }
 
-#if 0
-// TODO - Check in case the current implementation is too slow.
-static inline int clz_portable(unsigned int x) {
-    if (x == 0)
-        return sizeof(unsigned int) * 8;
-
-#if defined(__GNUC__) || defined(__clang__)
-    // GCC/Clang intrinsic
-    return __builtin_clz(x);
+// Tree operations of the IPv4 instance: radix32_add(), radix32_del(),
+// radix32_cleanup_node() and radix32_walk()
+#define RADIX_NAME(x) radix32_##x
+#define RADIX_BITS_NAME(x) x
+#define RADIX_KEY unsigned int
+#define RADIX_BITS 32
+#define RADIX_NODE radix_node_t
+#define RADIX_TABLE prefix_table_t
+#define RADIX_ROOT(t) ((t)->root)
+#define RADIX_CREATE_NODE(t) create_node(t)
+#define RADIX_RELEASE_NODE(t, n) release_node(t, n)
+#define RADIX_SET_PREFIX(t, n, mask) set_prefix(t, n, (char)(mask))
+#define RADIX_CLEAR_PREFIX(t, n) clear_prefix(t, n)
+#define RADIX_DEAD_NODE(t, n) dead_node(t, n)
+#define RADIX_DEAD_UPDATE(t, before, after)                                    \
+    ((t)->dead_nodes = (t)->dead_nodes + (after) - (before))
+#define RADIX_REFRESH(n) covered_refresh(n)
+#define RADIX_REFRESH_PATH(nodes, n) covered_refresh_path(nodes, n)
+#define RADIX_CHANGED(t, base, len) stride_update(t, base, len)
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+// Counters follow the prefix into the merged node
+#define RADIX_MERGE(node, child)                                               \
+    ((node)->covered = (child)->covered, hits_node_swap(node, child))
 #else
-    // Fallback: binary search
-    int n = 0;
-    if (x <= 0x0000FFFF) {
-        n += 16;
-        x <<= 16;
-    }
-    if (x <= 0x00FFFFFF) {
-        n += 8;
-        x <<= 8;
-    }
-    if (x <= 0x0FFFFFFF) {
-        n += 4;
-        x <<= 4;
-    }
-    if (x <= 0x3FFFFFFF) {
-        n += 2;
-        x <<= 2;
-    }
-    if (x <= 0x7FFFFFFF) {
-        n += 1;
-    }
-    return n;
+#define RADIX_MERGE(node, child) ((node)->covered = (child)->covered)
 #endif
-}
-
-static int count_matching_bits(unsigned int prefix1, unsigned int prefix2,
-                               int start_bit, int max_bits) {
-    if (max_bits == 0)
-        return 0;
-
-    unsigned int p1 = prefix1 << start_bit;
-    unsigned int p2 = prefix2 << start_bit;
-    unsigned int diff = p1 ^ p2;
+#include "radix_core.h"
 
-    if (diff == 0)
-        return max_bits;
-
-    int match = clz_portable(diff);
-    return (match < max_bits) ? match : max_bits;
-}
-#endif
 /**
- * @brief Checks if mask length is valid.
+ * @brief Adds a prefix; body of prefix_table_add().
  *
- * @param mask Mask to check
- * @return true if mask is 0-32, false otherwise
+ * @param table Table to modify
+ * @param base  Base address
+ * @param mask  Mask length
+ * @param hops  Incremented for every child node inspected
+ * @return 0 on success, -1 on error
  */
-static bool is_valid_mask(char mask) { return mask >= 0 && mask <= 32; }
+static inline int add_prefix(prefix_table_t *table, unsigned int base,
+                             char mask, int *hops) {
+    if (!is_valid_mask(mask) || !is_aligned(base, mask) || table == NULL) {
+        return -1;
+    }
+    return radix32_add(table, base, mask, hops);
+}
 
 /**
- * @brief Checks if base address is correctly aligned.
+ * @brief Cleans up a radix tree node by removing or merging it if possible.
  *
- * Base is aligned if all host bits are zero.
- * Example: 192.168.1.0/24 is aligned, 192.168.1.5/24 is not.
+ * Handles three cases:
+ *  - No children: removes the node.
+ *  - One child: merges the node with its child.
+ *  - Two children: leaves the node unchanged.
+ *
+ * @param table            Table the nodes belong to.
+ * @param parent           Pointer to the parent node.
+ * @param node             Pointer to the node to clean up.
+ * @param parent_direction 0 if node is the left child, 1 if right.
  *
- * @param base Base address
- * @param mask Mask length
- * @return true if aligned, false otherwise
+ * @note The function may free memory; freed nodes must not be accessed
+ * afterward.
  */
-static bool is_aligned(unsigned int base, char mask) {
-    if (mask == 0) {
-        return base == 0;
-    }
-    if (mask == 32) {
-        return true;
-    }
-    unsigned int host_mask = (1U << (32 - mask)) - 1;
-    return (base & host_mask) == 0;
+void cleanup_node(prefix_table_t *table, radix_node_t *parent,
+                  radix_node_t *node, int parent_direction) {
+    radix32_cleanup_node(table, parent, node, parent_direction);
 }
 
-int add(unsigned int base, char mask) {
-    if (!is_valid_mask(mask)) {
+/**
+ * @brief Removes a prefix; body of prefix_table_del().
+ *
+ * @param table Table to modify
+ * @param base  Base address
+ * @param mask  Mask length
+ * @param hops  Incremented for every child node inspected
+ * @return 0 on success, -1 on error
+ */
+static inline int del_prefix(prefix_table_t *table, unsigned int base,
+                             char mask, int *hops) {
+    if (!is_valid_mask(mask) || !is_aligned(base, mask) || table == NULL) {
         return -1;
     }
+    return radix32_del(table, base, mask, hops);
+}
 
-    if (!is_aligned(base, mask)) {
-        return -1;
+/**
+ * @brief Frees a detached subtree, keeping the table counters right.
+ *
+ * Its /32 prefixes also leave the host set, so del_covered() stays
+ * proportional to the subtree rather than to the set.
+ *
+ * @param table Table the nodes belonged to
+ * @param node  Subtree root (can be NULL)
+ * @param path  Path bits above @p node
+ * @param start Depth at which the bits of @p node begin
+ * @param dead  Incremented for every dead node freed
+ * @return Number of prefixes the subtree held
+ */
+static int free_covered(prefix_table_t *table, radix_node_t *node,
+                        unsigned int path, int start, size_t *dead) {
+    if (node == NULL) {
+        return 0;
     }
+    path = node_path(path, start, node);
+    start += node->skip;
+    int removed = free_covered(table, node->left, path, start, dead) +
+                  free_covered(table, node->right, path, start, dead);
+    *dead += dead_node(table, node);
+    if (node->is_prefix) {
+        if (node->mask == 32 && table->hosts != NULL) {
+            host_set_remove(table->hosts, path);
+        }
+        clear_prefix(table, node);
+        removed++;
+    }
+    release_node(table, node);
+    return removed;
+}
 
-    if (g_root == NULL) {
+int prefix_table_del_covered(prefix_table_t *table, unsigned int base,
+                             char mask) {
+    if (!is_valid_mask(mask) || !is_aligned(base, mask) || table == NULL) {
         return -1;
     }
 
-    // Special case: /0 prefix at root
+    radix_node_t *root = table->root;
+    size_t dead = 0;
     if (mask == 0) {
-        g_root->is_prefix = true;
-        g_root->mask = 0;
-        return 0;
+        int removed = free_covered(table, root->left, 0, 0, &dead) +
+                      free_covered(table, root->right, 0, 0, &dead);
+        root->left = NULL;
+        root->right = NULL;
+        if (root->is_prefix) {
+            clear_prefix(table, root);
+            removed++;
+        }
+        table->dead_nodes -= dead;
+        stride_update(table, base, 0);
+        return removed;
     }
 
-    radix_node_t *current = g_root;
+    // Find the first node whose path reaches the mask
+    radix_node_t *parent = NULL;
+    radix_node_t *current = root;
+    int parent_bit = 0;
     int bit_pos = 0;
-
-    while (bit_pos < mask) {
-        int remaining = mask - bit_pos;
-
-        // Determine which child to follow
-        int first_bit = get_bit(base, bit_pos);
-        radix_node_t **child_ptr =
-            (first_bit == 0) ? &current->left : &current->right;
-
-        if (*child_ptr == NULL) {
-            // Create new node with compressed path
-            radix_node_t *new_node = create_node();
-            if (new_node == NULL) {
-                return -1;
-            }
-
-            new_node->skip = remaining;
-            new_node->prefix = extract_bits(base, bit_pos, remaining);
-            new_node->is_prefix = true;
-            new_node->mask = mask;
-
-            *child_ptr = new_node;
+    for (;;) {
+        int bit = get_bit(base, bit_pos);
+        radix_node_t *child = (bit == 0) ? current->left : current->right;
+        if (child == NULL) {
             return 0;
         }
 
-        // Node exists - check for path compression match
-        radix_node_t *child = *child_ptr;
-        int match_bits = count_matching_bits(
-            base, child->prefix << (32 - bit_pos - child->skip), bit_pos,
-            (remaining < child->skip) ? remaining : child->skip);
-
-        if (match_bits == child->skip && match_bits == remaining) {
-            // Perfect match - mark as prefix
-            if (child->is_prefix && child->mask == mask) {
-                return 0; // Already exists
+        int remaining = mask - bit_pos;
+        if (child->skip >= remaining) {
+            // Only the first 'remaining' bits of the child must match
+            unsigned int head = child->prefix >> (child->skip - remaining);
+            if (head != extract_bits(base, bit_pos, remaining)) {
+                return 0;
             }
-            child->is_prefix = true;
-            child->mask = mask;
-            return 0;
-        }
-
-        if (match_bits == child->skip) {
-            // Full match with child's skip - continue traversal
-            bit_pos += child->skip;
-            current = child;
-            continue;
-        }
-
-        int new_remaining = remaining - match_bits;
 
-        radix_node_t *split = create_node();
-        if (split == NULL) {
-            return -1; // Bezpieczne - nic nie zmieniliśmy
-        }
+            radix_node_t *sibling = (bit == 0) ? current->right : current->left;
+            size_t dead_before = dead_node(table, parent) +
+                                 dead_node(table, current) +
+                                 dead_node(table, sibling);
 
-        // split
-        radix_node_t *new_branch = NULL;
-        if (new_remaining > 0) {
-            new_branch = create_node();
-            if (new_branch == NULL) {
-                free(split);
-                return -1;
+            if (bit == 0) {
+                current->left = NULL;
+            } else {
+                current->right = NULL;
+            }
+            int removed = free_covered(table, child, base, bit_pos, &dead);
+
+            // Restore path compression where the subtree hung
+            bool merged = false;
+            bool gone = false;
+            if (current != root && !current->is_prefix) {
+                merged = sibling != NULL;
+                gone = sibling == NULL;
+                cleanup_node(table, parent, current, parent_bit);
             }
-        }
-
-        // Split node contains matched portion
-        split->skip = match_bits;
-        split->prefix = extract_bits(base, bit_pos, match_bits);
-
-        // Adjust child node
-        int child_remaining = child->skip - match_bits;
-        unsigned int child_new_prefix =
-            child->prefix & ((1U << child_remaining) - 1);
-
-        child->skip = child_remaining;
-        child->prefix = child_new_prefix;
-
-        // Determine where child goes under split
-        int child_bit = (child->prefix >> (child_remaining - 1)) & 1;
 
-        if (child_bit == 0) {
-            split->left = child;
-        } else {
-            split->right = child;
+            size_t dead_after = dead_node(table, parent) +
+                                (gone ? 0 : dead_node(table, current)) +
+                                (merged ? 0 : dead_node(table, sibling));
+            table->dead_nodes =
+                table->dead_nodes + dead_after - dead_before - dead;
+            // current may have been merged or removed
+            covered_update(table, base, bit_pos);
+            stride_update(table, base, bit_pos);
+            return removed;
         }
 
-        // Insert split into tree
-        *child_ptr = split;
-
-        // Check if we need to add new branch
-        if (new_remaining == 0) {
-            // Our prefix ends at split point
-            split->is_prefix = true;
-            split->mask = mask;
-        } else {
-            // Add the pre-allocated new_branch
-            new_branch->skip = new_remaining;
-            new_branch->prefix =
-                extract_bits(base, bit_pos + match_bits, new_remaining);
-            new_branch->is_prefix = true;
-            new_branch->mask = mask;
-
-            int new_bit = get_bit(base, bit_pos + match_bits);
-            if (new_bit == 0) {
-                split->left = new_branch;
-            } else {
-                split->right = new_branch;
-            }
+        unsigned int base_bits = extract_bits(base, bit_pos, child->skip);
+        if (base_bits != child->prefix) {
+            return 0;
         }
-        return 0;
+        bit_pos += child->skip;
+        parent = current;
+        parent_bit = bit;
+        current = child;
     }
-
-    return 0;
 }
 
 /**
- * @brief Cleans up a radix tree node by removing or merging it if possible.
- *
- * Handles three cases:
- *  - No children: removes the node.
- *  - One child: merges the node with its child.
- *  - Two children: leaves the node unchanged.
- *
- * @param parent           Pointer to the parent node.
- * @param node             Pointer to the node to clean up.
- * @param parent_direction 0 if node is the left child, 1 if right.
+ * @brief Finds the longest match; body of prefix_table_check().
  *
- * @note The function may free memory; freed nodes must not be accessed
- * afterward.
+ * @param table Table to search (not NULL)
+ * @param ip    Address to look up
+ * @param hops  Incremented for every child node inspected
+ * @return Mask of the longest match, or -1 if none
  */
-void cleanup_node(radix_node_t *parent, radix_node_t *node,
-                  int parent_direction) {
-
-    int child_count = (node->left != NULL) + (node->right != NULL);
-
-    // Case 1: No children - remove node completely
-    if (child_count == 0) {
+static inline char check_prefix(const prefix_table_t *table, unsigned int ip,
+                                int *hops) {
+#ifndef PREFIX_MGMT_HIT_COUNTERS
+    // A /32 is the longest possible match; with hit counters there is no
+    // set, the tree is walked so the hit is counted on the node
+    if (table->hosts != NULL && host_set_contains(table->hosts, ip)) {
+        return 32;
+    }
+#endif
+    const radix_node_t *current = table->root;
+    char best = -1;
+    int bit_pos = 0;
+#ifndef PREFIX_MGMT_HIT_COUNTERS
+    // Skip the nodes within the first 16 bits (no index with hit counters)
+    if (table->stride != NULL) {
+        const struct stride_entry *e =
+            &table->stride->entry[ip >> (32 - STRIDE_BITS)];
+        current = e->node;
+        bit_pos = e->depth;
+        best = e->best;
+    }
+#endif
 
-        // Remove from parent
-        if (parent_direction == 0) {
-            parent->left = NULL;
-        } else {
-            parent->right = NULL;
-        }
-        free(node);
-        return;
+    // Check root (or the node the walk resumes from) and below
+    const radix_node_t *best_match = radix32_walk(current, bit_pos, ip, hops);
+    if (best_match == NULL) {
+        return best;
     }
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    hits_record(table->hits, best_match);
+#endif
+    return best_match->mask;
+}
 
-    // Case 2: Exactly one child - MERGE DOWN (absorb child into this node)
-    if (child_count == 1) {
-        radix_node_t *child = (node->left != NULL) ? node->left : node->right;
+/**
+ * @brief Adds a prefix to the tree and, for a /32, to the host set.
+ *
+ * @param table Table to modify
+ * @param base  Base address
+ * @param mask  Mask length
+ * @param hops  Incremented for every child node inspected
+ * @return 0 on success, -1 on error
+ */
+static inline int add_entry(prefix_table_t *table, unsigned int base,
+                            char mask, int *hops) {
+    int ret = add_prefix(table, base, mask, hops);
+    if (ret == 0 && mask == 32 && table->hosts != NULL) {
+        host_set_insert(table->hosts, base);
+    }
+    return ret;
+}
 
-        // MERGE DOWN: This node absorbs its child
-        // Combine the path: node's prefix bits + child's prefix bits
-        unsigned int combined_prefix =
-            (node->prefix << child->skip) | child->prefix;
-        unsigned char combined_skip = node->skip + child->skip;
+/**
+ * @brief Removes a prefix from the tree and, for a /32, from the host set.
+ *
+ * @param table Table to modify
+ * @param base  Base address
+ * @param mask  Mask length
+ * @param hops  Incremented for every child node inspected
+ * @return 0 on success, -1 on error
+ */
+static inline int del_entry(prefix_table_t *table, unsigned int base,
+                            char mask, int *hops) {
+    int ret = del_prefix(table, base, mask, hops);
+    if (ret == 0 && mask == 32 && table->hosts != NULL) {
+        host_set_remove(table->hosts, base);
+    }
+    return ret;
+}
 
-        // Replace this node's data with merged data
-        node->prefix = combined_prefix;
-        node->skip = combined_skip;
-        node->left = child->left;
-        node->right = child->right;
-        node->is_prefix = child->is_prefix;
-        node->mask = child->mask;
+int prefix_table_add(prefix_table_t *table, unsigned int base, char mask) {
+    int hops = 0;
+#ifdef PREFIX_MGMT_INSTRUMENT
+    if (table != NULL) {
+        uint64_t start = instr_ticks();
+        int ret = add_entry(table, base, mask, &hops);
+        instr_record(table->instr, PREFIX_OP_ADD, start, hops);
+        return ret;
+    }
+#endif
+    return add_entry(table, base, mask, &hops);
+}
 
-        // Free the child (it's been absorbed)
-        free(child);
-        return;
+int prefix_table_del(prefix_table_t *table, unsigned int base, char mask) {
+    int hops = 0;
+#ifdef PREFIX_MGMT_INSTRUMENT
+    if (table != NULL) {
+        uint64_t start = instr_ticks();
+        int ret = del_entry(table, base, mask, &hops);
+        instr_record(table->instr, PREFIX_OP_DEL, start, hops);
+        return ret;
     }
+#endif
+    return del_entry(table, base, mask, &hops);
+}
 
-    // Case 3: Two children - keep node as branch point
-    return;
+/**
+ * @brief Body of prefix_table_check() for a non-NULL table.
+ *
+ * @param table Table to search
+ * @param ip    Address to look up
+ * @return Mask of the longest match, or -1 if none
+ */
+static inline char check_one(const prefix_table_t *table, unsigned int ip) {
+    profile_sample(table->profile, ip);
+
+    int hops = 0;
+#ifdef PREFIX_MGMT_INSTRUMENT
+    uint64_t start = instr_ticks();
+    char ret = check_prefix(table, ip, &hops);
+    instr_record(table->instr, PREFIX_OP_CHECK, start, hops);
+    return ret;
+#else
+    return check_prefix(table, ip, &hops);
+#endif
 }
 
-int del(unsigned int base, char mask) {
-    if (!is_valid_mask(mask)) {
+char prefix_table_check(const prefix_table_t *table, unsigned int ip) {
+    if (table == NULL) {
         return -1;
     }
-    if (!is_aligned(base, mask)) {
+    return check_one(table, ip);
+}
+
+int prefix_table_check_batch(const prefix_table_t *table,
+                             const unsigned int *ips, size_t n,
+                             char *masks_out) {
+    if (table == NULL || (n > 0 && (ips == NULL || masks_out == NULL))) {
         return -1;
     }
-    if (g_root == NULL) {
-        return -1;
+    for (size_t i = 0; i < n; i++) {
+        masks_out[i] = check_one(table, ips[i]);
     }
+    return 0;
+}
 
-    // Special case: /0 prefix
-    if (mask == 0) {
-        g_root->is_prefix = false;
-        g_root->mask = -1;
-        return 0;
+/**
+ * @brief One node on the path kept by prefix_table_check_sorted().
+ */
+typedef struct {
+    const radix_node_t *node; /**< Node on the path */
+    const radix_node_t *best; /**< Longest match down to it, or NULL */
+    unsigned int path;        /**< Address bits up to the end of the node */
+    int end;                  /**< Depth at which the node's bits end */
+} sorted_frame_t;
+
+int prefix_table_check_sorted(const prefix_table_t *table,
+                              const unsigned int *ips, size_t n,
+                              char *masks_out) {
+    if (table == NULL || (n > 0 && (ips == NULL || masks_out == NULL))) {
+        return -1;
     }
 
-    // Traverse to find the prefix
-    radix_node_t *current = g_root;
-    int bit_pos = 0;
-
-    while (bit_pos < mask) {
-        int bit = get_bit(base, bit_pos);
-        radix_node_t *child = (bit == 0) ? current->left : current->right;
+    sorted_frame_t stack[33];
+    int top = 0;
+    stack[0].node = table->root;
+    stack[0].best = table->root->is_prefix ? table->root : NULL;
+    stack[0].path = 0;
+    stack[0].end = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned int ip = ips[i];
+        profile_sample(table->profile, ip);
+#ifdef PREFIX_MGMT_INSTRUMENT
+        uint64_t start = instr_ticks();
+#endif
+        int hops = 0;
 
-        if (child == NULL) {
-            return 0; // Prefix doesn't exist
+        // Back up to the deepest node of the previous path that ip shares
+        while (top > 0 &&
+               ((ip ^ stack[top].path) & net_mask(stack[top].end)) != 0) {
+            top--;
         }
 
-        int remaining = mask - bit_pos;
-        if (child->skip > remaining) {
-            return 0; // Can't reach this prefix
+        // Continue the walk from there
+        while (stack[top].end < 32) {
+            const sorted_frame_t *f = &stack[top];
+            const radix_node_t *child =
+                (get_bit(ip, f->end) == 0) ? f->node->left : f->node->right;
+            if (child == NULL) {
+                break;
+            }
+            hops++;
+            if (extract_bits(ip, f->end, child->skip) != child->prefix) {
+                break;
+            }
+            sorted_frame_t *next = &stack[top + 1];
+            next->node = child;
+            next->best = child->is_prefix ? child : f->best;
+            next->path = node_path(f->path, f->end, child);
+            next->end = f->end + child->skip;
+            top++;
         }
 
-        unsigned int base_bits = extract_bits(base, bit_pos, child->skip);
-        if (base_bits != child->prefix) {
-            return 0; // Path doesn't match
+        const radix_node_t *best = stack[top].best;
+        masks_out[i] = (best == NULL) ? -1 : best->mask;
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+        if (best != NULL) {
+            hits_record(table->hits, best);
         }
+#endif
+#ifdef PREFIX_MGMT_INSTRUMENT
+        instr_record(table->instr, PREFIX_OP_CHECK, start, hops);
+#endif
+    }
+    return 0;
+}
 
-        bit_pos += child->skip;
-
-        if (bit_pos == mask) {
-            // Found the target node
-            if (!child->is_prefix || child->mask != mask) {
-                return 0; // Prefix wasn't set
-            }
+prefix_table_t *prefix_table_create(void) {
+    return prefix_table_create_ex(NULL);
+}
 
-            // Mark as deleted
-            child->is_prefix = false;
-            child->mask = -1;
+prefix_table_t *prefix_table_create_ex(const prefix_table_opts_t *opts) {
+    unsigned int known = PREFIX_OPT_HOST_HASH | PREFIX_OPT_STRIDE16;
+    if (opts != NULL && ((opts->alloc != PREFIX_ALLOC_HEAP &&
+                          opts->alloc != PREFIX_ALLOC_HUGEPAGE) ||
+                         (opts->flags & ~known) != 0)) {
+        return NULL;
+    }
 
-            // Cleanup this node (merge down with child or remove if leaf)
-            cleanup_node(current, child, bit);
+    prefix_table_t *table = (prefix_table_t *)calloc(1, sizeof(*table));
+    if (table == NULL) {
+        return NULL;
+    }
+    if (opts != NULL) {
+        table->opts = *opts;
+    }
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    // check() walks the tree from the root to count every hit, so the set
+    // and the index would only cost memory and update time
+    table->opts.flags &= ~(PREFIX_OPT_HOST_HASH | PREFIX_OPT_STRIDE16);
+#endif
 
-            return 0;
+    if (table->opts.alloc == PREFIX_ALLOC_HUGEPAGE) {
+        table->arena = arena_create(table->opts.arena_chunk);
+        if (table->arena == NULL) {
+            free(table);
+            return NULL;
         }
+    }
+    if (table->opts.flags & PREFIX_OPT_HOST_HASH) {
+        table->hosts = host_set_create();
+        if (table->hosts == NULL) {
+            prefix_table_destroy(table);
+            return NULL;
+        }
+    }
 
-        // Move to next node
-        current = child;
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    table->hits = hits_create();
+    if (table->hits == NULL) {
+        prefix_table_destroy(table);
+        return NULL;
+    }
+#endif
+#ifdef PREFIX_MGMT_INSTRUMENT
+    table->instr = instr_create();
+    if (table->instr == NULL) {
+        prefix_table_destroy(table);
+        return NULL;
     }
+#endif
 
-    return 0;
-}
+    table->root = create_node(table);
+    if (table->root == NULL) {
+        prefix_table_destroy(table);
+        return NULL;
+    }
 
-char check(unsigned int ip) {
-    if (g_root == NULL) {
-        return -1;
+    if (table->opts.flags & PREFIX_OPT_STRIDE16) {
+        table->stride = stride_create();
+        if (table->stride == NULL) {
+            prefix_table_destroy(table);
+            return NULL;
+        }
+        stride_update(table, 0, 0);
     }
 
-    radix_node_t *current = g_root;
-    char best_match = -1;
+    return table;
+}
 
-    // Check root
-    if (current->is_prefix) {
-        best_match = current->mask;
+void prefix_table_destroy(prefix_table_t *table) {
+    if (table == NULL) {
+        return;
     }
-    int bit_pos = 0;
-    while (bit_pos < 32) {
-        int bit = get_bit(ip, bit_pos);
-        radix_node_t *child = (bit == 0) ? current->left : current->right;
+    free_node(table, table->root);
+    arena_unmap(table->layout.base, table->layout.size);
+    arena_destroy(table->arena);
+    host_set_destroy(table->hosts);
+    stride_destroy(table->stride);
+    profile_destroy(table->profile);
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    hits_destroy(table->hits);
+#endif
+#ifdef PREFIX_MGMT_INSTRUMENT
+    instr_destroy(table->instr);
+#endif
+    free(table);
+}
 
-        if (child == NULL) {
-            break;
-        }
+void table_swap(prefix_table_t *a, prefix_table_t *b) {
+    prefix_table_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+
+    // Sampled traffic belongs to the handle it was sampled on
+    struct lookup_profile *profile = a->profile;
+    a->profile = b->profile;
+    b->profile = profile;
+#ifdef PREFIX_MGMT_INSTRUMENT
+    // Measurements stay with the handle they were taken on
+    struct instr_stats *instr = a->instr;
+    a->instr = b->instr;
+    b->instr = instr;
+#endif
+}
 
-        // Check if IP matches the compressed path
-        unsigned int ip_bits = extract_bits(ip, bit_pos, child->skip);
-        if (ip_bits != child->prefix) {
-            break; // Path doesn't match
-        }
+radix_node_t *prefix_table_root(const prefix_table_t *table) {
+    return (table == NULL) ? NULL : table->root;
+}
 
-        bit_pos += child->skip;
-        current = child;
+int add(unsigned int base, char mask) {
+    return prefix_table_add(g_table, base, mask);
+}
 
-        // Update best match
-        if (current->is_prefix) {
-            best_match = current->mask;
-        }
-    }
+int del(unsigned int base, char mask) {
+    return prefix_table_del(g_table, base, mask);
+}
 
-    return best_match;
+int del_covered(unsigned int base, char mask) {
+    return prefix_table_del_covered(g_table, base, mask);
 }
 
-radix_node_t *get_root_addr(void) { return g_root; }
+char check(unsigned int ip) { return prefix_table_check(g_table, ip); }
+
+int check_batch(const unsigned int *ips, size_t n, char *masks_out) {
+    return prefix_table_check_batch(g_table, ips, n, masks_out);
+}
+
+int check_sorted(const unsigned int *ips, size_t n, char *masks_out) {
+    return prefix_table_check_sorted(g_table, ips, n, masks_out);
+}
+
+radix_node_t *get_root_addr(void) { return prefix_table_root(g_table); }
+
+prefix_table_t *prefix_mgmt_table(void) { return g_table; }
+
+int prefix_mgmt_init(void) { return prefix_mgmt_init_ex(NULL); }
 
-int prefix_mgmt_init(void) {
-    if (g_root != NULL) {
+int prefix_mgmt_init_ex(const prefix_table_opts_t *opts) {
+    if (g_table != NULL) {
         prefix_mgmt_cleanup();
     }
 
-    g_root = create_node();
-    if (g_root == NULL) {
+    g_table = prefix_table_create_ex(opts);
+    if (g_table == NULL) {
         return -1;
     }
 
@@ -501,8 +748,8 @@ int prefix_mgmt_init(void) {
 }
 
 void prefix_mgmt_cleanup(void) {
-    if (g_root != NULL) {
-        free_node(g_root);
-        g_root = NULL;
+    if (g_table != NULL) {
+        prefix_table_destroy(g_table);
+        g_table = NULL;
     }
 }
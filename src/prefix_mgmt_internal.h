@@ -0,0 +1,632 @@
+#ifndef PREFIX_MGMT_INTERNAL_H
+#define PREFIX_MGMT_INTERNAL_H
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file prefix_mgmt_internal.h
+ * @brief Definitions shared between the library translation units.
+ *
+ * Not part of the public interface.
+ */
+
+/**
+ * @struct prefix_table
+ * @brief One independent prefix collection.
+ *
+ * @var prefix_table::root
+ * Root node of the radix tree (always allocated)
+ *
+ * @var prefix_table::prefixes
+ * Number of stored prefixes
+ *
+ * @var prefix_table::nodes
+ * Number of allocated nodes, root included
+ *
+ * @var prefix_table::dead_nodes
+ * Number of non-root nodes that hold no prefix and have fewer than two
+ * children (left behind by del())
+ *
+ * @var prefix_table::mask_count
+ * Number of stored prefixes per mask length
+ *
+ * @var prefix_table::opts
+ * Options the table was created with
+ *
+ * @var prefix_table::arena
+ * Node arena (NULL with #PREFIX_ALLOC_HEAP)
+ *
+ * @var prefix_table::layout
+ * Buffer written by prefix_table_relayout() (empty until then)
+ *
+ * @var prefix_table::hosts
+ * Copy of the /32 prefixes (NULL without #PREFIX_OPT_HOST_HASH)
+ *
+ * @var prefix_table::stride
+ * Index of the first 16 address bits (NULL without #PREFIX_OPT_STRIDE16)
+ *
+ * @var prefix_table::profile
+ * Sampled lookup addresses (NULL unless prefix_table_profile_start() was
+ * called)
+ *
+ * @var prefix_table::hits
+ * Per-node hit counters (only with PREFIX_MGMT_HIT_COUNTERS)
+ *
+ * @var prefix_table::instr
+ * Latency and depth histograms (only with PREFIX_MGMT_INSTRUMENT)
+ */
+struct prefix_table {
+    radix_node_t *root;             /**< Root node of the radix tree */
+    size_t prefixes;                /**< Number of stored prefixes */
+    size_t nodes;                   /**< Number of allocated nodes */
+    size_t dead_nodes;              /**< Non-root nodes that could be merged */
+    size_t mask_count[33];          /**< Stored prefixes per mask length */
+    prefix_table_opts_t opts;       /**< Options given at creation */
+    struct node_arena *arena;       /**< Node arena, NULL for heap nodes */
+    struct node_layout {
+        char *base;              /**< Start of the buffer, NULL if none */
+        size_t size;             /**< Mapped size */
+        radix_node_t *free_list; /**< Freed slots, linked through left */
+        size_t used;             /**< Slots holding live nodes */
+    } layout;                       /**< Relayout buffer */
+    struct host_set *hosts;         /**< /32 prefixes, usually NULL */
+    struct stride_index *stride;    /**< /16 index, usually NULL */
+    struct lookup_profile *profile; /**< Sampled lookups, usually NULL */
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    struct hit_counters *hits; /**< Per-node hit counters */
+#endif
+#ifdef PREFIX_MGMT_INSTRUMENT
+    struct instr_stats *instr; /**< Latency and depth histograms */
+#endif
+};
+
+/**
+ * @struct node_arena
+ * @brief Node allocator of a #PREFIX_ALLOC_HUGEPAGE table.
+ */
+struct node_arena {
+    struct arena_chunk *chunks; /**< Mapped chunks, newest first */
+    char *cursor;               /**< Next unused byte of the newest chunk */
+    char *limit;                /**< End of the newest chunk */
+    radix_node_t *free_list;    /**< Freed nodes, linked through left */
+    size_t chunk_size;          /**< Size of each chunk */
+    size_t mapped;              /**< Total bytes mapped */
+    size_t hugetlb;             /**< Bytes mapped with MAP_HUGETLB */
+};
+
+/** Huge page size arena chunks and relayout buffers are aligned to */
+#define ARENA_PAGE ((size_t)2 << 20)
+
+struct node_arena *arena_create(size_t chunk);
+void arena_destroy(struct node_arena *arena);
+radix_node_t *arena_alloc(struct node_arena *arena);
+void arena_free(struct node_arena *arena, radix_node_t *node);
+void *arena_map(size_t size, bool *hugetlb);
+void arena_unmap(void *start, size_t size);
+
+/**
+ * @struct host_set
+ * @brief Open-addressed set of the /32 prefixes of a table.
+ *
+ * Linear probing over a power-of-two array at most half full, so a probe
+ * rarely leaves its cache line. Slot value 0 means empty; address 0 is
+ * tracked by @c has_zero. The set may miss a /32 the tree holds (when
+ * growing failed) but never holds one the tree does not: a miss falls
+ * back to the tree walk.
+ */
+struct host_set {
+    unsigned int *slots; /**< Addresses, 0 for empty (NULL until used) */
+    size_t capacity;     /**< Number of slots, 0 or a power of two */
+    size_t count;        /**< Addresses in slots */
+    bool has_zero;       /**< 0.0.0.0/32 is stored */
+};
+
+struct host_set *host_set_create(void);
+void host_set_destroy(struct host_set *hosts);
+void host_set_insert(struct host_set *hosts, unsigned int ip);
+void host_set_remove(struct host_set *hosts, unsigned int ip);
+void host_set_rebuild(prefix_table_t *table);
+size_t host_set_bytes(const struct host_set *hosts);
+
+/**
+ * @brief Home slot of an address (Fibonacci hashing).
+ *
+ * @param ip       Address
+ * @param capacity Number of slots (power of two)
+ * @return Slot index
+ */
+static inline size_t host_slot(unsigned int ip, size_t capacity) {
+    return (size_t)(((uint64_t)ip * 0x9E3779B97F4A7C15ULL) >> 32) &
+           (capacity - 1);
+}
+
+/**
+ * @brief Tells whether a /32 prefix is in the set.
+ *
+ * @param hosts Set
+ * @param ip    Address
+ * @return true if @p ip is stored
+ */
+static inline bool host_set_contains(const struct host_set *hosts,
+                                     unsigned int ip) {
+    if (ip == 0) {
+        return hosts->has_zero;
+    }
+    if (hosts->count == 0) {
+        return false;
+    }
+    size_t mask = hosts->capacity - 1;
+    for (size_t i = host_slot(ip, hosts->capacity);; i = (i + 1) & mask) {
+        unsigned int slot = hosts->slots[i];
+        if (slot == ip) {
+            return true;
+        }
+        if (slot == 0) {
+            return false;
+        }
+    }
+}
+
+/** Address bits resolved by the stride index */
+#define STRIDE_BITS 16
+
+/**
+ * @struct stride_entry
+ * @brief State of a lookup after the first #STRIDE_BITS bits of one /16.
+ *
+ * @c node is the deepest node on the path of the /16 whose bits end at or
+ * before bit #STRIDE_BITS, @c depth the bit where its bits end and
+ * @c best the longest match among the nodes down to it. A lookup
+ * continuing from there gets the same result as one from the root.
+ */
+struct stride_entry {
+    const radix_node_t *node; /**< Node to continue from */
+    unsigned char depth;      /**< Bits consumed down to @c node */
+    char best;                /**< Longest match so far, or -1 */
+};
+
+/**
+ * @struct stride_index
+ * @brief One entry per value of the first #STRIDE_BITS address bits.
+ */
+struct stride_index {
+    struct stride_entry entry[1u << STRIDE_BITS]; /**< Indexed by ip >> 16 */
+};
+
+struct stride_index *stride_create(void);
+void stride_destroy(struct stride_index *stride);
+void stride_refresh(prefix_table_t *table, unsigned int base, int len);
+
+/**
+ * @brief Recomputes the stride entries below a changed part of the tree.
+ *
+ * Called after every change to the nodes or prefixes on the path of
+ * @p base whose bits end at or before bit @p len. Changes deeper than
+ * #STRIDE_BITS leave the index untouched.
+ *
+ * @param table Table
+ * @param base  Any address inside the changed part
+ * @param len   Depth of the change
+ */
+static inline void stride_update(prefix_table_t *table, unsigned int base,
+                                 int len) {
+    if (table->stride != NULL && len <= STRIDE_BITS) {
+        stride_refresh(table, base, len);
+    }
+}
+
+/**
+ * @brief Tells whether a node lives in the table's relayout buffer.
+ *
+ * Such nodes must not be passed to free() or the arena.
+ *
+ * @param table Table
+ * @param node  Node
+ * @return true if @p node is inside prefix_table::layout
+ */
+static inline bool in_layout(const prefix_table_t *table,
+                             const radix_node_t *node) {
+    const char *p = (const char *)node;
+    return table->layout.base != NULL && p >= table->layout.base &&
+           p < table->layout.base + table->layout.size;
+}
+
+void node_memory_free(prefix_table_t *table, radix_node_t *node);
+radix_node_t *create_node(prefix_table_t *table);
+void release_node(prefix_table_t *table, radix_node_t *node);
+void set_prefix(prefix_table_t *table, radix_node_t *node, char mask);
+void clear_prefix(prefix_table_t *table, radix_node_t *node);
+void cleanup_node(prefix_table_t *table, radix_node_t *parent,
+                  radix_node_t *node, int parent_direction);
+int relayout_nodes(prefix_table_t *table, radix_node_t **order);
+
+/**
+ * @brief Creates an empty table with the same options as @p like.
+ *
+ * Used for tables built on the side and then swapped in.
+ *
+ * @param like Table to copy the options from
+ * @return New table, or NULL if allocation fails
+ */
+static inline prefix_table_t *table_create_like(const prefix_table_t *like) {
+    return prefix_table_create_ex(&like->opts);
+}
+
+#if defined(PREFIX_MGMT_HIT_COUNTERS) || defined(PREFIX_MGMT_INSTRUMENT)
+
+/** Per-thread slot number, -1 until assigned */
+extern __thread int table_thread_slot;
+
+int thread_slot_assign(void);
+
+/**
+ * @brief Returns a small number identifying the calling thread.
+ *
+ * Threads are numbered in order of first use. Per-thread statistics give
+ * each of the first threads a shard of its own and let all later threads
+ * share one more shard.
+ *
+ * @return Non-negative slot number
+ */
+static inline int thread_slot(void) {
+    int slot = table_thread_slot;
+    return (slot >= 0) ? slot : thread_slot_assign();
+}
+
+/**
+ * @brief Adds one to a counter of a per-thread shard.
+ *
+ * An owned shard has a single writer, so a relaxed load and store are
+ * enough (no locked instruction); the shared shard needs an atomic add.
+ * Either way readers on other threads see whole values.
+ *
+ * @param counter Counter
+ * @param shared  true if other threads write the same shard
+ */
+static inline void shard_count(uint64_t *counter, bool shared) {
+    if (shared) {
+        __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(counter,
+                         __atomic_load_n(counter, __ATOMIC_RELAXED) + 1,
+                         __ATOMIC_RELAXED);
+    }
+}
+
+#endif
+
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+
+/**
+ * @brief Number of threads with a counter shard of their own.
+ *
+ * The first threads (by thread_slot()) count without sharing cache lines;
+ * all later threads count into one shared shard with atomic adds.
+ */
+#define HIT_OWN_SHARDS 64
+
+/** Number of counter shards per table: the owned ones and the shared one */
+#define HIT_SHARDS (HIT_OWN_SHARDS + 1)
+
+/**
+ * @struct hit_counters
+ * @brief Hit counters of one table, sharded per thread.
+ *
+ * Every node owns an id; shard[s][id] counts the check() calls made by
+ * the threads of shard s that ended on the node. Shard HIT_OWN_SHARDS is
+ * shared by the threads beyond the first HIT_OWN_SHARDS. Shards are allocated on
+ * first use and grown by add() (never concurrently with check()).
+ */
+struct hit_counters {
+    uint64_t *shard[HIT_SHARDS]; /**< Counter arrays, NULL until used */
+    unsigned int capacity;       /**< Length of each counter array */
+    unsigned int next_id;        /**< Lowest id never handed out */
+    unsigned int *free_ids;      /**< Ids of freed nodes */
+    unsigned int free_count;     /**< Number of entries in free_ids */
+    unsigned int free_capacity;  /**< Capacity of free_ids */
+};
+
+struct hit_counters *hits_create(void);
+void hits_destroy(struct hit_counters *hits);
+int hits_node_init(struct hit_counters *hits, radix_node_t *node);
+void hits_node_release(struct hit_counters *hits, radix_node_t *node);
+void hits_node_clear(struct hit_counters *hits, radix_node_t *node);
+uint64_t *hits_shard_alloc(struct hit_counters *hits, int slot);
+size_t hits_bytes(const struct hit_counters *hits);
+
+/**
+ * @brief Gives @p node the counters of @p child and vice versa.
+ *
+ * Used when a node absorbs its child: the surviving node takes over the
+ * child's prefix and therefore its counters.
+ *
+ * @param node  Surviving node
+ * @param child Node about to be freed
+ */
+static inline void hits_node_swap(radix_node_t *node, radix_node_t *child) {
+    unsigned int id = node->id;
+    node->id = child->id;
+    child->id = id;
+}
+
+/**
+ * @brief Counts one check() that ended on @p node.
+ *
+ * @param hits Counters of the table
+ * @param node Matched node
+ */
+static inline void hits_record(struct hit_counters *hits,
+                               const radix_node_t *node) {
+    int slot = thread_slot();
+    bool shared = slot >= HIT_OWN_SHARDS;
+    int index = shared ? HIT_OWN_SHARDS : slot;
+    uint64_t *shard = __atomic_load_n(&hits->shard[index], __ATOMIC_ACQUIRE);
+    if (shard == NULL) {
+        shard = hits_shard_alloc(hits, index);
+        if (shard == NULL) {
+            return;
+        }
+    }
+    shard_count(&shard[node->id], shared);
+}
+
+#endif /* PREFIX_MGMT_HIT_COUNTERS */
+
+#ifdef PREFIX_MGMT_INSTRUMENT
+
+/**
+ * @brief Number of threads with a histogram shard of their own.
+ *
+ * Later threads record into one shared shard with atomic adds.
+ */
+#define INSTR_OWN_SHARDS 64
+
+/** Number of histogram shards per table: the owned ones and the shared one */
+#define INSTR_SHARDS (INSTR_OWN_SHARDS + 1)
+
+/**
+ * @struct instr_stats
+ * @brief Histograms of one table, sharded per thread.
+ *
+ * Shards are allocated on first use. Each holds one histogram per
+ * measured operation. Shard INSTR_OWN_SHARDS is shared by the threads
+ * beyond the first INSTR_OWN_SHARDS.
+ */
+struct instr_stats {
+    prefix_op_histogram_t *shard[INSTR_SHARDS]; /**< NULL until used */
+};
+
+struct instr_stats *instr_create(void);
+void instr_destroy(struct instr_stats *instr);
+prefix_op_histogram_t *instr_shard_alloc(struct instr_stats *instr, int slot);
+uint64_t instr_clock(void);
+size_t instr_bytes(const struct instr_stats *instr);
+
+/**
+ * @brief Reads the timestamp used for latencies.
+ *
+ * @return TSC value on x86, monotonic nanoseconds elsewhere
+ */
+static inline uint64_t instr_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return instr_clock();
+#endif
+}
+
+/**
+ * @brief Maps a latency to its log-linear histogram bucket.
+ *
+ * @param ticks Latency
+ * @return Bucket index
+ */
+static inline int instr_bucket(uint64_t ticks) {
+    if (ticks < 4) {
+        return (int)ticks;
+    }
+    int exp = 63 - __builtin_clzll(ticks);
+    int bucket = (exp - 1) * 4 + (int)((ticks >> (exp - 2)) & 3);
+    return (bucket < PREFIX_INSTR_LATENCY_BUCKETS)
+               ? bucket
+               : PREFIX_INSTR_LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @brief Records one finished operation.
+ *
+ * @param instr Histograms of the table
+ * @param op    Operation
+ * @param start instr_ticks() value taken when the operation began
+ * @param hops  Number of child links followed
+ */
+static inline void instr_record(struct instr_stats *instr, prefix_op_t op,
+                                uint64_t start, int hops) {
+    uint64_t ticks = instr_ticks() - start;
+    int slot = thread_slot();
+    bool shared = slot >= INSTR_OWN_SHARDS;
+    int index = shared ? INSTR_OWN_SHARDS : slot;
+    prefix_op_histogram_t *shard =
+        __atomic_load_n(&instr->shard[index], __ATOMIC_ACQUIRE);
+    if (shard == NULL) {
+        shard = instr_shard_alloc(instr, index);
+        if (shard == NULL) {
+            return;
+        }
+    }
+    prefix_op_histogram_t *h = &shard[op];
+    shard_count(&h->count, shared);
+    shard_count(&h->latency[instr_bucket(ticks)], shared);
+    shard_count(&h->depth[hops], shared);
+}
+
+#endif /* PREFIX_MGMT_INSTRUMENT */
+
+/**
+ * @brief Exchanges the contents of two tables.
+ *
+ * Used to publish a table built on the side under an existing handle.
+ *
+ * @param a First table
+ * @param b Second table
+ */
+void table_swap(prefix_table_t *a, prefix_table_t *b);
+
+/**
+ * @brief Tells whether a node counts towards prefix_table::dead_nodes.
+ *
+ * @param table Table the node belongs to
+ * @param node  Node (can be NULL)
+ * @return 1 for a non-root node without prefix and with fewer than two
+ *         children, 0 otherwise
+ */
+static inline size_t dead_node(const prefix_table_t *table,
+                               const radix_node_t *node) {
+    return node != NULL && node != table->root && !node->is_prefix &&
+           (node->left == NULL || node->right == NULL);
+}
+
+/**
+ * @brief Counts the leading zero bits of a value.
+ *
+ * @param x Value
+ * @return Number of leading zero bits (32 for 0)
+ */
+static inline int clz_portable(unsigned int x) {
+    if (x == 0)
+        return sizeof(unsigned int) * 8;
+
+#if defined(__GNUC__) || defined(__clang__)
+    // GCC/Clang intrinsic
+    return __builtin_clz(x);
+#else
+    // Fallback: binary search
+    int n = 0;
+    if (x <= 0x0000FFFF) {
+        n += 16;
+        x <<= 16;
+    }
+    if (x <= 0x00FFFFFF) {
+        n += 8;
+        x <<= 8;
+    }
+    if (x <= 0x0FFFFFFF) {
+        n += 4;
+        x <<= 4;
+    }
+    if (x <= 0x3FFFFFFF) {
+        n += 2;
+        x <<= 2;
+    }
+    if (x <= 0x7FFFFFFF) {
+        n += 1;
+    }
+    return n;
+#endif
+}
+
+// Bit operations of the IPv4 instance: get_bit(), extract_bits(),
+// net_mask(), low_mask(), count_matching_bits(), is_valid_mask() and
+// is_aligned() on 32-bit addresses
+#define RADIX_BITS_NAME(x) x
+#define RADIX_KEY unsigned int
+#define RADIX_BITS 32
+#define RADIX_CLZ(x) clz_portable(x)
+#include "radix_bits.h"
+#undef RADIX_BITS_NAME
+#undef RADIX_KEY
+#undef RADIX_BITS
+#undef RADIX_CLZ
+
+/**
+ * @brief Computes the full path of a node, left-aligned.
+ *
+ * @param path  Path bits above the node (only the top @p start bits used)
+ * @param start Depth at which the node's bits begin
+ * @param node  Node
+ * @return Address bits from the root to the end of @p node
+ */
+static inline unsigned int node_path(unsigned int path, int start,
+                                     const radix_node_t *node) {
+    int end = start + node->skip;
+    unsigned int bits = (node->skip == 0) ? 0 : node->prefix << (32 - end);
+    return (path & net_mask(start)) | bits;
+}
+
+
+/**
+ * @brief Covered-address count of a child slot.
+ *
+ * @param node Node (can be NULL)
+ * @return radix_node::covered, or 0 for NULL
+ */
+static inline unsigned int node_covered(const radix_node_t *node) {
+    return (node == NULL) ? 0 : node->covered;
+}
+
+/**
+ * @brief Recomputes radix_node::covered from the node's prefix and children.
+ *
+ * A prefix covers the node's whole range; otherwise the children's counts
+ * add up. Must not be called on the root, whose range does not fit.
+ *
+ * @param node Non-root node whose children are up to date
+ */
+static inline void covered_refresh(radix_node_t *node) {
+    node->covered = node->is_prefix
+                        ? 1u << (32 - node->mask)
+                        : node_covered(node->left) + node_covered(node->right);
+}
+
+/**
+ * @brief Refreshes the counts of a path, deepest node first.
+ *
+ * @param nodes Non-root nodes, each the parent of the next
+ * @param n     Number of nodes
+ */
+static inline void covered_refresh_path(radix_node_t *const *nodes, int n) {
+    while (n > 0) {
+        covered_refresh(nodes[--n]);
+    }
+}
+
+void covered_update(prefix_table_t *table, unsigned int base, int len);
+void covered_rebuild(prefix_table_t *table);
+
+/**
+ * @struct lookup_profile
+ * @brief Ring of addresses sampled from check() calls on one table.
+ */
+struct lookup_profile {
+    unsigned int period; /**< One in this many check() calls is sampled */
+    size_t capacity;     /**< Ring size */
+    size_t taken;        /**< Samples taken since the last reorder */
+    uint32_t *ips;       /**< Sampled addresses */
+};
+
+/** Per-thread check() calls left until the next sample */
+extern __thread unsigned int profile_countdown;
+
+void profile_record(struct lookup_profile *profile, unsigned int ip);
+
+/**
+ * @brief Samples a check() address if profiling is on.
+ *
+ * Costs one predictable branch when @p profile is NULL. The countdown is
+ * per thread (not per table), so concurrent lookups do not contend.
+ *
+ * @param profile Profile of the table, or NULL
+ * @param ip      Looked-up address
+ */
+static inline void profile_sample(struct lookup_profile *profile,
+                                  unsigned int ip) {
+    if (profile != NULL && profile_countdown-- == 0) {
+        profile_record(profile, ip);
+    }
+}
+
+void profile_destroy(struct lookup_profile *profile);
+
+#endif /* PREFIX_MGMT_INTERNAL_H */
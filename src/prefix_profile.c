@@ -0,0 +1,315 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @file prefix_profile.c
+ * @brief Lookup sampling and profile-guided node reordering.
+ *
+ * check() only stores sampled addresses. All counting happens in
+ * prefix_table_reorder(), which replays the samples: the tree is first
+ * laid out depth-first, so a node's visit counter is simply indexed by
+ * its position in the buffer, and then copied a second time, sorted by
+ * visit count.
+ */
+
+/** Cache line size assumed by the report */
+#define PROFILE_LINE 64
+
+/** Page size assumed by the report */
+#define PROFILE_PAGE 4096
+
+/** Most nodes one lookup can touch: the root plus one per address bit */
+#define PROFILE_PATH 33
+
+__thread unsigned int profile_countdown = 0;
+
+/**
+ * @brief Visit count of one node of the depth-first buffer.
+ */
+typedef struct {
+    uint64_t visits; /**< Sampled lookups touching the node */
+    size_t index;    /**< Position in the depth-first buffer */
+} node_heat_t;
+
+/**
+ * @brief Stores one sampled address and restarts the thread's countdown.
+ *
+ * @param profile Profile of the table
+ * @param ip      Looked-up address
+ */
+void profile_record(struct lookup_profile *profile, unsigned int ip) {
+    profile_countdown = profile->period - 1;
+    size_t i = __atomic_fetch_add(&profile->taken, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&profile->ips[i % profile->capacity], ip,
+                     __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Frees a profile.
+ *
+ * @param profile Profile to free (can be NULL)
+ */
+void profile_destroy(struct lookup_profile *profile) {
+    if (profile != NULL) {
+        free(profile->ips);
+        free(profile);
+    }
+}
+
+/**
+ * @brief Walks the tree like check() and lists the nodes it reads.
+ *
+ * @param root  Tree root
+ * @param ip    Address to look up
+ * @param path  Receives up to #PROFILE_PATH nodes
+ * @param match Receives the longest matching mask, or -1
+ * @return Number of nodes in @p path
+ */
+static int walk(const radix_node_t *root, unsigned int ip,
+                const radix_node_t **path, int *match) {
+    const radix_node_t *current = root;
+    int n = 0;
+    path[n++] = root;
+    *match = root->is_prefix ? root->mask : -1;
+
+    int bit_pos = 0;
+    while (bit_pos < 32) {
+        const radix_node_t *child =
+            (get_bit(ip, bit_pos) == 0) ? current->left : current->right;
+        if (child == NULL) {
+            break;
+        }
+        path[n++] = child;
+        if (extract_bits(ip, bit_pos, child->skip) != child->prefix) {
+            break;
+        }
+        bit_pos += child->skip;
+        current = child;
+        if (current->is_prefix) {
+            *match = current->mask;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Counts the distinct blocks of a given size holding a path.
+ *
+ * @param path  Nodes
+ * @param n     Number of nodes
+ * @param block Block size (power of two)
+ * @return Number of distinct blocks
+ */
+static int count_blocks(const radix_node_t **path, int n, uintptr_t block) {
+    uintptr_t seen[2 * PROFILE_PATH];
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        uintptr_t first = (uintptr_t)path[i] / block;
+        uintptr_t last = ((uintptr_t)(path[i] + 1) - 1) / block;
+        for (uintptr_t b = first; b <= last; b++) {
+            int j = 0;
+            while (j < count && seen[j] != b) {
+                j++;
+            }
+            if (j == count) {
+                seen[count++] = b;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Measures how the sampled lookups touch the current layout.
+ *
+ * @param table Table
+ * @param ips   Sampled addresses
+ * @param n     Number of samples (> 0)
+ * @param lines Mean distinct cache lines per lookup
+ * @param pages Mean distinct pages per lookup
+ * @param ns    Mean walk time per lookup
+ */
+static void measure(const prefix_table_t *table, const uint32_t *ips,
+                    size_t n, double *lines, double *pages, double *ns) {
+    const radix_node_t *path[PROFILE_PATH];
+    int match;
+    size_t total_lines = 0;
+    size_t total_pages = 0;
+    for (size_t i = 0; i < n; i++) {
+        int len = walk(table->root, ips[i], path, &match);
+        total_lines += (size_t)count_blocks(path, len, PROFILE_LINE);
+        total_pages += (size_t)count_blocks(path, len, PROFILE_PAGE);
+    }
+
+    // Timed separately so the block counting does not disturb the caches
+    volatile int sink = 0;
+    uint64_t t0 = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        walk(table->root, ips[i], path, &match);
+        sink += match;
+    }
+    uint64_t elapsed = now_ns() - t0;
+    (void)sink;
+
+    *lines = (double)total_lines / (double)n;
+    *pages = (double)total_pages / (double)n;
+    *ns = (double)elapsed / (double)n;
+}
+
+/**
+ * @brief Orders nodes by decreasing visit count, then depth-first.
+ */
+static int heat_compare(const void *a, const void *b) {
+    const node_heat_t *x = (const node_heat_t *)a;
+    const node_heat_t *y = (const node_heat_t *)b;
+    if (x->visits != y->visits) {
+        return (x->visits > y->visits) ? -1 : 1;
+    }
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+int prefix_table_profile_start(prefix_table_t *table, unsigned int period,
+                               size_t samples) {
+    if (table == NULL || period == 0 || samples == 0) {
+        return -1;
+    }
+
+    struct lookup_profile *profile =
+        (struct lookup_profile *)calloc(1, sizeof(*profile));
+    if (profile == NULL) {
+        return -1;
+    }
+    profile->ips = (uint32_t *)malloc(samples * sizeof(uint32_t));
+    if (profile->ips == NULL) {
+        free(profile);
+        return -1;
+    }
+    profile->period = period;
+    profile->capacity = samples;
+
+    profile_destroy(table->profile);
+    table->profile = profile;
+    return 0;
+}
+
+int prefix_table_profile_stop(prefix_table_t *table) {
+    if (table == NULL) {
+        return -1;
+    }
+    profile_destroy(table->profile);
+    table->profile = NULL;
+    return 0;
+}
+
+int prefix_table_reorder(prefix_table_t *table,
+                         prefix_reorder_report_t *report) {
+    if (table == NULL || table->profile == NULL) {
+        return -1;
+    }
+
+    struct lookup_profile *profile = table->profile;
+    prefix_reorder_report_t r;
+    memset(&r, 0, sizeof(r));
+    r.samples = (profile->taken < profile->capacity) ? profile->taken
+                                                     : profile->capacity;
+
+    size_t n = table->nodes;
+    node_heat_t *heat = (node_heat_t *)malloc(n * sizeof(node_heat_t));
+    radix_node_t **order = (radix_node_t **)malloc(n * sizeof(*order));
+    if (heat == NULL || order == NULL) {
+        free(heat);
+        free(order);
+        return -1;
+    }
+    if (r.samples > 0) {
+        measure(table, profile->ips, r.samples, &r.lines_before,
+                &r.pages_before, &r.ns_before);
+    }
+    if (prefix_table_relayout(table, PREFIX_LAYOUT_DFS) != 0) {
+        free(heat);
+        free(order);
+        return -1;
+    }
+
+    // After the depth-first relayout every node sits in the buffer
+    radix_node_t *base = (radix_node_t *)table->layout.base;
+    for (size_t i = 0; i < n; i++) {
+        heat[i].visits = 0;
+        heat[i].index = i;
+    }
+    const radix_node_t *path[PROFILE_PATH];
+    int match;
+    uint64_t total = 0;
+    for (size_t s = 0; s < r.samples; s++) {
+        int len = walk(table->root, profile->ips[s], path, &match);
+        for (int i = 0; i < len; i++) {
+            heat[path[i] - base].visits++;
+        }
+        total += (uint64_t)len;
+    }
+
+    // Parents are visited at least as often as their children and come
+    // earlier depth-first, so the root stays first
+    qsort(heat, n, sizeof(node_heat_t), heat_compare);
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n && heat[i].visits > 0; i++) {
+        sum += heat[i].visits;
+        r.visited_nodes++;
+        if (r.hot_nodes_50 == 0 && sum * 100 >= total * 50) {
+            r.hot_nodes_50 = i + 1;
+        }
+        if (r.hot_nodes_90 == 0 && sum * 100 >= total * 90) {
+            r.hot_nodes_90 = i + 1;
+        }
+        if (r.hot_nodes_99 == 0 && sum * 100 >= total * 99) {
+            r.hot_nodes_99 = i + 1;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        order[i] = &base[heat[i].index];
+    }
+    int ret = relayout_nodes(table, order);
+    free(heat);
+    free(order);
+    if (ret != 0) {
+        return -1;
+    }
+
+    if (r.samples > 0) {
+        measure(table, profile->ips, r.samples, &r.lines_after,
+                &r.pages_after, &r.ns_after);
+    }
+    profile->taken = 0;
+    if (report != NULL) {
+        *report = r;
+    }
+    return 0;
+}
+
+int prefix_mgmt_profile_start(unsigned int period, size_t samples) {
+    return prefix_table_profile_start(prefix_mgmt_table(), period, samples);
+}
+
+int prefix_mgmt_profile_stop(void) {
+    return prefix_table_profile_stop(prefix_mgmt_table());
+}
+
+int prefix_mgmt_reorder(prefix_reorder_report_t *report) {
+    return prefix_table_reorder(prefix_mgmt_table(), report);
+}
@@ -0,0 +1,304 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file prefix_query.c
+ * @brief Queries relating stored prefixes to a given prefix or address.
+ */
+
+int prefix_table_find_covered(const prefix_table_t *table, unsigned int base,
+                              char mask, prefix_cb cb, void *ctx) {
+    prefix_iter_t it;
+    if (table == NULL || prefix_iter_seek(&it, table, base, mask) != 0) {
+        return -1;
+    }
+    if (it.top == 0) {
+        return 0;
+    }
+
+    // The seek stops at the first node at or after the query prefix; it is
+    // the subtree root only if its path starts with the query prefix.
+    prefix_iter_frame_t *f = &it.stack[it.top - 1];
+    if (f->end < mask || ((f->path ^ base) & net_mask(mask)) != 0) {
+        return 0;
+    }
+
+    // Walk only that subtree
+    it.stack[0] = *f;
+    it.top = 1;
+
+    int found = 0;
+    unsigned int b;
+    char m;
+    while (prefix_iter_next(&it, &b, &m)) {
+        if (cb != NULL) {
+            cb(b, m, ctx);
+        }
+        found++;
+    }
+    return found;
+}
+
+int prefix_table_find_covering(const prefix_table_t *table,
+                               unsigned int base, char mask, prefix_cb cb,
+                               void *ctx) {
+    if (table == NULL || !is_valid_mask(mask) || !is_aligned(base, mask)) {
+        return -1;
+    }
+
+    const radix_node_t *current = table->root;
+    int found = 0;
+    int bit_pos = 0;
+
+    for (;;) {
+        if (current->is_prefix) {
+            if (cb != NULL) {
+                cb(base & net_mask(bit_pos), current->mask, ctx);
+            }
+            found++;
+        }
+        if (bit_pos >= mask) {
+            break;
+        }
+
+        int bit = get_bit(base, bit_pos);
+        const radix_node_t *child =
+            (bit == 0) ? current->left : current->right;
+
+        // Child must end within the query prefix and match its bits
+        if (child == NULL || bit_pos + child->skip > mask ||
+            extract_bits(base, bit_pos, child->skip) != child->prefix) {
+            break;
+        }
+
+        bit_pos += child->skip;
+        current = child;
+    }
+
+    return found;
+}
+
+int prefix_table_check_all(const prefix_table_t *table, unsigned int ip,
+                           char *masks_out, int max) {
+    if (table == NULL || max < 0 || (masks_out == NULL && max > 0)) {
+        return -1;
+    }
+
+    const radix_node_t *current = table->root;
+    int found = 0;
+
+    if (current->is_prefix) {
+        if (found < max) {
+            masks_out[found] = current->mask;
+        }
+        found++;
+    }
+    int bit_pos = 0;
+    while (bit_pos < 32) {
+        int bit = get_bit(ip, bit_pos);
+        const radix_node_t *child =
+            (bit == 0) ? current->left : current->right;
+
+        if (child == NULL) {
+            break;
+        }
+
+        unsigned int ip_bits = extract_bits(ip, bit_pos, child->skip);
+        if (ip_bits != child->prefix) {
+            break;
+        }
+
+        bit_pos += child->skip;
+        current = child;
+
+        if (current->is_prefix) {
+            if (found < max) {
+                masks_out[found] = current->mask;
+            }
+            found++;
+        }
+    }
+
+    return found;
+}
+
+int prefix_table_check_all_batch(const prefix_table_t *table,
+                                 const unsigned int *ips, size_t n,
+                                 char *masks_out, int max, int *counts) {
+    if (table == NULL || max < 0 || counts == NULL ||
+        (n > 0 && ips == NULL) || (max > 0 && masks_out == NULL)) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        counts[i] = prefix_table_check_all(
+            table, ips[i], (max > 0) ? masks_out + i * (size_t)max : NULL,
+            max);
+    }
+    return 0;
+}
+
+/**
+ * @brief State of a range query.
+ */
+typedef struct {
+    unsigned int lo;           /**< First address of the query */
+    unsigned int hi;           /**< Last address of the query */
+    prefix_range_cb cb;        /**< Segment callback, can be NULL */
+    void *ctx;                 /**< User pointer for @c cb */
+    prefix_range_report_t rep; /**< Summary so far */
+    bool open;                 /**< A segment is pending */
+    unsigned int first;        /**< First address of the pending segment */
+    unsigned int last;         /**< Last address of the pending segment */
+    char mask;                 /**< Result of the pending segment */
+} range_ctx_t;
+
+/**
+ * @brief Reports the pending segment.
+ *
+ * @param c Query state
+ */
+static void range_flush(range_ctx_t *c) {
+    if (!c->open) {
+        return;
+    }
+    if (c->mask < 0) {
+        c->rep.covered = false;
+    } else {
+        if (c->rep.min_mask < 0 || c->mask < c->rep.min_mask) {
+            c->rep.min_mask = c->mask;
+        }
+        if (c->mask > c->rep.max_mask) {
+            c->rep.max_mask = c->mask;
+        }
+    }
+    c->rep.segments++;
+    if (c->cb != NULL) {
+        c->cb(c->first, c->last, c->mask, c->ctx);
+    }
+    c->open = false;
+}
+
+/**
+ * @brief Adds addresses with one result, clipped to the query range.
+ *
+ * Calls arrive in address order; adjacent calls with the same result
+ * extend the pending segment.
+ *
+ * @param c     Query state
+ * @param first First address
+ * @param last  Last address (inclusive)
+ * @param mask  Result for these addresses
+ */
+static void range_emit(range_ctx_t *c, unsigned int first, unsigned int last,
+                       char mask) {
+    if (last < c->lo || first > c->hi) {
+        return;
+    }
+    first = (first < c->lo) ? c->lo : first;
+    last = (last > c->hi) ? c->hi : last;
+    if (c->open && c->mask == mask && c->last + 1 == first) {
+        c->last = last;
+        return;
+    }
+    range_flush(c);
+    c->open = true;
+    c->first = first;
+    c->last = last;
+    c->mask = mask;
+}
+
+/**
+ * @brief Reports the results of every address below a node.
+ *
+ * @param c    Query state
+ * @param node Node
+ * @param path Address bits up to the end of @p node
+ * @param end  Depth at which the bits of @p node end
+ * @param best Longest match above @p node, or -1
+ */
+static void range_walk(range_ctx_t *c, const radix_node_t *node,
+                       unsigned int path, int end, char best) {
+    if (node->is_prefix) {
+        best = node->mask;
+    }
+    unsigned int first = path & net_mask(end);
+    if (end == 32) {
+        range_emit(c, first, first, best);
+        return;
+    }
+
+    const radix_node_t *children[2] = {node->left, node->right};
+    for (int dir = 0; dir < 2; dir++) {
+        // Addresses whose bit 'end' is dir
+        unsigned int half = first | ((unsigned int)dir << (31 - end));
+        unsigned int half_last = half | ~net_mask(end + 1);
+        const radix_node_t *child = children[dir];
+        if (half > c->hi || half_last < c->lo) {
+            continue;
+        }
+        if (child == NULL) {
+            range_emit(c, half, half_last, best);
+            continue;
+        }
+
+        // Around the child's range the node's result applies
+        int child_end = end + child->skip;
+        unsigned int child_path = node_path(path, end, child);
+        unsigned int child_first = child_path & net_mask(child_end);
+        unsigned int child_last = child_first | ~net_mask(child_end);
+        if (child_first > half) {
+            range_emit(c, half, child_first - 1, best);
+        }
+        if (child_first <= c->hi && child_last >= c->lo) {
+            range_walk(c, child, child_path, child_end, best);
+        }
+        if (child_last < half_last) {
+            range_emit(c, child_last + 1, half_last, best);
+        }
+    }
+}
+
+int prefix_table_check_range(const prefix_table_t *table, unsigned int lo,
+                             unsigned int hi, prefix_range_report_t *out,
+                             prefix_range_cb cb, void *ctx) {
+    if (table == NULL || lo > hi) {
+        return -1;
+    }
+
+    range_ctx_t c = {lo, hi, cb, ctx, {true, -1, -1, 0}, false, 0, 0, -1};
+    range_walk(&c, table->root, 0, 0, -1);
+    range_flush(&c);
+    if (out != NULL) {
+        *out = c.rep;
+    }
+    return 0;
+}
+
+int find_covered(unsigned int base, char mask, prefix_cb cb, void *ctx) {
+    return prefix_table_find_covered(prefix_mgmt_table(), base, mask, cb,
+                                     ctx);
+}
+
+int find_covering(unsigned int base, char mask, prefix_cb cb, void *ctx) {
+    return prefix_table_find_covering(prefix_mgmt_table(), base, mask, cb,
+                                      ctx);
+}
+
+int check_all(unsigned int ip, char *masks_out, int max) {
+    return prefix_table_check_all(prefix_mgmt_table(), ip, masks_out, max);
+}
+
+int check_all_batch(const unsigned int *ips, size_t n, char *masks_out,
+                    int max, int *counts) {
+    return prefix_table_check_all_batch(prefix_mgmt_table(), ips, n,
+                                        masks_out, max, counts);
+}
+
+int check_range(unsigned int lo, unsigned int hi, prefix_range_report_t *out,
+                prefix_range_cb cb, void *ctx) {
+    return prefix_table_check_range(prefix_mgmt_table(), lo, hi, out, cb,
+                                    ctx);
+}
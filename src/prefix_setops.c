@@ -0,0 +1,326 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file prefix_setops.c
+ * @brief Union, intersection and difference of two tables.
+ *
+ * The two trees are walked in lockstep. A "view" is the part of a node
+ * below the current depth: path compression means one node of @c a can
+ * face several shorter nodes of @c b, so a node is cut into pieces as the
+ * walk goes down. Each step creates one output node covering the bits both
+ * views agree on. Where one side is empty the other is copied as a whole.
+ *
+ * Output nodes are normalized bottom-up (see finish()), so the result
+ * never has dead nodes, whatever the inputs had.
+ */
+
+/**
+ * @brief Part of a node below the current depth.
+ */
+typedef struct {
+    const radix_node_t *node; /**< Node, NULL for an empty subtree */
+    int cut;                  /**< Leading bits of the node already walked */
+} set_view_t;
+
+/**
+ * @brief State shared by one combine.
+ */
+typedef struct {
+    prefix_table_t *out;    /**< Table receiving the result */
+    prefix_set_op_t op;     /**< Set operation */
+    prefix_set_mode_t mode; /**< Set elements */
+    int error;              /**< Set if a node allocation failed */
+} setop_ctx_t;
+
+static const set_view_t empty_view = {NULL, 0};
+
+/**
+ * @brief Applies the set operation to membership in @c a and @c b.
+ */
+static bool set_op(const setop_ctx_t *c, bool in_a, bool in_b) {
+    switch (c->op) {
+    case PREFIX_SET_UNION:
+        return in_a || in_b;
+    case PREFIX_SET_INTERSECT:
+        return in_a && in_b;
+    default:
+        return in_a && !in_b;
+    }
+}
+
+/** Bits of the view not walked yet */
+static inline int view_len(set_view_t v) { return v.node->skip - v.cut; }
+
+/**
+ * @brief Returns the first @p n bits of the view, right-aligned.
+ */
+static inline uint64_t view_bits(set_view_t v, int n) {
+    int len = view_len(v);
+    uint64_t label = v.node->prefix & ((1ULL << len) - 1);
+    return label >> (len - n);
+}
+
+/**
+ * @brief Returns the view of a child after walking @p len bits.
+ *
+ * @param v   View (can be empty)
+ * @param len Bits walked, at most view_len()
+ * @param dir 0 for the left half, 1 for the right one
+ * @return What remains of @p v in that half
+ */
+static set_view_t view_child(set_view_t v, int len, int dir) {
+    if (v.node == NULL) {
+        return empty_view;
+    }
+    if (len == view_len(v)) {
+        set_view_t child = {(dir == 0) ? v.node->left : v.node->right, 0};
+        return child;
+    }
+    if ((int)(view_bits(v, len + 1) & 1) != dir) {
+        return empty_view;
+    }
+    set_view_t rest = {v.node, v.cut + len};
+    return rest;
+}
+
+/**
+ * @brief Creates an output node.
+ *
+ * @param c     Combine state
+ * @param skip  Number of path bits
+ * @param label Path bits, right-aligned
+ * @return New node, or NULL (error set) if allocation fails
+ */
+static radix_node_t *emit_node(setop_ctx_t *c, int skip, uint64_t label) {
+    radix_node_t *node = create_node(c->out);
+    if (node == NULL) {
+        c->error = 1;
+        return NULL;
+    }
+    node->skip = (unsigned char)skip;
+    node->prefix = (unsigned int)label;
+    return node;
+}
+
+/**
+ * @brief Creates a prefix leaf covering one half below depth @p start.
+ */
+static radix_node_t *emit_half(setop_ctx_t *c, int start, int dir) {
+    radix_node_t *node = emit_node(c, 1, (uint64_t)dir);
+    if (node != NULL) {
+        set_prefix(c->out, node, (char)(start + 1));
+    }
+    return node;
+}
+
+/**
+ * @brief Tells whether a node is a prefix leaf one bit long.
+ */
+static inline bool is_half(const radix_node_t *node) {
+    return node != NULL && node->is_prefix && node->skip == 1 &&
+           node->left == NULL && node->right == NULL;
+}
+
+/**
+ * @brief Normalizes a node whose children are done.
+ *
+ * Children without prefix and with fewer than two children are removed
+ * or merged into their own child. In #PREFIX_SET_ADDRESSES mode two
+ * halves that are both covered become a prefix on the node itself.
+ *
+ * @param c    Combine state
+ * @param node Node (the caller normalizes the node itself)
+ * @param end  Depth at which @p node's bits end
+ */
+static void finish(setop_ctx_t *c, radix_node_t *node, int end) {
+    for (int dir = 0; dir < 2; dir++) {
+        radix_node_t *child = (dir == 0) ? node->left : node->right;
+        if (child != NULL && !child->is_prefix &&
+            (child->left == NULL || child->right == NULL)) {
+            cleanup_node(c->out, node, child, dir);
+        }
+    }
+    if (c->mode == PREFIX_SET_ADDRESSES && is_half(node->left) &&
+        is_half(node->right)) {
+        clear_prefix(c->out, node->left);
+        clear_prefix(c->out, node->right);
+        release_node(c->out, node->left);
+        release_node(c->out, node->right);
+        node->left = NULL;
+        node->right = NULL;
+        set_prefix(c->out, node, (char)end);
+    }
+}
+
+/**
+ * @brief Copies a view and everything below it.
+ *
+ * In #PREFIX_SET_ADDRESSES mode prefixes below another prefix are left
+ * out, they match no additional address.
+ *
+ * @param c     Combine state
+ * @param v     View to copy (not empty)
+ * @param start Depth at which the view begins
+ * @return Copy, or NULL if nothing remains or allocation failed
+ */
+static radix_node_t *copy_view(setop_ctx_t *c, set_view_t v, int start) {
+    int len = view_len(v);
+    radix_node_t *node = emit_node(c, len, view_bits(v, len));
+    if (node == NULL) {
+        return NULL;
+    }
+    int end = start + len;
+    if (v.node->is_prefix) {
+        set_prefix(c->out, node, (char)end);
+        if (c->mode == PREFIX_SET_ADDRESSES) {
+            return node;
+        }
+    }
+    if (v.node->left != NULL) {
+        set_view_t left = {v.node->left, 0};
+        node->left = copy_view(c, left, end);
+    }
+    if (v.node->right != NULL) {
+        set_view_t right = {v.node->right, 0};
+        node->right = copy_view(c, right, end);
+    }
+    finish(c, node, end);
+    return node;
+}
+
+/**
+ * @brief Combines two views starting at the same depth in the same half.
+ *
+ * In #PREFIX_SET_ADDRESSES mode @p in_a and @p in_b tell whether a prefix
+ * above already covers the whole half in @c a or @c b; the view on that
+ * side then no longer matters.
+ *
+ * @param c     Combine state
+ * @param va    View of @c a (can be empty)
+ * @param vb    View of @c b (can be empty)
+ * @param in_a  Half covered in @c a
+ * @param in_b  Half covered in @c b
+ * @param start Depth at which the views begin
+ * @param dir   First bit of the half
+ * @return Result for the half, or NULL if empty or allocation failed
+ */
+static radix_node_t *combine(setop_ctx_t *c, set_view_t va, set_view_t vb,
+                             bool in_a, bool in_b, int start, int dir) {
+    if (c->mode == PREFIX_SET_ADDRESSES) {
+        if (in_a) {
+            va = empty_view;
+        }
+        if (in_b) {
+            vb = empty_view;
+        }
+        if (va.node == NULL || vb.node == NULL) {
+            // Result is op(constant, tree): the half, nothing, the tree
+            // or its complement
+            bool if_in = set_op(c, va.node != NULL || in_a,
+                                vb.node != NULL || in_b);
+            bool if_out = set_op(c, in_a, in_b);
+            if (va.node == NULL && vb.node == NULL) {
+                return if_out ? emit_half(c, start, dir) : NULL;
+            }
+            if (if_in && if_out) {
+                return emit_half(c, start, dir);
+            }
+            if (!if_in && !if_out) {
+                return NULL;
+            }
+            if (if_in) {
+                return copy_view(c, (va.node != NULL) ? va : vb, start);
+            }
+            // Complement: walked below one bit at a time
+        }
+    } else {
+        if (va.node == NULL && vb.node == NULL) {
+            return NULL;
+        }
+        if (vb.node == NULL) {
+            return set_op(c, true, false) ? copy_view(c, va, start) : NULL;
+        }
+        if (va.node == NULL) {
+            return set_op(c, false, true) ? copy_view(c, vb, start) : NULL;
+        }
+    }
+
+    // Bits both views share
+    int len = 1;
+    set_view_t v = (va.node != NULL) ? va : vb;
+    if (va.node != NULL && vb.node != NULL) {
+        int m = (view_len(va) < view_len(vb)) ? view_len(va) : view_len(vb);
+        uint64_t diff = view_bits(va, m) ^ view_bits(vb, m);
+        len = (diff == 0) ? m : m - (64 - __builtin_clzll(diff));
+    }
+
+    radix_node_t *node = emit_node(c, len, view_bits(v, len));
+    if (node == NULL) {
+        return NULL;
+    }
+    int end = start + len;
+    bool here_a = va.node != NULL && len == view_len(va) && va.node->is_prefix;
+    bool here_b = vb.node != NULL && len == view_len(vb) && vb.node->is_prefix;
+    if (c->mode == PREFIX_SET_PREFIXES && set_op(c, here_a, here_b)) {
+        set_prefix(c->out, node, (char)end);
+    }
+
+    in_a = in_a || here_a;
+    in_b = in_b || here_b;
+    node->left = combine(c, view_child(va, len, 0), view_child(vb, len, 0),
+                         in_a, in_b, end, 0);
+    node->right = combine(c, view_child(va, len, 1), view_child(vb, len, 1),
+                          in_a, in_b, end, 1);
+    finish(c, node, end);
+    return node;
+}
+
+int prefix_table_combine(const prefix_table_t *a, const prefix_table_t *b,
+                         prefix_table_t *dst, prefix_set_op_t op,
+                         prefix_set_mode_t mode) {
+    if (a == NULL || b == NULL || dst == NULL ||
+        (op != PREFIX_SET_UNION && op != PREFIX_SET_INTERSECT &&
+         op != PREFIX_SET_DIFF) ||
+        (mode != PREFIX_SET_PREFIXES && mode != PREFIX_SET_ADDRESSES)) {
+        return -1;
+    }
+
+    prefix_table_t *out = table_create_like(dst);
+    if (out == NULL) {
+        return -1;
+    }
+
+    // The roots have no bits and always exist, so they are combined here
+    setop_ctx_t c = {out, op, mode, 0};
+    const radix_node_t *ra = a->root;
+    const radix_node_t *rb = b->root;
+    if (mode == PREFIX_SET_PREFIXES &&
+        set_op(&c, ra->is_prefix, rb->is_prefix)) {
+        set_prefix(out, out->root, 0);
+    }
+    set_view_t la = {ra->left, 0};
+    set_view_t lb = {rb->left, 0};
+    set_view_t ra_right = {ra->right, 0};
+    set_view_t rb_right = {rb->right, 0};
+    out->root->left =
+        combine(&c, la, lb, ra->is_prefix, rb->is_prefix, 0, 0);
+    out->root->right =
+        combine(&c, ra_right, rb_right, ra->is_prefix, rb->is_prefix, 0, 1);
+    finish(&c, out->root, 0);
+
+    if (c.error) {
+        prefix_table_destroy(out);
+        return -1;
+    }
+    covered_rebuild(out);
+    host_set_rebuild(out);
+    stride_update(out, 0, 0);
+
+    table_swap(dst, out);
+    prefix_table_destroy(out);
+    return 0;
+}
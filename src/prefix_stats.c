@@ -0,0 +1,82 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @file prefix_stats.c
+ * @brief Size and shape statistics of a table.
+ */
+
+/**
+ * @brief Accumulates the depth of every prefix in a subtree.
+ *
+ * @param node  Subtree root (can be NULL)
+ * @param depth Depth of @p node
+ * @param out   Statistics being filled
+ * @param total Incremented by the depth of every prefix
+ */
+static void depth_walk(const radix_node_t *node, int depth,
+                       prefix_stats_t *out, size_t *total) {
+    if (node == NULL) {
+        return;
+    }
+    if (node->is_prefix) {
+        out->depth_count[depth]++;
+        *total += (size_t)depth;
+        if (depth > out->max_depth) {
+            out->max_depth = depth;
+        }
+    }
+    depth_walk(node->left, depth + 1, out, total);
+    depth_walk(node->right, depth + 1, out, total);
+}
+
+int prefix_table_stats(const prefix_table_t *table, prefix_stats_t *out,
+                       unsigned int flags) {
+    if (table == NULL || out == NULL) {
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->prefixes = table->prefixes;
+    out->nodes = table->nodes;
+    out->branch_nodes = table->nodes - table->prefixes;
+    out->dead_nodes = table->dead_nodes;
+    memcpy(out->mask_count, table->mask_count, sizeof(out->mask_count));
+
+    // Arena chunks and the relayout buffer count in full, used or not
+    out->node_bytes =
+        table->layout.size +
+        ((table->arena != NULL)
+             ? table->arena->mapped
+             : (table->nodes - table->layout.used) * sizeof(radix_node_t));
+    out->bytes = sizeof(*table) + out->node_bytes;
+    if (table->arena != NULL) {
+        out->bytes += sizeof(*table->arena);
+    }
+    out->bytes += host_set_bytes(table->hosts);
+    if (table->stride != NULL) {
+        out->bytes += sizeof(*table->stride);
+    }
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    out->bytes += hits_bytes(table->hits);
+#endif
+#ifdef PREFIX_MGMT_INSTRUMENT
+    out->bytes += instr_bytes(table->instr);
+#endif
+
+    out->max_depth = -1;
+    if (flags & PREFIX_STATS_DEPTH) {
+        size_t total = 0;
+        depth_walk(table->root, 0, out, &total);
+        if (table->prefixes > 0) {
+            out->avg_depth = (double)total / (double)table->prefixes;
+        }
+    }
+    return 0;
+}
+
+int prefix_mgmt_stats(prefix_stats_t *out, unsigned int flags) {
+    return prefix_table_stats(prefix_mgmt_table(), out, flags);
+}
@@ -0,0 +1,86 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdlib.h>
+
+/**
+ * @file prefix_stride.c
+ * @brief Direct index of the first 16 address bits.
+ *
+ * Entries are recomputed from the tree for the /16 range below every
+ * change that reaches into the first 16 bits (see stride_update()), and
+ * entirely after operations that move or rebuild all nodes.
+ */
+
+struct stride_index *stride_create(void) {
+    return (struct stride_index *)malloc(sizeof(struct stride_index));
+}
+
+void stride_destroy(struct stride_index *stride) {
+    free(stride);
+}
+
+/**
+ * @brief Writes the entries of a node and of the nodes below it.
+ *
+ * Every entry in [lo, hi] gets the node's state; children whose bits end
+ * within the first #STRIDE_BITS bits then overwrite their own part.
+ *
+ * @param stride Index
+ * @param node   Node, on the path of every entry in [lo, hi]
+ * @param path   Address bits down to the end of @p node
+ * @param depth  Bit where the bits of @p node end
+ * @param best   Longest match down to @p node, or -1
+ * @param lo     First entry to write
+ * @param hi     Last entry to write
+ */
+static void fill(struct stride_index *stride, const radix_node_t *node,
+                 unsigned int path, int depth, char best, unsigned int lo,
+                 unsigned int hi) {
+    struct stride_entry e = {node, (unsigned char)depth, best};
+    for (unsigned int v = lo; v <= hi; v++) {
+        stride->entry[v] = e;
+    }
+
+    const radix_node_t *children[2] = {node->left, node->right};
+    for (int dir = 0; dir < 2; dir++) {
+        const radix_node_t *child = children[dir];
+        if (child == NULL || depth + child->skip > STRIDE_BITS) {
+            continue;
+        }
+        int end = depth + child->skip;
+        unsigned int child_path = node_path(path, depth, child);
+        unsigned int child_lo = child_path >> (32 - STRIDE_BITS);
+        unsigned int child_hi = child_lo + (1u << (STRIDE_BITS - end)) - 1;
+        if (child_lo > hi || child_hi < lo) {
+            continue;
+        }
+        fill(stride, child, child_path, end,
+             child->is_prefix ? child->mask : best,
+             (child_lo > lo) ? child_lo : lo, (child_hi < hi) ? child_hi : hi);
+    }
+}
+
+void stride_refresh(prefix_table_t *table, unsigned int base, int len) {
+    unsigned int lo = (base & net_mask(len)) >> (32 - STRIDE_BITS);
+    unsigned int hi = lo + (1u << (STRIDE_BITS - len)) - 1;
+
+    // Go down to the deepest node whose bits end within the first len bits
+    const radix_node_t *current = table->root;
+    int depth = 0;
+    char best = current->is_prefix ? current->mask : -1;
+    while (depth < len) {
+        const radix_node_t *child =
+            (get_bit(base, depth) == 0) ? current->left : current->right;
+        if (child == NULL || depth + child->skip > len ||
+            extract_bits(base, depth, child->skip) != child->prefix) {
+            break;
+        }
+        current = child;
+        depth += child->skip;
+        if (current->is_prefix) {
+            best = current->mask;
+        }
+    }
+
+    fill(table->stride, current, base & net_mask(depth), depth, best, lo, hi);
+}
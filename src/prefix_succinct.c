@@ -0,0 +1,321 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt_internal.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @file prefix_succinct.c
+ * @brief Read-only succinct copy of a radix tree.
+ *
+ * Nodes are numbered in level order, root = 0. Each node is described by
+ * a few bits in separate bit vectors:
+ *
+ * - @c topo: two bits per node, "has left child" and "has right child".
+ *   The child behind bit @c b is node rank1(topo, b) + 1 (LOUDS for a
+ *   binary tree), so no pointers are stored.
+ * - @c is_prefix: one bit per node. The mask of a prefix is its depth,
+ *   which the lookup already tracks.
+ * - @c runs: per node a one followed by skip - 1 zeros, then a final one.
+ *   select1(runs, k) finds node k's run; the zeros before it give the
+ *   offset of its label, the run length its skip.
+ * - @c labels: the node's path bits except the first, which is implied
+ *   by the child it hangs on.
+ *
+ * Non-prefix nodes with a single child (left behind by del()) are merged
+ * into the child while copying.
+ */
+
+/** Bits of topo covered by one rank sample */
+#define RANK_BLOCK 256
+
+/** Ones of runs between two select samples */
+#define SELECT_STEP 256
+
+/**
+ * @struct prefix_succinct
+ * @brief Bit vectors and their rank/select directories.
+ */
+struct prefix_succinct {
+    size_t nodes;           /**< Nodes after merging */
+    size_t prefixes;        /**< Stored prefixes */
+    uint64_t *topo;         /**< Child bits, 2 per node */
+    uint32_t *topo_rank;    /**< Ones in topo before each RANK_BLOCK */
+    uint64_t *is_prefix;    /**< Prefix bits, 1 per node */
+    uint64_t *runs;         /**< Unary skips */
+    uint32_t *runs_select;  /**< Position of every SELECT_STEP-th one */
+    uint64_t *labels;       /**< Packed path bits */
+    size_t bytes;           /**< Total allocated size */
+};
+
+/**
+ * @brief A node of the source tree after merging single-child chains.
+ */
+typedef struct {
+    const radix_node_t *left;  /**< Left child in the source tree */
+    const radix_node_t *right; /**< Right child in the source tree */
+    uint64_t label;            /**< Path bits, right-aligned */
+    int skip;                  /**< Number of path bits */
+    bool is_prefix;            /**< Node holds a prefix */
+} succinct_node_t;
+
+/**
+ * @brief Describes a non-root node, absorbing chains of branch nodes
+ * with one child.
+ *
+ * @param node Source node
+ * @return Merged node
+ */
+static succinct_node_t merge_chain(const radix_node_t *node) {
+    succinct_node_t v = {NULL, NULL, node->prefix, node->skip, false};
+    while (!node->is_prefix && (node->left == NULL) != (node->right == NULL)) {
+        node = (node->left != NULL) ? node->left : node->right;
+        v.label = (v.label << node->skip) | node->prefix;
+        v.skip += node->skip;
+    }
+    v.left = node->left;
+    v.right = node->right;
+    v.is_prefix = node->is_prefix;
+    return v;
+}
+
+static inline void bit_set(uint64_t *v, size_t i) {
+    v[i / 64] |= 1ULL << (i % 64);
+}
+
+static inline bool bit_get(const uint64_t *v, size_t i) {
+    return (v[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * @brief Stores @p len bits of @p value at bit offset @p off.
+ */
+static void bits_put(uint64_t *v, size_t off, uint64_t value, int len) {
+    for (int i = 0; i < len; i++) {
+        if ((value >> i) & 1) {
+            bit_set(v, off + (size_t)i);
+        }
+    }
+}
+
+/**
+ * @brief Reads @p len (< 64) bits at bit offset @p off.
+ *
+ * The vector must have a readable word after the last used bit.
+ */
+static inline uint64_t bits_get(const uint64_t *v, size_t off, int len) {
+    size_t w = off / 64;
+    unsigned int b = off % 64;
+    uint64_t x = v[w] >> b;
+    if (b != 0) {
+        x |= v[w + 1] << (64 - b);
+    }
+    return x & ((1ULL << len) - 1);
+}
+
+/**
+ * @brief Counts the ones of topo before position @p pos.
+ */
+static inline size_t topo_rank1(const struct prefix_succinct *s, size_t pos) {
+    size_t r = s->topo_rank[pos / RANK_BLOCK];
+    size_t w = pos / RANK_BLOCK * (RANK_BLOCK / 64);
+    for (; w < pos / 64; w++) {
+        r += (size_t)__builtin_popcountll(s->topo[w]);
+    }
+    if (pos % 64 != 0) {
+        r += (size_t)__builtin_popcountll(s->topo[w] &
+                                          ((1ULL << (pos % 64)) - 1));
+    }
+    return r;
+}
+
+/**
+ * @brief Finds the position of the @p k-th one of runs (from 0).
+ */
+static inline size_t runs_select1(const struct prefix_succinct *s, size_t k) {
+    size_t pos = s->runs_select[k / SELECT_STEP];
+    size_t left = k % SELECT_STEP;
+    size_t w = pos / 64;
+    uint64_t word = s->runs[w] & (~0ULL << (pos % 64));
+    for (;;) {
+        size_t c = (size_t)__builtin_popcountll(word);
+        if (left < c) {
+            break;
+        }
+        left -= c;
+        word = s->runs[++w];
+    }
+    while (left-- > 0) {
+        word &= word - 1;
+    }
+    return w * 64 + (size_t)__builtin_ctzll(word);
+}
+
+/**
+ * @brief Finds the first one of runs after position @p pos.
+ */
+static inline size_t runs_next1(const struct prefix_succinct *s, size_t pos) {
+    pos++;
+    size_t w = pos / 64;
+    uint64_t word = s->runs[w] & (~0ULL << (pos % 64));
+    while (word == 0) {
+        word = s->runs[++w];
+    }
+    return w * 64 + (size_t)__builtin_ctzll(word);
+}
+
+/**
+ * @brief Allocates a zeroed bit vector with one spare word.
+ *
+ * @param bits  Number of bits
+ * @param bytes Incremented by the allocated size
+ * @return Vector, or NULL if out of memory
+ */
+static uint64_t *bits_alloc(size_t bits, size_t *bytes) {
+    size_t words = bits / 64 + 2;
+    *bytes += words * sizeof(uint64_t);
+    return (uint64_t *)calloc(words, sizeof(uint64_t));
+}
+
+prefix_succinct_t *prefix_succinct_build(const prefix_table_t *table) {
+    if (table == NULL) {
+        return NULL;
+    }
+
+    // Level order, one entry per merged node
+    succinct_node_t *queue =
+        (succinct_node_t *)malloc(table->nodes * sizeof(succinct_node_t));
+    prefix_succinct_t *s = (prefix_succinct_t *)calloc(1, sizeof(*s));
+    if (queue == NULL || s == NULL) {
+        free(queue);
+        free(s);
+        return NULL;
+    }
+    const radix_node_t *root = table->root;
+    succinct_node_t first = {root->left, root->right, 0, 0, root->is_prefix};
+    size_t n = 0;
+    queue[n++] = first;
+    size_t label_bits = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (queue[i].left != NULL) {
+            queue[n] = merge_chain(queue[i].left);
+            label_bits += (size_t)queue[n++].skip - 1;
+        }
+        if (queue[i].right != NULL) {
+            queue[n] = merge_chain(queue[i].right);
+            label_bits += (size_t)queue[n++].skip - 1;
+        }
+    }
+
+    size_t run_bits = n + label_bits + 1;
+    size_t topo_words = (2 * n) / 64 + 2;
+    s->nodes = n;
+    s->prefixes = table->prefixes;
+    s->bytes = sizeof(*s);
+    s->topo = bits_alloc(2 * n, &s->bytes);
+    s->is_prefix = bits_alloc(n, &s->bytes);
+    s->runs = bits_alloc(run_bits, &s->bytes);
+    s->labels = bits_alloc(label_bits, &s->bytes);
+    size_t rank_len = topo_words * 64 / RANK_BLOCK + 1;
+    size_t select_len = (n + 1) / SELECT_STEP + 1;
+    s->topo_rank = (uint32_t *)malloc(rank_len * sizeof(uint32_t));
+    s->runs_select = (uint32_t *)malloc(select_len * sizeof(uint32_t));
+    s->bytes += (rank_len + select_len) * sizeof(uint32_t);
+    if (s->topo == NULL || s->is_prefix == NULL || s->runs == NULL ||
+        s->labels == NULL || s->topo_rank == NULL || s->runs_select == NULL) {
+        free(queue);
+        prefix_succinct_destroy(s);
+        return NULL;
+    }
+
+    size_t run = 0;
+    size_t label = 0;
+    for (size_t i = 0; i < n; i++) {
+        const succinct_node_t *v = &queue[i];
+        if (v->left != NULL) {
+            bit_set(s->topo, 2 * i);
+        }
+        if (v->right != NULL) {
+            bit_set(s->topo, 2 * i + 1);
+        }
+        if (v->is_prefix) {
+            bit_set(s->is_prefix, i);
+        }
+        if (i % SELECT_STEP == 0) {
+            s->runs_select[i / SELECT_STEP] = (uint32_t)run;
+        }
+        bit_set(s->runs, run);
+        if (i == 0) {
+            run++;
+            continue;
+        }
+        run += (size_t)v->skip;
+        bits_put(s->labels, label, v->label, v->skip - 1);
+        label += (size_t)v->skip - 1;
+    }
+    if (n % SELECT_STEP == 0) {
+        s->runs_select[n / SELECT_STEP] = (uint32_t)run;
+    }
+    bit_set(s->runs, run);
+    free(queue);
+
+    size_t ones = 0;
+    for (size_t w = 0; w < topo_words; w++) {
+        if (w % (RANK_BLOCK / 64) == 0) {
+            s->topo_rank[w / (RANK_BLOCK / 64)] = (uint32_t)ones;
+        }
+        ones += (size_t)__builtin_popcountll(s->topo[w]);
+    }
+    return s;
+}
+
+void prefix_succinct_destroy(prefix_succinct_t *s) {
+    if (s == NULL) {
+        return;
+    }
+    free(s->topo);
+    free(s->topo_rank);
+    free(s->is_prefix);
+    free(s->runs);
+    free(s->runs_select);
+    free(s->labels);
+    free(s);
+}
+
+char prefix_succinct_check(const prefix_succinct_t *s, unsigned int ip) {
+    if (s == NULL) {
+        return -1;
+    }
+
+    size_t k = 0;
+    int best = bit_get(s->is_prefix, 0) ? 0 : -1;
+    int bit_pos = 0;
+    while (bit_pos < 32) {
+        size_t b = 2 * k + (size_t)get_bit(ip, bit_pos);
+        if (!bit_get(s->topo, b)) {
+            break;
+        }
+        k = topo_rank1(s, b) + 1;
+
+        // Run of node k: one at 'start', skip - 1 zeros after it
+        size_t start = runs_select1(s, k);
+        int len = (int)(runs_next1(s, start) - start) - 1;
+        if (len > 0 && bits_get(s->labels, start - k, len) !=
+                           extract_bits(ip, bit_pos + 1, len)) {
+            break;
+        }
+        bit_pos += len + 1;
+        if (bit_get(s->is_prefix, k)) {
+            best = bit_pos;
+        }
+    }
+    return (char)best;
+}
+
+size_t prefix_succinct_bytes(const prefix_succinct_t *s) {
+    return (s == NULL) ? 0 : s->bytes;
+}
+
+size_t prefix_succinct_prefixes(const prefix_succinct_t *s) {
+    return (s == NULL) ? 0 : s->prefixes;
+}
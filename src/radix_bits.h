@@ -0,0 +1,121 @@
+/**
+ * @file radix_bits.h
+ * @brief Bit operations on keys of one width; instantiated per key type.
+ *
+ * Not part of the public interface. Included once per key width, after
+ * defining:
+ *
+ * - RADIX_BITS_NAME(x): name of the instance's function @c x
+ * - RADIX_KEY: unsigned integer type holding one address
+ * - RADIX_BITS: number of bits in RADIX_KEY
+ * - RADIX_CLZ(x): leading zero bits of a non-zero key
+ *
+ * Bits are numbered from 0, the most significant one. The macros stay
+ * defined for radix_core.h, which removes them.
+ */
+
+/**
+ * @brief Gets a single bit of a key.
+ *
+ * @param key     Key
+ * @param bit_pos Bit position (0 to RADIX_BITS - 1)
+ * @return 0 or 1
+ */
+static inline int RADIX_BITS_NAME(get_bit)(RADIX_KEY key, int bit_pos) {
+    return (int)((key >> (RADIX_BITS - 1 - bit_pos)) & 1);
+}
+
+/**
+ * @brief Returns a value with the low @p len bits set.
+ *
+ * @param len Number of trailing one bits (0 to RADIX_BITS - 1)
+ * @return Mask
+ */
+static inline RADIX_KEY RADIX_BITS_NAME(low_mask)(int len) {
+    return ((RADIX_KEY)1 << len) - 1;
+}
+
+/**
+ * @brief Extracts bits of a key, right-aligned.
+ *
+ * @param key       Key
+ * @param start_bit Starting position
+ * @param num_bits  How many bits to extract
+ * @return Extracted bits
+ */
+static inline RADIX_KEY RADIX_BITS_NAME(extract_bits)(RADIX_KEY key,
+                                                      int start_bit,
+                                                      int num_bits) {
+    if (num_bits == 0)
+        return 0;
+    if (num_bits == RADIX_BITS && start_bit == 0)
+        return key;
+    return (key >> (RADIX_BITS - start_bit - num_bits)) &
+           RADIX_BITS_NAME(low_mask)(num_bits);
+}
+
+/**
+ * @brief Returns a value with the top @p len bits set.
+ *
+ * @param len Number of leading one bits (0 to RADIX_BITS)
+ * @return Network mask
+ */
+static inline RADIX_KEY RADIX_BITS_NAME(net_mask)(int len) {
+    return (len == 0) ? 0 : ~(RADIX_KEY)0 << (RADIX_BITS - len);
+}
+
+/**
+ * @brief Counts how many bits match between two keys.
+ *
+ * Compares bits starting from start_bit and stops at first difference.
+ *
+ * @param key1      First key
+ * @param key2      Second key
+ * @param start_bit Where to start comparing
+ * @param max_bits  Maximum bits to compare
+ * @return Number of matching bits
+ */
+static inline int RADIX_BITS_NAME(count_matching_bits)(RADIX_KEY key1,
+                                                       RADIX_KEY key2,
+                                                       int start_bit,
+                                                       int max_bits) {
+    if (max_bits == 0)
+        return 0;
+
+    RADIX_KEY diff = (key1 ^ key2) << start_bit;
+    if (diff == 0)
+        return max_bits;
+
+    int match = RADIX_CLZ(diff);
+    return (match < max_bits) ? match : max_bits;
+}
+
+/**
+ * @brief Checks if mask length is valid.
+ *
+ * @param mask Mask to check
+ * @return true if mask is 0 to RADIX_BITS, false otherwise
+ */
+static inline bool RADIX_BITS_NAME(is_valid_mask)(int mask) {
+    return mask >= 0 && mask <= RADIX_BITS;
+}
+
+/**
+ * @brief Checks if base address is correctly aligned.
+ *
+ * Base is aligned if all host bits are zero.
+ * Example: 192.168.1.0/24 is aligned, 192.168.1.5/24 is not.
+ *
+ * @param base Base address
+ * @param mask Mask length (0 to RADIX_BITS)
+ * @return true if aligned, false otherwise
+ */
+static inline bool RADIX_BITS_NAME(is_aligned)(RADIX_KEY base, int mask) {
+    if (mask == 0) {
+        return base == 0;
+    }
+    if (mask == RADIX_BITS) {
+        return true;
+    }
+    return (base & RADIX_BITS_NAME(low_mask)(RADIX_BITS - mask)) == 0;
+}
@@ -0,0 +1,384 @@
+/**
+ * @file radix_core.h
+ * @brief Radix tree operations for one key width; instantiated per key
+ * type.
+ *
+ * Not part of the public interface. The IPv4 table (prefix_mgmt.c) and
+ * the IPv6 table (prefix6.c) both include this file, so add, del and the
+ * lookup walk are written once. Everything that depends on the width
+ * comes from radix_bits.h, which must be included first with the same
+ * RADIX_KEY and RADIX_BITS; all RADIX_ macros are removed at the end.
+ *
+ * Required before inclusion:
+ *
+ * - RADIX_NAME(x): name of the instance's function @c x
+ * - RADIX_BITS_NAME(x), RADIX_KEY, RADIX_BITS, RADIX_CLZ(x): see
+ *   radix_bits.h
+ * - RADIX_NODE: node type with the fields of radix_node_t used here
+ *   (left, right, prefix, skip, is_prefix, mask)
+ * - RADIX_TABLE: table type
+ * - RADIX_ROOT(t): root node of a table
+ * - RADIX_CREATE_NODE(t): new empty node, or NULL
+ * - RADIX_RELEASE_NODE(t, n): frees one node
+ * - RADIX_SET_PREFIX(t, n, mask), RADIX_CLEAR_PREFIX(t, n): marks or
+ *   unmarks a node as holding a prefix, updating the table counters
+ *
+ * Optional hooks, no-ops unless defined (the defaults only evaluate their
+ * arguments):
+ *
+ * - RADIX_DEAD_NODE(t, n): 1 if the node counts as dead, else 0
+ * - RADIX_DEAD_UPDATE(t, before, after): dead count of the changed nodes
+ *   went from @c before to @c after
+ * - RADIX_REFRESH(n): node's children changed
+ * - RADIX_REFRESH_PATH(nodes, n): prefixes below the @c n nodes on the
+ *   path changed, deepest last
+ * - RADIX_MERGE(node, child): @c node absorbed @c child
+ * - RADIX_CHANGED(t, base, len): nodes within the first @c len bits of
+ *   @c base changed
+ */
+
+#ifndef RADIX_DEAD_NODE
+#define RADIX_DEAD_NODE(t, n) ((void)(t), (void)(n), (size_t)0)
+#endif
+#ifndef RADIX_DEAD_UPDATE
+#define RADIX_DEAD_UPDATE(t, before, after) ((void)(before), (void)(after))
+#endif
+#ifndef RADIX_REFRESH
+#define RADIX_REFRESH(n) ((void)(n))
+#endif
+#ifndef RADIX_REFRESH_PATH
+#define RADIX_REFRESH_PATH(nodes, n) ((void)(nodes), (void)(n))
+#endif
+#ifndef RADIX_MERGE
+#define RADIX_MERGE(node, child) ((void)0)
+#endif
+#ifndef RADIX_CHANGED
+#define RADIX_CHANGED(t, base, len) ((void)0)
+#endif
+
+/**
+ * @brief Adds a prefix.
+ *
+ * @param table Table to modify
+ * @param base  Base address, aligned to @p mask
+ * @param mask  Mask length (0 to RADIX_BITS)
+ * @param hops  Incremented for every child node inspected
+ * @return 0 on success, -1 if allocation fails
+ */
+static inline int RADIX_NAME(add)(RADIX_TABLE *table, RADIX_KEY base,
+                                  int mask, int *hops) {
+    // Special case: /0 prefix at root
+    if (mask == 0) {
+        RADIX_SET_PREFIX(table, RADIX_ROOT(table), 0);
+        RADIX_CHANGED(table, base, 0);
+        return 0;
+    }
+
+    // Nodes passed on the way down, whose counts change with the prefix
+    RADIX_NODE *above[RADIX_BITS];
+    int n_above = 0;
+
+    RADIX_NODE *current = RADIX_ROOT(table);
+    int bit_pos = 0;
+
+    while (bit_pos < mask) {
+        int remaining = mask - bit_pos;
+
+        // Determine which child to follow
+        int first_bit = RADIX_BITS_NAME(get_bit)(base, bit_pos);
+        RADIX_NODE **child_ptr =
+            (first_bit == 0) ? &current->left : &current->right;
+
+        if (*child_ptr == NULL) {
+            // Create new node with compressed path
+            RADIX_NODE *new_node = RADIX_CREATE_NODE(table);
+            if (new_node == NULL) {
+                return -1;
+            }
+
+            new_node->skip = remaining;
+            new_node->prefix =
+                RADIX_BITS_NAME(extract_bits)(base, bit_pos, remaining);
+            RADIX_SET_PREFIX(table, new_node, mask);
+
+            // A second child turns a dead node back into a branch
+            size_t dead_before = RADIX_DEAD_NODE(table, current);
+            *child_ptr = new_node;
+            RADIX_DEAD_UPDATE(table, dead_before,
+                              RADIX_DEAD_NODE(table, current));
+            RADIX_REFRESH_PATH(above, n_above);
+            RADIX_CHANGED(table, base, mask);
+            return 0;
+        }
+
+        // Node exists - check for path compression match
+        RADIX_NODE *child = *child_ptr;
+        (*hops)++;
+        int match_bits = RADIX_BITS_NAME(count_matching_bits)(
+            base, child->prefix << (RADIX_BITS - bit_pos - child->skip),
+            bit_pos, (remaining < child->skip) ? remaining : child->skip);
+
+        if (match_bits == child->skip && match_bits == remaining) {
+            // Perfect match - mark as prefix
+            if (child->is_prefix && child->mask == mask) {
+                return 0; // Already exists
+            }
+            RADIX_DEAD_UPDATE(table, RADIX_DEAD_NODE(table, child), 0);
+            RADIX_SET_PREFIX(table, child, mask);
+            RADIX_REFRESH_PATH(above, n_above);
+            RADIX_CHANGED(table, base, mask);
+            return 0;
+        }
+
+        if (match_bits == child->skip) {
+            // Full match with child's skip - continue traversal
+            bit_pos += child->skip;
+            current = child;
+            above[n_above++] = child;
+            continue;
+        }
+
+        int new_remaining = remaining - match_bits;
+
+        RADIX_NODE *split = RADIX_CREATE_NODE(table);
+        if (split == NULL) {
+            return -1; // Nothing has changed yet
+        }
+
+        RADIX_NODE *new_branch = NULL;
+        if (new_remaining > 0) {
+            new_branch = RADIX_CREATE_NODE(table);
+            if (new_branch == NULL) {
+                RADIX_RELEASE_NODE(table, split);
+                return -1;
+            }
+        }
+
+        // Split node contains matched portion
+        split->skip = match_bits;
+        split->prefix =
+            RADIX_BITS_NAME(extract_bits)(base, bit_pos, match_bits);
+
+        // Adjust child node
+        int child_remaining = child->skip - match_bits;
+        child->skip = child_remaining;
+        child->prefix &= RADIX_BITS_NAME(low_mask)(child_remaining);
+
+        // Determine where child goes under split
+        if (((child->prefix >> (child_remaining - 1)) & 1) == 0) {
+            split->left = child;
+        } else {
+            split->right = child;
+        }
+
+        // Insert split into tree
+        *child_ptr = split;
+
+        if (new_remaining == 0) {
+            // Our prefix ends at split point
+            RADIX_SET_PREFIX(table, split, mask);
+        } else {
+            // Add the pre-allocated new_branch
+            new_branch->skip = new_remaining;
+            new_branch->prefix = RADIX_BITS_NAME(extract_bits)(
+                base, bit_pos + match_bits, new_remaining);
+            RADIX_SET_PREFIX(table, new_branch, mask);
+
+            if (RADIX_BITS_NAME(get_bit)(base, bit_pos + match_bits) == 0) {
+                split->left = new_branch;
+            } else {
+                split->right = new_branch;
+            }
+        }
+        RADIX_REFRESH(split);
+        RADIX_REFRESH_PATH(above, n_above);
+        RADIX_CHANGED(table, base, bit_pos + match_bits);
+        return 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Removes a node without prefix, or merges it with its only child.
+ *
+ * A node with two children is left unchanged.
+ *
+ * @param table            Table the nodes belong to
+ * @param parent           Parent of @p node
+ * @param node             Node to clean up
+ * @param parent_direction 0 if node is the left child, 1 if right
+ */
+static inline void RADIX_NAME(cleanup_node)(RADIX_TABLE *table,
+                                            RADIX_NODE *parent,
+                                            RADIX_NODE *node,
+                                            int parent_direction) {
+    if (node->left == NULL && node->right == NULL) {
+        // No children - remove node completely
+        if (parent_direction == 0) {
+            parent->left = NULL;
+        } else {
+            parent->right = NULL;
+        }
+        RADIX_RELEASE_NODE(table, node);
+        return;
+    }
+
+    if (node->left == NULL || node->right == NULL) {
+        // One child - this node absorbs it
+        RADIX_NODE *child = (node->left != NULL) ? node->left : node->right;
+
+        node->prefix = (node->prefix << child->skip) | child->prefix;
+        node->skip = node->skip + child->skip;
+        node->left = child->left;
+        node->right = child->right;
+        node->is_prefix = child->is_prefix;
+        node->mask = child->mask;
+        RADIX_MERGE(node, child);
+
+        RADIX_RELEASE_NODE(table, child);
+    }
+}
+
+/**
+ * @brief Removes a prefix.
+ *
+ * The node is removed or merged with its only child; its parent is left
+ * as it is.
+ *
+ * @param table Table to modify
+ * @param base  Base address, aligned to @p mask
+ * @param mask  Mask length (0 to RADIX_BITS)
+ * @param hops  Incremented for every child node inspected
+ * @return 0 (also if the prefix was not stored)
+ */
+static inline int RADIX_NAME(del)(RADIX_TABLE *table, RADIX_KEY base,
+                                  int mask, int *hops) {
+    // Special case: /0 prefix
+    if (mask == 0) {
+        RADIX_CLEAR_PREFIX(table, RADIX_ROOT(table));
+        RADIX_CHANGED(table, base, 0);
+        return 0;
+    }
+
+    // Nodes passed on the way down, whose counts change with the prefix
+    RADIX_NODE *above[RADIX_BITS];
+    int n_above = 0;
+
+    RADIX_NODE *current = RADIX_ROOT(table);
+    int bit_pos = 0;
+
+    while (bit_pos < mask) {
+        int bit = RADIX_BITS_NAME(get_bit)(base, bit_pos);
+        RADIX_NODE *child = (bit == 0) ? current->left : current->right;
+
+        if (child == NULL) {
+            return 0; // Prefix doesn't exist
+        }
+        (*hops)++;
+
+        if (child->skip > mask - bit_pos) {
+            return 0; // Can't reach this prefix
+        }
+        if (RADIX_BITS_NAME(extract_bits)(base, bit_pos, child->skip) !=
+            child->prefix) {
+            return 0; // Path doesn't match
+        }
+
+        bit_pos += child->skip;
+
+        if (bit_pos == mask) {
+            if (!child->is_prefix || child->mask != mask) {
+                return 0; // Prefix wasn't set
+            }
+
+            // Nodes whose dead status can change: the parent, which may
+            // lose a child, the target, and a child merged into it
+            bool leaf = child->left == NULL && child->right == NULL;
+            RADIX_NODE *only = (child->left == NULL)    ? child->right
+                               : (child->right == NULL) ? child->left
+                                                        : NULL;
+            size_t dead_before = RADIX_DEAD_NODE(table, current) +
+                                 RADIX_DEAD_NODE(table, child) +
+                                 RADIX_DEAD_NODE(table, only);
+
+            RADIX_CLEAR_PREFIX(table, child);
+            RADIX_NAME(cleanup_node)(table, current, child, bit);
+
+            size_t dead_after = RADIX_DEAD_NODE(table, current) +
+                                (leaf ? 0 : RADIX_DEAD_NODE(table, child));
+            RADIX_DEAD_UPDATE(table, dead_before, dead_after);
+            if (!leaf) {
+                RADIX_REFRESH(child);
+            }
+            RADIX_REFRESH_PATH(above, n_above);
+            RADIX_CHANGED(table, base, mask);
+            return 0;
+        }
+
+        current = child;
+        above[n_above++] = child;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Walks down from a node and returns the deepest prefix node on
+ * the path of an address.
+ *
+ * @param current Node to start from, reached with @p bit_pos bits
+ * @param bit_pos Depth at which the children of @p current begin
+ * @param ip      Address to look up
+ * @param hops    Incremented for every child node inspected
+ * @return Longest matching prefix node (@p current included), or NULL
+ */
+static inline const RADIX_NODE *RADIX_NAME(walk)(const RADIX_NODE *current,
+                                                 int bit_pos, RADIX_KEY ip,
+                                                 int *hops) {
+    const RADIX_NODE *best_match = current->is_prefix ? current : NULL;
+
+    while (bit_pos < RADIX_BITS) {
+        int bit = RADIX_BITS_NAME(get_bit)(ip, bit_pos);
+        const RADIX_NODE *child = (bit == 0) ? current->left : current->right;
+
+        if (child == NULL) {
+            break;
+        }
+        (*hops)++;
+
+        // Check if the address matches the compressed path
+        if (RADIX_BITS_NAME(extract_bits)(ip, bit_pos, child->skip) !=
+            child->prefix) {
+            break;
+        }
+
+        bit_pos += child->skip;
+        current = child;
+
+        if (current->is_prefix) {
+            best_match = current;
+        }
+    }
+
+    return best_match;
+}
+
+#undef RADIX_NAME
+#undef RADIX_BITS_NAME
+#undef RADIX_KEY
+#undef RADIX_BITS
+#undef RADIX_CLZ
+#undef RADIX_NODE
+#undef RADIX_TABLE
+#undef RADIX_ROOT
+#undef RADIX_CREATE_NODE
+#undef RADIX_RELEASE_NODE
+#undef RADIX_SET_PREFIX
+#undef RADIX_CLEAR_PREFIX
+#undef RADIX_DEAD_NODE
+#undef RADIX_DEAD_UPDATE
+#undef RADIX_REFRESH
+#undef RADIX_REFRESH_PATH
+#undef RADIX_MERGE
+#undef RADIX_CHANGED
@@ -0,0 +1,67 @@
+#ifndef MIRROR_TEST_H
+#define MIRROR_TEST_H
+
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <random>
+#include <utility>
+
+/**
+ * @brief Fixture running every update on a table created with some option
+ * flags and on a plain table next to it.
+ *
+ * Tests of a feature kept on the side of the tree compare the two tables
+ * with their own oracle; rebuilt_tables() runs that oracle on the tables
+ * built by combine(), aggregate() and relayout().
+ */
+class MirrorTest : public ::testing::Test {
+  protected:
+    /** Random prefix (network address and mask) for rebuilt_tables() */
+    using Generator = std::function<std::pair<unsigned int, int>()>;
+    /** Compares a table against the plain table with the same contents */
+    using Verify = std::function<void(const prefix_table_t *expected,
+                                      const prefix_table_t *actual)>;
+
+    /**
+     * @param flags       Flags of the tested table
+     * @param other_flags Flags of the second operand and the results in
+     *                    rebuilt_tables()
+     */
+    explicit MirrorTest(unsigned int flags) : MirrorTest(flags, flags) {}
+    MirrorTest(unsigned int flags, unsigned int other_flags)
+        : flags_(flags), other_flags_(other_flags) {}
+
+    void SetUp() override;
+    void TearDown() override;
+
+    /** Creates an empty table with the given flags */
+    static prefix_table_t *create(unsigned int flags);
+
+    void add_both(unsigned int base, int mask);
+    void del_both(unsigned int base, int mask);
+    void del_covered_both(unsigned int base, int mask);
+
+    /**
+     * @brief Fills the fixture tables and a second pair with @p n prefixes,
+     * then verifies every combine() result, the tables aggregated in place,
+     * relaid out, and updated after the relayout.
+     */
+    void rebuilt_tables(std::mt19937 &rng, int n, const Generator &gen,
+                        const Verify &verify);
+
+    prefix_table_t *table = nullptr;
+    prefix_table_t *plain = nullptr;
+
+  private:
+    unsigned int flags_;
+    unsigned int other_flags_;
+};
+
+/** Network address of @p ip for @p mask bits */
+inline unsigned int net(unsigned int ip, int mask) {
+    return (mask == 0) ? 0 : ip & (~0U << (32 - mask));
+}
+
+#endif /* MIRROR_TEST_H */
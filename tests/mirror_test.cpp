@@ -0,0 +1,85 @@
+#include "mirror_test.h"
+
+void MirrorTest::SetUp() {
+    table = create(flags_);
+    plain = prefix_table_create();
+    ASSERT_NE(nullptr, table);
+    ASSERT_NE(nullptr, plain);
+}
+
+void MirrorTest::TearDown() {
+    prefix_table_destroy(table);
+    prefix_table_destroy(plain);
+}
+
+prefix_table_t *MirrorTest::create(unsigned int flags) {
+    prefix_table_opts_t opts = {};
+    opts.flags = flags;
+    return prefix_table_create_ex(&opts);
+}
+
+void MirrorTest::add_both(unsigned int base, int mask) {
+    ASSERT_EQ(prefix_table_add(plain, base, static_cast<char>(mask)),
+              prefix_table_add(table, base, static_cast<char>(mask)));
+}
+
+void MirrorTest::del_both(unsigned int base, int mask) {
+    ASSERT_EQ(prefix_table_del(plain, base, static_cast<char>(mask)),
+              prefix_table_del(table, base, static_cast<char>(mask)));
+}
+
+void MirrorTest::del_covered_both(unsigned int base, int mask) {
+    ASSERT_EQ(prefix_table_del_covered(plain, base, static_cast<char>(mask)),
+              prefix_table_del_covered(table, base, static_cast<char>(mask)));
+}
+
+void MirrorTest::rebuilt_tables(std::mt19937 &rng, int n, const Generator &gen,
+                                const Verify &verify) {
+    prefix_table_t *other = create(other_flags_);
+    prefix_table_t *other_plain = prefix_table_create();
+    ASSERT_NE(nullptr, other);
+    ASSERT_NE(nullptr, other_plain);
+
+    for (int i = 0; i < n; i++) {
+        std::pair<unsigned int, int> p = gen();
+        if (rng() % 2 == 0) {
+            ASSERT_NO_FATAL_FAILURE(add_both(p.first, p.second));
+        } else {
+            prefix_table_add(other, p.first, static_cast<char>(p.second));
+            prefix_table_add(other_plain, p.first,
+                             static_cast<char>(p.second));
+        }
+    }
+
+    for (prefix_set_op_t op :
+         {PREFIX_SET_UNION, PREFIX_SET_INTERSECT, PREFIX_SET_DIFF}) {
+        for (prefix_set_mode_t mode :
+             {PREFIX_SET_PREFIXES, PREFIX_SET_ADDRESSES}) {
+            prefix_table_t *out = create(other_flags_);
+            prefix_table_t *out_plain = prefix_table_create();
+            ASSERT_EQ(0, prefix_table_combine(table, other, out, op, mode));
+            ASSERT_EQ(0, prefix_table_combine(plain, other_plain, out_plain,
+                                              op, mode));
+            ASSERT_NO_FATAL_FAILURE(verify(out_plain, out));
+            prefix_table_destroy(out);
+            prefix_table_destroy(out_plain);
+        }
+    }
+    prefix_table_destroy(other);
+    prefix_table_destroy(other_plain);
+
+    ASSERT_EQ(0, prefix_table_aggregate(table, table, PREFIX_AGGREGATE_MATCH,
+                                        nullptr));
+    ASSERT_EQ(0, prefix_table_aggregate(plain, plain, PREFIX_AGGREGATE_MATCH,
+                                        nullptr));
+    ASSERT_NO_FATAL_FAILURE(verify(plain, table));
+
+    // Relayout moves every node the features may point to
+    ASSERT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_VEB));
+    ASSERT_NO_FATAL_FAILURE(verify(plain, table));
+    std::pair<unsigned int, int> p = gen();
+    ASSERT_NO_FATAL_FAILURE(add_both(p.first, p.second));
+    ASSERT_NO_FATAL_FAILURE(verify(plain, table));
+    ASSERT_NO_FATAL_FAILURE(del_both(p.first, p.second));
+    ASSERT_NO_FATAL_FAILURE(verify(plain, table));
+}
@@ -0,0 +1,175 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> contents(const prefix_table_t *table) {
+    std::vector<Prefix> out;
+    prefix_iter_t it;
+    unsigned int base;
+    char mask;
+    prefix_iter_init(&it, table);
+    while (prefix_iter_next(&it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+bool contains(const Prefix &outer, const Prefix &inner) {
+    if (outer.second > inner.second) {
+        return false;
+    }
+    unsigned int m = outer.second == 0 ? 0 : ~0U << (32 - outer.second);
+    return (inner.first & m) == outer.first;
+}
+
+} // namespace
+
+class AggregateTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        src = prefix_table_create();
+        dst = prefix_table_create();
+        ASSERT_NE(nullptr, src);
+        ASSERT_NE(nullptr, dst);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(src);
+        prefix_table_destroy(dst);
+    }
+
+    void add_all(const std::vector<Prefix> &prefixes) {
+        for (const Prefix &p : prefixes) {
+            ASSERT_EQ(0, prefix_table_add(src, p.first,
+                                          static_cast<char>(p.second)));
+        }
+    }
+
+    std::vector<Prefix> aggregate(prefix_aggregate_mode_t mode) {
+        EXPECT_EQ(0, prefix_table_aggregate(src, dst, mode, nullptr));
+        return contents(dst);
+    }
+
+    prefix_table_t *src = nullptr;
+    prefix_table_t *dst = nullptr;
+};
+
+// TC-AGG-1: Sibling prefixes
+TEST_F(AggregateTest, SiblingPrefixes) {
+    add_all({{0xC0A80100, 25}, {0xC0A80180, 25}}); // 192.168.1.0/25 x2
+
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80100, 25}, {0xC0A80180, 25}}),
+              aggregate(PREFIX_AGGREGATE_EXACT));
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80100, 24}}),
+              aggregate(PREFIX_AGGREGATE_MATCH));
+}
+
+// TC-AGG-2: Recursive sibling merge
+TEST_F(AggregateTest, RecursiveSiblingMerge) {
+    add_all({{0x0A000000, 26},
+             {0x0A000040, 26},
+             {0x0A000080, 26},
+             {0x0A0000C0, 26},
+             {0x0A000100, 24}});
+
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 23}}),
+              aggregate(PREFIX_AGGREGATE_MATCH));
+}
+
+// TC-AGG-3: Prefix nested in a shorter prefix
+TEST_F(AggregateTest, NestedPrefix) {
+    add_all({{0xC0A80000, 16}, {0xC0A80100, 24}});
+
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80000, 16}, {0xC0A80100, 24}}),
+              aggregate(PREFIX_AGGREGATE_EXACT));
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80000, 16}}),
+              aggregate(PREFIX_AGGREGATE_MATCH));
+}
+
+// TC-AGG-4: Prefix shadowed by longer prefixes
+TEST_F(AggregateTest, ShadowedPrefix) {
+    add_all({{0xC0A80100, 24}, {0xC0A80100, 25}, {0xC0A80180, 25}});
+
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80100, 25}, {0xC0A80180, 25}}),
+              aggregate(PREFIX_AGGREGATE_EXACT));
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80100, 24}}),
+              aggregate(PREFIX_AGGREGATE_MATCH));
+}
+
+// TC-AGG-5: Report and in-place aggregation
+TEST_F(AggregateTest, ReportInPlace) {
+    add_all({{0x00000000, 1}, {0x80000000, 1}, {0x0A000000, 8}});
+
+    prefix_aggregate_report_t report;
+    ASSERT_EQ(0, prefix_table_aggregate(src, src, PREFIX_AGGREGATE_MATCH,
+                                        &report));
+    EXPECT_EQ(3u, report.prefixes_before);
+    EXPECT_EQ(1u, report.prefixes_after);
+    EXPECT_EQ(4u, report.nodes_before);
+    EXPECT_EQ(1u, report.nodes_after);
+
+    EXPECT_EQ((std::vector<Prefix>{{0x00000000, 0}}), contents(src));
+    EXPECT_EQ(0, prefix_table_check(src, 0x0A000001));
+}
+
+// TC-AGG-6: Invalid arguments
+TEST_F(AggregateTest, InvalidArguments) {
+    EXPECT_EQ(-1, prefix_table_aggregate(nullptr, dst, PREFIX_AGGREGATE_EXACT,
+                                         nullptr));
+    EXPECT_EQ(-1, prefix_table_aggregate(src, nullptr, PREFIX_AGGREGATE_EXACT,
+                                         nullptr));
+    EXPECT_EQ(-1, prefix_table_aggregate(
+                      src, dst, static_cast<prefix_aggregate_mode_t>(7),
+                      nullptr));
+}
+
+// TC-AGG-7: Random table - lookups preserved, result minimal
+TEST_F(AggregateTest, RandomTablePreservesLookups) {
+    std::mt19937 rng(28);
+    std::vector<unsigned int> probes;
+
+    for (int i = 0; i < 3000; i++) {
+        int mask = 16 + static_cast<int>(rng() % 17);
+        unsigned int base = (0x0A000000 | (rng() & 0x0003FFFF)) &
+                            (~0U << (32 - mask));
+        prefix_table_add(src, base, static_cast<char>(mask));
+        probes.push_back(base);
+        probes.push_back(base | (mask == 32 ? 0 : (1U << (32 - mask)) - 1));
+    }
+    for (int i = 0; i < 20000; i++) {
+        probes.push_back(0x0A000000 | (rng() & 0x0003FFFF));
+    }
+
+    prefix_table_t *exact = prefix_table_create();
+    ASSERT_EQ(0, prefix_table_aggregate(src, exact, PREFIX_AGGREGATE_EXACT,
+                                        nullptr));
+    ASSERT_EQ(0, prefix_table_aggregate(src, dst, PREFIX_AGGREGATE_MATCH,
+                                        nullptr));
+
+    for (unsigned int ip : probes) {
+        char expected = prefix_table_check(src, ip);
+        ASSERT_EQ(expected, prefix_table_check(exact, ip));
+        ASSERT_EQ(expected >= 0, prefix_table_check(dst, ip) >= 0);
+    }
+    prefix_table_destroy(exact);
+
+    std::vector<Prefix> result = contents(dst);
+    std::set<Prefix> stored(result.begin(), result.end());
+    for (size_t i = 0; i + 1 < result.size(); i++) {
+        EXPECT_FALSE(contains(result[i], result[i + 1]));
+    }
+    for (const Prefix &p : result) {
+        if (p.second > 0) {
+            unsigned int sibling = p.first ^ (1U << (32 - p.second));
+            EXPECT_EQ(0u, stored.count(Prefix(sibling, p.second)));
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> contents(const prefix_table_t *table) {
+    std::vector<Prefix> out;
+    prefix_iter_t it;
+    unsigned int base;
+    char mask;
+    prefix_iter_init(&it, table);
+    while (prefix_iter_next(&it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+prefix_table_opts_t hugepage_opts() {
+    prefix_table_opts_t opts = {};
+    opts.alloc = PREFIX_ALLOC_HUGEPAGE;
+    return opts;
+}
+
+} // namespace
+
+class AllocTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        prefix_table_opts_t opts = hugepage_opts();
+        arena = prefix_table_create_ex(&opts);
+        heap = prefix_table_create();
+        ASSERT_NE(nullptr, arena);
+        ASSERT_NE(nullptr, heap);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(arena);
+        prefix_table_destroy(heap);
+    }
+
+    prefix_stats_t stats(const prefix_table_t *t) {
+        prefix_stats_t s;
+        EXPECT_EQ(0, prefix_table_stats(t, &s, 0));
+        return s;
+    }
+
+    prefix_table_t *arena = nullptr;
+    prefix_table_t *heap = nullptr;
+};
+
+// TC-ALLOC-1: Options are validated
+TEST_F(AllocTest, Options) {
+    prefix_table_opts_t opts = {};
+    prefix_table_t *t = prefix_table_create_ex(&opts);
+    ASSERT_NE(nullptr, t);
+    prefix_table_destroy(t);
+
+    t = prefix_table_create_ex(nullptr);
+    ASSERT_NE(nullptr, t);
+    prefix_table_destroy(t);
+
+    opts.alloc = static_cast<prefix_alloc_mode_t>(7);
+    EXPECT_EQ(nullptr, prefix_table_create_ex(&opts));
+}
+
+// TC-ALLOC-2: Arena table behaves like a heap table
+TEST_F(AllocTest, SameResultsAsHeap) {
+    std::mt19937 rng(37);
+    for (int i = 0; i < 20000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = rng() & (mask == 0 ? 0 : ~0U << (32 - mask));
+        if (rng() % 4 == 0) {
+            prefix_table_del(arena, base, static_cast<char>(mask));
+            prefix_table_del(heap, base, static_cast<char>(mask));
+        } else {
+            prefix_table_add(arena, base, static_cast<char>(mask));
+            prefix_table_add(heap, base, static_cast<char>(mask));
+        }
+    }
+
+    EXPECT_EQ(contents(heap), contents(arena));
+    for (int i = 0; i < 20000; i++) {
+        unsigned int ip = rng();
+        ASSERT_EQ(prefix_table_check(heap, ip), prefix_table_check(arena, ip));
+    }
+    EXPECT_EQ(stats(heap).nodes, stats(arena).nodes);
+}
+
+// TC-ALLOC-3: Freed nodes are reused and memory is mapped in 2 MB steps
+TEST_F(AllocTest, ReusesFreedNodes) {
+    size_t initial = stats(arena).node_bytes;
+    EXPECT_GE(initial, static_cast<size_t>(2) << 20);
+
+    for (int round = 0; round < 50; round++) {
+        for (unsigned int i = 0; i < 1000; i++) {
+            prefix_table_add(arena, 0x0A000000 | (i << 8), 24);
+        }
+        for (unsigned int i = 0; i < 1000; i++) {
+            prefix_table_del(arena, 0x0A000000 | (i << 8), 24);
+        }
+    }
+    EXPECT_EQ(initial, stats(arena).node_bytes);
+
+    // Enough nodes to need a second chunk
+    for (unsigned int i = 0; i < 200000; i++) {
+        prefix_table_add(arena, i << 8, 24);
+    }
+    size_t grown = stats(arena).node_bytes;
+    EXPECT_GT(grown, initial);
+    EXPECT_EQ(0u, (grown - initial) % (static_cast<size_t>(2) << 20));
+}
+
+// TC-ALLOC-4: Aggregation keeps the destination's allocation mode
+TEST_F(AllocTest, AggregateKeepsMode) {
+    prefix_table_add(heap, 0x0A000000, 9);
+    prefix_table_add(heap, 0x0A800000, 9);
+    ASSERT_EQ(0, prefix_table_aggregate(heap, arena, PREFIX_AGGREGATE_MATCH,
+                                        nullptr));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}), contents(arena));
+    EXPECT_GE(stats(arena).bytes, static_cast<size_t>(2) << 20);
+}
+
+// TC-ALLOC-5: Global table with options
+TEST(AllocGlobalTest, InitEx) {
+    prefix_table_opts_t opts = hugepage_opts();
+    opts.arena_chunk = 1; // rounded up to 2 MB
+    ASSERT_EQ(0, prefix_mgmt_init_ex(&opts));
+    EXPECT_EQ(0, add(0xC0A80100, 24));
+    EXPECT_EQ(24, check(0xC0A80101));
+
+    prefix_stats_t s;
+    ASSERT_EQ(0, prefix_mgmt_stats(&s, 0));
+    EXPECT_GE(s.bytes, static_cast<size_t>(2) << 20);
+    prefix_mgmt_cleanup();
+
+    opts.alloc = static_cast<prefix_alloc_mode_t>(-1);
+    EXPECT_EQ(-1, prefix_mgmt_init_ex(&opts));
+    EXPECT_EQ(nullptr, prefix_mgmt_table());
+}
@@ -0,0 +1,188 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+unsigned int net(unsigned int ip, int mask) {
+    return (mask == 0) ? 0 : ip & (~0U << (32 - mask));
+}
+
+void add_matched(unsigned int first, unsigned int last, char mask,
+                 void *ctx) {
+    if (mask >= 0) {
+        *static_cast<uint64_t *>(ctx) += uint64_t{last} - first + 1;
+    }
+}
+
+/**
+ * @brief Reference count from the segments of check_range().
+ */
+uint64_t reference(const prefix_table_t *t, unsigned int base, int mask) {
+    unsigned int last = base | ~(mask == 0 ? 0 : ~0U << (32 - mask));
+    uint64_t n = 0;
+    EXPECT_EQ(0, prefix_table_check_range(t, base, last, nullptr,
+                                          add_matched, &n));
+    return n;
+}
+
+uint64_t count(const prefix_table_t *t, unsigned int base, int mask) {
+    uint64_t n = 0;
+    EXPECT_EQ(0, prefix_table_count_covered(t, base, static_cast<char>(mask),
+                                            &n));
+    return n;
+}
+
+} // namespace
+
+class CoveredTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    /**
+     * @brief Compares the total and the counts of random query prefixes.
+     */
+    void verify(const prefix_table_t *t, std::mt19937 &rng) {
+        ASSERT_EQ(reference(t, 0, 0), count(t, 0, 0));
+        for (int i = 0; i < 20; i++) {
+            int mask = static_cast<int>(rng() % 33);
+            unsigned int base = net((rng() & 0x3C3FFFFF) | 0x81000000, mask);
+            ASSERT_EQ(reference(t, base, mask), count(t, base, mask))
+                << std::hex << base << "/" << std::dec << mask;
+        }
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+// TC-COVER-1: Nested and overlapping prefixes count once
+TEST_F(CoveredTest, Basic) {
+    EXPECT_EQ(0u, count(table, 0, 0));
+
+    ASSERT_EQ(0, prefix_table_add(table, 0x0A000000, 8));
+    EXPECT_EQ(1u << 24, count(table, 0, 0));
+    ASSERT_EQ(0, prefix_table_add(table, 0x0A010000, 16));
+    ASSERT_EQ(0, prefix_table_add(table, 0x0A010101, 32));
+    EXPECT_EQ(1u << 24, count(table, 0, 0));
+    EXPECT_EQ(1u << 16, count(table, 0x0A010000, 16));
+    EXPECT_EQ(256u, count(table, 0x0A020300, 24));
+
+    ASSERT_EQ(0, prefix_table_add(table, 0xC0A80100, 24));
+    ASSERT_EQ(0, prefix_table_add(table, 0xC0A80201, 32));
+    EXPECT_EQ((1u << 24) + 257, count(table, 0, 0));
+    EXPECT_EQ(257u, count(table, 0xC0A80000, 16));
+    EXPECT_EQ(1u, count(table, 0xC0A80200, 24));
+    EXPECT_EQ(0u, count(table, 0xC0A80300, 24));
+
+    // Removing the /8 leaves the nested /16 (and its /32)
+    ASSERT_EQ(0, prefix_table_del(table, 0x0A000000, 8));
+    EXPECT_EQ((1u << 16) + 257, count(table, 0, 0));
+    ASSERT_EQ(0, prefix_table_del(table, 0x0A010000, 16));
+    EXPECT_EQ(258u, count(table, 0, 0));
+    EXPECT_EQ(2, prefix_table_del_covered(table, 0xC0A80000, 16));
+    EXPECT_EQ(1u, count(table, 0, 0));
+
+    // The default route covers everything
+    ASSERT_EQ(0, prefix_table_add(table, 0, 0));
+    EXPECT_EQ(uint64_t{1} << 32, count(table, 0, 0));
+    EXPECT_EQ(uint64_t{1} << 31, count(table, 0x80000000, 1));
+    EXPECT_EQ(1u, count(table, 0xFFFFFFFF, 32));
+    ASSERT_EQ(0, prefix_table_del(table, 0, 0));
+    EXPECT_EQ(1u, count(table, 0, 0));
+    ASSERT_EQ(0, prefix_table_add(table, 0, 1));
+    ASSERT_EQ(0, prefix_table_add(table, 0x80000000, 1));
+    EXPECT_EQ(uint64_t{1} << 32, count(table, 0, 0));
+
+    uint64_t n;
+    EXPECT_EQ(-1, prefix_table_count_covered(table, 0x0A000001, 8, &n));
+    EXPECT_EQ(-1, prefix_table_count_covered(table, 0, 33, &n));
+    EXPECT_EQ(-1, prefix_table_count_covered(table, 0, 0, nullptr));
+    EXPECT_EQ(-1, prefix_table_count_covered(nullptr, 0, 0, &n));
+
+    // Global table
+    ASSERT_EQ(0, prefix_mgmt_init());
+    ASSERT_EQ(0, add(0x0A000000, 8));
+    ASSERT_EQ(0, count_covered(0, 0, &n));
+    EXPECT_EQ(1u << 24, n);
+    prefix_mgmt_cleanup();
+    EXPECT_EQ(-1, count_covered(0, 0, &n));
+}
+
+// TC-COVER-2: Random add, del and del_covered keep the counts right
+TEST_F(CoveredTest, RandomOperations) {
+    std::mt19937 rng(50);
+    std::vector<std::pair<unsigned int, int>> stored;
+    for (int i = 0; i < 5000; i++) {
+        unsigned int r = rng() % 100;
+        unsigned int ip = (rng() & 0x3C3FFFFF) | 0x81000000;
+        int mask = (rng() % 8 == 0) ? static_cast<int>(rng() % 33)
+                                    : 8 + static_cast<int>(rng() % 25);
+        if (r < 55) {
+            ASSERT_EQ(0, prefix_table_add(table, net(ip, mask),
+                                          static_cast<char>(mask)));
+            stored.emplace_back(net(ip, mask), mask);
+        } else if (r < 95 && !stored.empty()) {
+            std::size_t pick = rng() % stored.size();
+            ASSERT_EQ(0, prefix_table_del(table, stored[pick].first,
+                                          static_cast<char>(
+                                              stored[pick].second)));
+        } else {
+            mask = 6 + static_cast<int>(rng() % 20);
+            ASSERT_GE(prefix_table_del_covered(table, net(ip, mask),
+                                               static_cast<char>(mask)),
+                      0);
+        }
+        if (i % 50 == 0) {
+            verify(table, rng);
+        }
+    }
+    verify(table, rng);
+}
+
+// TC-COVER-3: Tables rebuilt or moved as a whole
+TEST_F(CoveredTest, RebuiltTables) {
+    prefix_table_t *other = prefix_table_create();
+    ASSERT_NE(nullptr, other);
+    std::mt19937 rng(150);
+    for (int i = 0; i < 3000; i++) {
+        unsigned int ip = (rng() & 0x3C3FFFFF) | 0x81000000;
+        int mask = 4 + static_cast<int>(rng() % 29);
+        prefix_table_add((rng() % 2 == 0) ? table : other, net(ip, mask),
+                         static_cast<char>(mask));
+    }
+
+    for (prefix_set_op_t op :
+         {PREFIX_SET_UNION, PREFIX_SET_INTERSECT, PREFIX_SET_DIFF}) {
+        for (prefix_set_mode_t mode :
+             {PREFIX_SET_PREFIXES, PREFIX_SET_ADDRESSES}) {
+            prefix_table_t *out = prefix_table_create();
+            ASSERT_EQ(0, prefix_table_combine(table, other, out, op, mode));
+            verify(out, rng);
+            prefix_table_destroy(out);
+        }
+    }
+
+    uint64_t before = count(table, 0, 0);
+    ASSERT_EQ(0, prefix_table_aggregate(table, table,
+                                        PREFIX_AGGREGATE_EXACT, nullptr));
+    EXPECT_EQ(before, count(table, 0, 0));
+    verify(table, rng);
+
+    ASSERT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_VEB));
+    verify(table, rng);
+    ASSERT_EQ(0, prefix_table_add(table, 0x81000000, 9));
+    verify(table, rng);
+    ASSERT_EQ(0, prefix_table_del(table, 0x81000000, 9));
+    verify(table, rng);
+
+    prefix_table_destroy(other);
+}
@@ -0,0 +1,170 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> contents(const prefix_table_t *table) {
+    std::vector<Prefix> out;
+    prefix_iter_t it;
+    unsigned int base;
+    char mask;
+    prefix_iter_init(&it, table);
+    while (prefix_iter_next(&it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+unsigned int net(int mask) { return mask == 0 ? 0 : ~0U << (32 - mask); }
+
+// Counters recomputed from the tree itself
+void walk(const radix_node_t *node, const radix_node_t *root,
+          prefix_stats_t *s) {
+    if (node == nullptr) {
+        return;
+    }
+    s->nodes++;
+    if (node->is_prefix) {
+        s->prefixes++;
+        s->mask_count[static_cast<int>(node->mask)]++;
+    } else if (node != root &&
+               (node->left == nullptr || node->right == nullptr)) {
+        s->dead_nodes++;
+    }
+    walk(node->left, root, s);
+    walk(node->right, root, s);
+}
+
+} // namespace
+
+class DelCoveredTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    void expect_counters() {
+        prefix_stats_t expected;
+        std::memset(&expected, 0, sizeof(expected));
+        walk(prefix_table_root(table), prefix_table_root(table), &expected);
+
+        prefix_stats_t s;
+        ASSERT_EQ(0, prefix_table_stats(table, &s, 0));
+        EXPECT_EQ(expected.nodes, s.nodes);
+        EXPECT_EQ(expected.prefixes, s.prefixes);
+        EXPECT_EQ(expected.dead_nodes, s.dead_nodes);
+        EXPECT_EQ(0, std::memcmp(expected.mask_count, s.mask_count,
+                                 sizeof(s.mask_count)));
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+// TC-DELCOV-1: Invalid arguments
+TEST_F(DelCoveredTest, InvalidArguments) {
+    EXPECT_EQ(-1, prefix_table_del_covered(nullptr, 0x0A000000, 8));
+    EXPECT_EQ(-1, prefix_table_del_covered(table, 0x0A000000, 33));
+    EXPECT_EQ(-1, prefix_table_del_covered(table, 0x0A000000, -1));
+    EXPECT_EQ(-1, prefix_table_del_covered(table, 0x0A000001, 8));
+    EXPECT_EQ(0, prefix_table_del_covered(table, 0x0A000000, 8)); // empty
+}
+
+// TC-DELCOV-2: Covered prefixes go, others stay
+TEST_F(DelCoveredTest, Basic) {
+    prefix_table_add(table, 0x0A000000, 8);  // 10.0.0.0/8
+    prefix_table_add(table, 0x0A010000, 16); // 10.1.0.0/16
+    prefix_table_add(table, 0x0A010100, 24); // 10.1.1.0/24
+    prefix_table_add(table, 0x0A020000, 16); // 10.2.0.0/16
+    prefix_table_add(table, 0x0B000000, 8);  // 11.0.0.0/8
+
+    EXPECT_EQ(2, prefix_table_del_covered(table, 0x0A010000, 16));
+    EXPECT_EQ(8, prefix_table_check(table, 0x0A010101));
+    EXPECT_EQ(16, prefix_table_check(table, 0x0A020101));
+    expect_counters();
+
+    EXPECT_EQ(0, prefix_table_del_covered(table, 0x0A010000, 16));
+    EXPECT_EQ(2, prefix_table_del_covered(table, 0x0A000000, 8));
+    EXPECT_EQ((std::vector<Prefix>{{0x0B000000, 8}}), contents(table));
+    expect_counters();
+}
+
+// TC-DELCOV-3: Covering prefix ends inside a compressed path
+TEST_F(DelCoveredTest, InsideCompressedPath) {
+    prefix_table_add(table, 0x0A010100, 24); // 10.1.1.0/24
+    prefix_table_add(table, 0x0A010200, 24); // 10.1.2.0/24, split at /22
+    prefix_table_add(table, 0x0A800000, 9);  // 10.128.0.0/9
+
+    EXPECT_EQ(0, prefix_table_del_covered(table, 0x0A020000, 16));
+    EXPECT_EQ(0, prefix_table_del_covered(table, 0x0A010300, 24));
+    EXPECT_EQ(2, prefix_table_del_covered(table, 0x0A000000, 12));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A800000, 9}}), contents(table));
+    expect_counters();
+
+    // The split at /8 lost a side and was merged into 10.128.0.0/9
+    prefix_stats_t s;
+    ASSERT_EQ(0, prefix_table_stats(table, &s, 0));
+    EXPECT_EQ(2u, s.nodes);
+    EXPECT_EQ(0u, s.dead_nodes);
+}
+
+// TC-DELCOV-4: Same result as deleting the covered prefixes one by one
+TEST_F(DelCoveredTest, MatchesSingleDeletes) {
+    prefix_table_t *ref = prefix_table_create();
+    ASSERT_NE(nullptr, ref);
+
+    std::mt19937 rng(41);
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < 200; i++) {
+            int mask = 4 + static_cast<int>(rng() % 29);
+            unsigned int base = (rng() & 0xF0FFFFFF) & net(mask);
+            prefix_table_add(table, base, static_cast<char>(mask));
+            prefix_table_add(ref, base, static_cast<char>(mask));
+        }
+
+        int mask = static_cast<int>(rng() % 20);
+        unsigned int base = rng() & net(mask);
+        int expected = 0;
+        for (const Prefix &p : contents(ref)) {
+            if (p.second >= mask && (p.first & net(mask)) == base) {
+                prefix_table_del(ref, p.first, static_cast<char>(p.second));
+                expected++;
+            }
+        }
+
+        ASSERT_EQ(expected, prefix_table_del_covered(table, base,
+                                                     static_cast<char>(mask)))
+            << "round " << round;
+        ASSERT_EQ(contents(ref), contents(table)) << "round " << round;
+        expect_counters();
+    }
+    prefix_table_destroy(ref);
+}
+
+// TC-DELCOV-5: /0 empties the table; global API
+TEST_F(DelCoveredTest, EverythingAndGlobal) {
+    prefix_table_add(table, 0, 0);
+    prefix_table_add(table, 0x0A000000, 8);
+    prefix_table_add(table, 0xC0A80100, 24);
+    EXPECT_EQ(3, prefix_table_del_covered(table, 0, 0));
+    EXPECT_TRUE(contents(table).empty());
+    EXPECT_EQ(-1, prefix_table_check(table, 0x0A000001));
+    expect_counters();
+
+    EXPECT_EQ(-1, del_covered(0x0A000000, 8)); // not initialized
+    ASSERT_EQ(0, prefix_mgmt_init());
+    EXPECT_EQ(0, add(0x0A000000, 8));
+    EXPECT_EQ(0, add(0x0A010000, 16));
+    EXPECT_EQ(1, del_covered(0x0A010000, 16));
+    EXPECT_EQ(8, check(0x0A010001));
+    prefix_mgmt_cleanup();
+}
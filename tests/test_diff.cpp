@@ -0,0 +1,148 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+typedef std::tuple<prefix_diff_op_t, unsigned int, int> Change;
+
+void collect(prefix_diff_op_t op, unsigned int base, char mask, void *ctx) {
+    static_cast<std::vector<Change> *>(ctx)->emplace_back(op, base, mask);
+}
+
+} // namespace
+
+class DiffTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        from = prefix_table_create();
+        to = prefix_table_create();
+        ASSERT_NE(nullptr, from);
+        ASSERT_NE(nullptr, to);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(from);
+        prefix_table_destroy(to);
+    }
+
+    std::vector<Change> diff() {
+        std::vector<Change> changes;
+        int n = prefix_table_diff(from, to, collect, &changes);
+        EXPECT_EQ(static_cast<int>(changes.size()), n);
+        return changes;
+    }
+
+    prefix_table_t *from = nullptr;
+    prefix_table_t *to = nullptr;
+};
+
+// TC-DIFF-1: Identical tables
+TEST_F(DiffTest, IdenticalTables) {
+    for (prefix_table_t *t : {from, to}) {
+        prefix_table_add(t, 0x0A000000, 8);
+        prefix_table_add(t, 0xC0A80100, 24);
+        prefix_table_add(t, 0x00000000, 0);
+    }
+
+    EXPECT_TRUE(diff().empty());
+    EXPECT_EQ(0, prefix_table_diff(from, from, nullptr, nullptr));
+}
+
+// TC-DIFF-2: Added and removed prefixes in address order
+TEST_F(DiffTest, AddedAndRemoved) {
+    prefix_table_add(from, 0x0A000000, 8);  // 10.0.0.0/8
+    prefix_table_add(from, 0xC0A80000, 16); // 192.168.0.0/16
+    prefix_table_add(to, 0x0A000000, 8);    // 10.0.0.0/8
+    prefix_table_add(to, 0x0A140000, 16);   // 10.20.0.0/16
+    prefix_table_add(to, 0x00000000, 0);    // 0.0.0.0/0
+
+    std::vector<Change> expected = {
+        Change(PREFIX_DIFF_ADD, 0x00000000, 0),
+        Change(PREFIX_DIFF_ADD, 0x0A140000, 16),
+        Change(PREFIX_DIFF_DEL, 0xC0A80000, 16),
+    };
+    EXPECT_EQ(expected, diff());
+}
+
+// TC-DIFF-3: Trees with different shapes
+TEST_F(DiffTest, DifferentShapes) {
+    // from: one compressed /24; to: same /24 split by a sibling branch
+    prefix_table_add(from, 0xC0A80100, 24);
+    prefix_table_add(to, 0xC0A80100, 24);
+    prefix_table_add(to, 0xC0A80000, 24);
+    prefix_table_add(to, 0xC0A80180, 25);
+
+    std::vector<Change> expected = {
+        Change(PREFIX_DIFF_ADD, 0xC0A80000, 24),
+        Change(PREFIX_DIFF_ADD, 0xC0A80180, 25),
+    };
+    EXPECT_EQ(expected, diff());
+
+    // Reverse direction reports deletions
+    std::vector<Change> reverse;
+    prefix_table_diff(to, from, collect, &reverse);
+    ASSERT_EQ(2u, reverse.size());
+    EXPECT_EQ(Change(PREFIX_DIFF_DEL, 0xC0A80000, 24), reverse[0]);
+    EXPECT_EQ(Change(PREFIX_DIFF_DEL, 0xC0A80180, 25), reverse[1]);
+}
+
+// TC-DIFF-4: Invalid arguments
+TEST_F(DiffTest, InvalidArguments) {
+    EXPECT_EQ(-1, prefix_table_diff(nullptr, to, nullptr, nullptr));
+    EXPECT_EQ(-1, prefix_table_diff(from, nullptr, nullptr, nullptr));
+}
+
+// TC-DIFF-5: Random tables - diff matches set difference and applies cleanly
+TEST_F(DiffTest, RandomTablesMatchReference) {
+    std::mt19937 rng(26);
+    std::set<std::pair<unsigned int, int>> ref_from, ref_to;
+
+    for (int i = 0; i < 2000; i++) {
+        int mask = 8 + static_cast<int>(rng() % 25);
+        unsigned int base = (0x0A000000 | (rng() & 0x00FFFFFF)) &
+                            (mask == 0 ? 0 : ~0U << (32 - mask));
+        unsigned int pick = rng() % 3;
+        if (pick != 1) {
+            prefix_table_add(from, base, static_cast<char>(mask));
+            ref_from.emplace(base, mask);
+        }
+        if (pick != 0) {
+            prefix_table_add(to, base, static_cast<char>(mask));
+            ref_to.emplace(base, mask);
+        }
+    }
+
+    std::vector<Change> expected;
+    auto f = ref_from.begin();
+    auto t = ref_to.begin();
+    while (f != ref_from.end() || t != ref_to.end()) {
+        if (t == ref_to.end() || (f != ref_from.end() && *f < *t)) {
+            expected.emplace_back(PREFIX_DIFF_DEL, f->first, f->second);
+            ++f;
+        } else if (f == ref_from.end() || *t < *f) {
+            expected.emplace_back(PREFIX_DIFF_ADD, t->first, t->second);
+            ++t;
+        } else {
+            ++f;
+            ++t;
+        }
+    }
+
+    std::vector<Change> changes = diff();
+    EXPECT_EQ(expected, changes);
+
+    for (const Change &c : changes) {
+        char mask = static_cast<char>(std::get<2>(c));
+        if (std::get<0>(c) == PREFIX_DIFF_ADD) {
+            prefix_table_add(from, std::get<1>(c), mask);
+        } else {
+            prefix_table_del(from, std::get<1>(c), mask);
+        }
+    }
+    EXPECT_TRUE(diff().empty());
+}
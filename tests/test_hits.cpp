@@ -0,0 +1,119 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::map<std::pair<unsigned int, int>, uint64_t> HitMap;
+
+void collect(unsigned int base, char mask, uint64_t hits, void *ctx) {
+    (*static_cast<HitMap *>(ctx))[std::make_pair(base, mask)] = hits;
+}
+
+} // namespace
+
+class HitsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    HitMap hits() {
+        HitMap out;
+        EXPECT_LE(0, prefix_table_hits(table, collect, &out));
+        return out;
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+
+// TC-HIT-1: Only the longest match is counted
+TEST_F(HitsTest, CountsLongestMatch) {
+    prefix_table_add(table, 0x0A000000, 8);  // 10.0.0.0/8
+    prefix_table_add(table, 0x0A140000, 16); // 10.20.0.0/16
+
+    for (int i = 0; i < 5; i++) {
+        prefix_table_check(table, 0x0A140001); // -> /16
+    }
+    prefix_table_check(table, 0x0A010101); // -> /8
+    prefix_table_check(table, 0x0B000000); // no match
+
+    HitMap h = hits();
+    ASSERT_EQ(2u, h.size());
+    EXPECT_EQ(1u, (h[{0x0A000000, 8}]));
+    EXPECT_EQ(5u, (h[{0x0A140000, 16}]));
+}
+
+// TC-HIT-2: Counters follow merges and restart after delete
+TEST_F(HitsTest, DeleteAndMerge) {
+    prefix_table_add(table, 0xC0A80100, 24); // 192.168.1.0/24
+    prefix_table_add(table, 0xC0A80180, 25); // 192.168.1.128/25
+
+    prefix_table_check(table, 0xC0A80101); // -> /24
+    prefix_table_check(table, 0xC0A80181); // -> /25
+    prefix_table_check(table, 0xC0A80181); // -> /25
+
+    // Deleting the /24 merges its node with the /25 below
+    prefix_table_del(table, 0xC0A80100, 24);
+    HitMap h = hits();
+    ASSERT_EQ(1u, h.size());
+    EXPECT_EQ(2u, (h[{0xC0A80180, 25}]));
+
+    // A re-added prefix starts from zero
+    prefix_table_add(table, 0xC0A80100, 24);
+    h = hits();
+    EXPECT_EQ(0u, (h[{0xC0A80100, 24}]));
+    EXPECT_EQ(2u, (h[{0xC0A80180, 25}]));
+}
+
+// TC-HIT-3: Reset
+TEST_F(HitsTest, Reset) {
+    prefix_table_add(table, 0x00000000, 0);
+    prefix_table_check(table, 0x01020304);
+    EXPECT_EQ(1u, (hits()[{0, 0}]));
+
+    ASSERT_EQ(0, prefix_table_hits_reset(table));
+    EXPECT_EQ(0u, (hits()[{0, 0}]));
+}
+
+// TC-HIT-4: Counts from several threads are summed
+TEST_F(HitsTest, ThreadsAreSummed) {
+    prefix_table_add(table, 0x0A000000, 8);
+    for (unsigned int i = 0; i < 2000; i++) {
+        prefix_table_add(table, 0x0B000000 | (i << 8), 24);
+    }
+
+    // More threads than owned shards, so some share the last one
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 80; t++) {
+        threads.emplace_back([this] {
+            for (int i = 0; i < 2000; i++) {
+                prefix_table_check(table, 0x0A000001);
+            }
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(160000u, (hits()[{0x0A000000, 8}]));
+}
+
+#else
+
+// TC-HIT-1: Hit counters compiled out
+TEST_F(HitsTest, CompiledOut) {
+    EXPECT_EQ(-1, prefix_table_hits(table, collect, nullptr));
+    EXPECT_EQ(-1, prefix_table_hits_reset(table));
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "mirror_test.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+prefix_table_opts_t host_opts() {
+    prefix_table_opts_t opts = {};
+    opts.flags = PREFIX_OPT_HOST_HASH;
+    return opts;
+}
+
+} // namespace
+
+class HostsTest : public MirrorTest {
+  protected:
+    HostsTest() : MirrorTest(PREFIX_OPT_HOST_HASH) {}
+};
+
+// TC-HOST-1: /32 prefixes are found and removed; flags are validated
+TEST_F(HostsTest, Basic) {
+    add_both(0x0A000000, 8);
+    add_both(0x0A000001, 32);
+    add_both(0x00000000, 32);
+    add_both(0xFFFFFFFF, 32);
+
+    EXPECT_EQ(32, prefix_table_check(table, 0x0A000001));
+    EXPECT_EQ(8, prefix_table_check(table, 0x0A000002));
+    EXPECT_EQ(32, prefix_table_check(table, 0x00000000));
+    EXPECT_EQ(-1, prefix_table_check(table, 0x00000001));
+    EXPECT_EQ(32, prefix_table_check(table, 0xFFFFFFFF));
+
+    del_both(0x0A000001, 32);
+    EXPECT_EQ(8, prefix_table_check(table, 0x0A000001));
+    del_both(0x00000000, 32);
+    EXPECT_EQ(-1, prefix_table_check(table, 0x00000000));
+    del_both(0x0A000005, 32); // not stored
+    EXPECT_EQ(-1, prefix_table_add(table, 0x0A000001, 33));
+
+    // The set is counted in the table size
+    prefix_stats_t with, without;
+    ASSERT_EQ(0, prefix_table_stats(table, &with, 0));
+    ASSERT_EQ(0, prefix_table_stats(plain, &without, 0));
+    EXPECT_EQ(without.prefixes, with.prefixes);
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    // The flag is accepted but no set is built
+    prefix_table_opts_t opts_hosts = host_opts();
+    prefix_table_t *empty_hosts = prefix_table_create_ex(&opts_hosts);
+    prefix_table_t *empty = prefix_table_create();
+    ASSERT_EQ(0, prefix_table_stats(empty_hosts, &with, 0));
+    ASSERT_EQ(0, prefix_table_stats(empty, &without, 0));
+    EXPECT_EQ(without.bytes, with.bytes);
+    prefix_table_destroy(empty_hosts);
+    prefix_table_destroy(empty);
+#else
+    EXPECT_GT(with.bytes, without.bytes);
+#endif
+
+    prefix_table_opts_t bad = host_opts();
+    bad.flags = ~0u;
+    EXPECT_EQ(nullptr, prefix_table_create_ex(&bad));
+
+    // The global table takes the same options
+    prefix_table_opts_t opts = host_opts();
+    ASSERT_EQ(0, prefix_mgmt_init_ex(&opts));
+    EXPECT_EQ(0, add(0x0A000001, 32));
+    EXPECT_EQ(32, check(0x0A000001));
+    EXPECT_EQ(0, del(0x0A000001, 32));
+    EXPECT_EQ(-1, check(0x0A000001));
+    prefix_mgmt_cleanup();
+}
+
+// TC-HOST-2: Random host-heavy operations match a table without the set
+TEST_F(HostsTest, SameResultsAsTree) {
+    std::mt19937 rng(46);
+    std::vector<unsigned int> stored;
+    for (int i = 0; i < 30000; i++) {
+        unsigned int r = rng() % 100;
+        // Few distinct upper bits, so hosts nest under shorter prefixes
+        unsigned int ip = (rng() & 0x0F0F0FFF) | 0x0A000000;
+        if (r < 55) {
+            add_both(ip, 32);
+            stored.push_back(ip);
+        } else if (r < 70) {
+            int mask = 8 + static_cast<int>(rng() % 24);
+            add_both(ip & (~0U << (32 - mask)), mask);
+        } else if (r < 95 && !stored.empty()) {
+            del_both(stored[rng() % stored.size()], 32);
+        } else {
+            int mask = 12 + static_cast<int>(rng() % 21);
+            unsigned int base = ip & (~0U << (32 - mask));
+            del_covered_both(base, mask);
+        }
+
+        unsigned int probe =
+            stored.empty() ? rng() : stored[rng() % stored.size()];
+        ASSERT_EQ(prefix_table_check(plain, probe),
+                  prefix_table_check(table, probe));
+        ASSERT_EQ(prefix_table_check(plain, ip), prefix_table_check(table, ip));
+    }
+
+    prefix_stats_t a, b;
+    ASSERT_EQ(0, prefix_table_stats(plain, &a, 0));
+    ASSERT_EQ(0, prefix_table_stats(table, &b, 0));
+    EXPECT_EQ(a.prefixes, b.prefixes);
+    EXPECT_EQ(a.mask_count[32], b.mask_count[32]);
+
+    // Removing everything leaves no host behind
+    del_covered_both(0, 0);
+    for (unsigned int ip : stored) {
+        ASSERT_EQ(-1, prefix_table_check(table, ip));
+    }
+}
+
+// TC-HOST-3: Tables rebuilt on the side keep their host set right
+TEST_F(HostsTest, RebuiltTables) {
+    std::mt19937 rng(146);
+    std::vector<unsigned int> probes;
+    auto gen = [&] {
+        unsigned int ip = (rng() & 0x00FFFFFF) | 0x0A000000;
+        int mask = (rng() % 2 == 0) ? 32 : 20 + static_cast<int>(rng() % 12);
+        probes.push_back(net(ip, mask));
+        return std::make_pair(net(ip, mask), mask);
+    };
+    rebuilt_tables(rng, 2000, gen,
+                   [&](const prefix_table_t *expected,
+                       const prefix_table_t *actual) {
+                       for (unsigned int ip : probes) {
+                           ASSERT_EQ(prefix_table_check(expected, ip),
+                                     prefix_table_check(actual, ip));
+                       }
+                   });
+}
@@ -0,0 +1,167 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+class InstrTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    prefix_instr_snapshot_t snapshot() {
+        prefix_instr_snapshot_t s;
+        EXPECT_EQ(0, prefix_table_instr_snapshot(table, &s));
+        return s;
+    }
+
+    static uint64_t sum(const uint64_t *buckets, int n) {
+        uint64_t total = 0;
+        for (int i = 0; i < n; i++) {
+            total += buckets[i];
+        }
+        return total;
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+// TC-INSTR-1: Bucket bounds are increasing and percentiles pick buckets
+TEST_F(InstrTest, Buckets) {
+    for (int b = 0; b < 8; b++) {
+        EXPECT_EQ(static_cast<uint64_t>(b), prefix_instr_bucket_floor(b));
+    }
+    EXPECT_EQ(10u, prefix_instr_bucket_floor(9));  // 8, 10, 12, 14
+    EXPECT_EQ(16u, prefix_instr_bucket_floor(12)); // next power of two
+    for (int b = 1; b < PREFIX_INSTR_LATENCY_BUCKETS; b++) {
+        EXPECT_LT(prefix_instr_bucket_floor(b - 1),
+                  prefix_instr_bucket_floor(b));
+    }
+
+    prefix_op_histogram_t h;
+    std::memset(&h, 0, sizeof(h));
+    EXPECT_EQ(0u, prefix_instr_percentile(&h, 50.0));
+
+    h.count = 100;
+    h.latency[4] = 90;  // 4
+    h.latency[12] = 10; // 16
+    EXPECT_EQ(4u, prefix_instr_percentile(&h, 50.0));
+    EXPECT_EQ(4u, prefix_instr_percentile(&h, 90.0));
+    EXPECT_EQ(16u, prefix_instr_percentile(&h, 99.0));
+}
+
+#ifdef PREFIX_MGMT_INSTRUMENT
+
+// TC-INSTR-2: Every call is counted once per operation
+TEST_F(InstrTest, CountsCalls) {
+    prefix_table_add(table, 0x0A000000, 8);
+    prefix_table_add(table, 0x0A140000, 16);
+    prefix_table_add(table, 0x0A140100, 33); // invalid, still measured
+    for (int i = 0; i < 5; i++) {
+        prefix_table_check(table, 0x0A140001);
+    }
+    prefix_table_del(table, 0x0A140000, 16);
+
+    prefix_instr_snapshot_t s = snapshot();
+    EXPECT_EQ(3u, s.op[PREFIX_OP_ADD].count);
+    EXPECT_EQ(5u, s.op[PREFIX_OP_CHECK].count);
+    EXPECT_EQ(1u, s.op[PREFIX_OP_DEL].count);
+
+    for (int op = 0; op < PREFIX_OP_COUNT; op++) {
+        EXPECT_EQ(s.op[op].count,
+                  sum(s.op[op].latency, PREFIX_INSTR_LATENCY_BUCKETS));
+        EXPECT_EQ(s.op[op].count,
+                  sum(s.op[op].depth, PREFIX_INSTR_DEPTH_BUCKETS));
+    }
+}
+
+// TC-INSTR-3: Depth is the number of nodes visited below the root
+TEST_F(InstrTest, Depth) {
+    prefix_table_check(table, 0x0A000001); // empty table
+    prefix_table_add(table, 0x0A000000, 8);
+    prefix_table_add(table, 0x0A140000, 16);
+    prefix_table_add(table, 0x0A140100, 24);
+    prefix_table_check(table, 0x0A140101); // /8 -> /16 -> /24
+    prefix_table_check(table, 0x0A000001); // /8, then misses below it
+
+    prefix_instr_snapshot_t s = snapshot();
+    EXPECT_EQ(1u, s.op[PREFIX_OP_CHECK].depth[0]);
+    EXPECT_EQ(1u, s.op[PREFIX_OP_CHECK].depth[2]);
+    EXPECT_EQ(1u, s.op[PREFIX_OP_CHECK].depth[3]);
+
+    // Adds walk one node more each time
+    EXPECT_EQ(1u, s.op[PREFIX_OP_ADD].depth[0]);
+    EXPECT_EQ(1u, s.op[PREFIX_OP_ADD].depth[1]);
+    EXPECT_EQ(1u, s.op[PREFIX_OP_ADD].depth[2]);
+}
+
+// TC-INSTR-4: Reset and invalid arguments
+TEST_F(InstrTest, Reset) {
+    prefix_table_add(table, 0x00000000, 0);
+    prefix_table_check(table, 0x01020304);
+    EXPECT_EQ(1u, snapshot().op[PREFIX_OP_CHECK].count);
+
+    ASSERT_EQ(0, prefix_table_instr_reset(table));
+    prefix_instr_snapshot_t s = snapshot();
+    for (int op = 0; op < PREFIX_OP_COUNT; op++) {
+        EXPECT_EQ(0u, s.op[op].count);
+    }
+
+    EXPECT_EQ(-1, prefix_table_instr_snapshot(nullptr, &s));
+    EXPECT_EQ(-1, prefix_table_instr_snapshot(table, nullptr));
+    EXPECT_EQ(-1, prefix_table_instr_reset(nullptr));
+}
+
+// TC-INSTR-5: Measurements from several threads are summed
+TEST_F(InstrTest, ThreadsAreSummed) {
+    prefix_table_add(table, 0x0A000000, 8);
+
+    // More threads than owned shards, so some share the last one
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 80; t++) {
+        threads.emplace_back([this] {
+            for (int i = 0; i < 2000; i++) {
+                prefix_table_check(table, 0x0A000001);
+            }
+        });
+    }
+    for (std::thread &t : threads) {
+        t.join();
+    }
+
+    prefix_instr_snapshot_t s = snapshot();
+    EXPECT_EQ(160000u, s.op[PREFIX_OP_CHECK].count);
+    EXPECT_EQ(160000u, s.op[PREFIX_OP_CHECK].depth[1]);
+}
+
+// TC-INSTR-6: Aggregating into a table keeps its measurements
+TEST_F(InstrTest, AggregateKeepsHandleData) {
+    prefix_table_t *src = prefix_table_create();
+    ASSERT_NE(nullptr, src);
+    prefix_table_add(src, 0x0A000000, 8);
+
+    prefix_table_check(table, 0x0A000001);
+    ASSERT_EQ(0, prefix_table_aggregate(src, table, PREFIX_AGGREGATE_EXACT,
+                                        nullptr));
+    prefix_instr_snapshot_t s = snapshot();
+    EXPECT_EQ(1u, s.op[PREFIX_OP_CHECK].count);
+    EXPECT_EQ(0u, s.op[PREFIX_OP_ADD].count);
+
+    prefix_table_destroy(src);
+}
+
+#else
+
+// TC-INSTR-2: Instrumentation compiled out
+TEST_F(InstrTest, CompiledOut) {
+    prefix_instr_snapshot_t s;
+    EXPECT_EQ(-1, prefix_table_instr_snapshot(table, &s));
+    EXPECT_EQ(-1, prefix_table_instr_reset(table));
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> drain(prefix_iter_t *it) {
+    std::vector<Prefix> out;
+    unsigned int base;
+    char mask;
+    while (prefix_iter_next(it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+} // namespace
+
+class IterTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    void add_all(const std::vector<Prefix> &prefixes) {
+        for (const Prefix &p : prefixes) {
+            ASSERT_EQ(0, prefix_table_add(table, p.first,
+                                          static_cast<char>(p.second)));
+        }
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+// TC-ITER-1: Empty table and NULL table
+TEST_F(IterTest, EmptyTable) {
+    prefix_iter_t it;
+    prefix_iter_init(&it, table);
+    EXPECT_TRUE(drain(&it).empty());
+
+    prefix_iter_init(&it, nullptr);
+    EXPECT_TRUE(drain(&it).empty());
+}
+
+// TC-ITER-2: Prefixes come out in address order
+TEST_F(IterTest, AddressOrder) {
+    add_all({{0xC0A80100, 24}, // 192.168.1.0/24
+             {0x0A000000, 8},  // 10.0.0.0/8
+             {0xC0A80000, 16}, // 192.168.0.0/16
+             {0xC0A80180, 25}, // 192.168.1.128/25
+             {0x00000000, 0},  // 0.0.0.0/0
+             {0x0A000000, 16}, // 10.0.0.0/16
+             {0xFFFFFFFF, 32}});
+
+    std::vector<Prefix> expected = {
+        {0x00000000, 0},  {0x0A000000, 8},  {0x0A000000, 16},
+        {0xC0A80000, 16}, {0xC0A80100, 24}, {0xC0A80180, 25},
+        {0xFFFFFFFF, 32}};
+
+    prefix_iter_t it;
+    prefix_iter_init(&it, table);
+    EXPECT_EQ(expected, drain(&it));
+}
+
+// TC-ITER-3: Seek to an existing, a missing and a past-the-end key
+TEST_F(IterTest, Seek) {
+    add_all({{0x0A000000, 8},
+             {0x0A000000, 16},
+             {0xC0A80000, 16},
+             {0xC0A80100, 24}});
+
+    prefix_iter_t it;
+    ASSERT_EQ(0, prefix_iter_seek(&it, table, 0x0A000000, 16));
+    EXPECT_EQ((std::vector<Prefix>{
+                  {0x0A000000, 16}, {0xC0A80000, 16}, {0xC0A80100, 24}}),
+              drain(&it));
+
+    ASSERT_EQ(0, prefix_iter_seek(&it, table, 0xC0000000, 8));
+    EXPECT_EQ((std::vector<Prefix>{{0xC0A80000, 16}, {0xC0A80100, 24}}),
+              drain(&it));
+
+    ASSERT_EQ(0, prefix_iter_seek(&it, table, 0xC0A80100, 32));
+    EXPECT_TRUE(drain(&it).empty());
+
+    EXPECT_EQ(-1, prefix_iter_seek(&it, table, 0x0A000001, 8));
+    EXPECT_EQ(-1, prefix_iter_seek(&it, table, 0x0A000000, 33));
+}
+
+// TC-ITER-4: Batches
+TEST_F(IterTest, Batches) {
+    for (unsigned int i = 0; i < 10; i++) {
+        prefix_table_add(table, 0x0A000000 | (i << 8), 24);
+    }
+
+    prefix_iter_t it;
+    prefix_iter_init(&it, table);
+
+    unsigned int bases[4];
+    char masks[4];
+    std::vector<unsigned int> seen;
+    size_t n;
+    while ((n = prefix_iter_next_batch(&it, bases, masks, 4)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_EQ(24, masks[i]);
+            seen.push_back(bases[i]);
+        }
+    }
+
+    ASSERT_EQ(10u, seen.size());
+    for (unsigned int i = 0; i < 10; i++) {
+        EXPECT_EQ(0x0A000000 | (i << 8), seen[i]);
+    }
+}
+
+// TC-ITER-5: Random table - full walk and seeks match a sorted reference
+TEST_F(IterTest, RandomTableMatchesReference) {
+    std::mt19937 rng(27);
+    std::set<Prefix> ref;
+
+    for (int i = 0; i < 5000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = rng() & (mask == 0 ? 0 : ~0U << (32 - mask));
+        prefix_table_add(table, base, static_cast<char>(mask));
+        ref.emplace(base, mask);
+    }
+    for (int i = 0; i < 1000; i++) {
+        auto it = ref.begin();
+        std::advance(it, rng() % ref.size());
+        prefix_table_del(table, it->first, static_cast<char>(it->second));
+        ref.erase(it);
+    }
+
+    prefix_iter_t it;
+    prefix_iter_init(&it, table);
+    EXPECT_EQ(std::vector<Prefix>(ref.begin(), ref.end()), drain(&it));
+
+    for (int i = 0; i < 200; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = rng() & (mask == 0 ? 0 : ~0U << (32 - mask));
+        ASSERT_EQ(0, prefix_iter_seek(&it, table, base,
+                                      static_cast<char>(mask)));
+        EXPECT_EQ(std::vector<Prefix>(ref.lower_bound(Prefix(base, mask)),
+                                      ref.end()),
+                  drain(&it));
+    }
+}
@@ -0,0 +1,194 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> contents(const prefix_table_t *table) {
+    std::vector<Prefix> out;
+    prefix_iter_t it;
+    unsigned int base;
+    char mask;
+    prefix_iter_init(&it, table);
+    while (prefix_iter_next(&it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+unsigned int random_base(std::mt19937 &rng, int mask) {
+    return rng() & (mask == 0 ? 0 : ~0U << (32 - mask));
+}
+
+const prefix_layout_t kLayouts[] = {PREFIX_LAYOUT_DFS, PREFIX_LAYOUT_BFS,
+                                    PREFIX_LAYOUT_VEB};
+
+} // namespace
+
+class LayoutTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ref = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+        ASSERT_NE(nullptr, ref);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(table);
+        prefix_table_destroy(ref);
+    }
+
+    // Applies the same random adds and deletes to both tables
+    void mutate(std::mt19937 &rng, int ops) {
+        for (int i = 0; i < ops; i++) {
+            int mask = static_cast<int>(rng() % 33);
+            unsigned int base = random_base(rng, mask);
+            if (rng() % 4 == 0) {
+                prefix_table_del(table, base, static_cast<char>(mask));
+                prefix_table_del(ref, base, static_cast<char>(mask));
+            } else {
+                prefix_table_add(table, base, static_cast<char>(mask));
+                prefix_table_add(ref, base, static_cast<char>(mask));
+            }
+        }
+    }
+
+    void expect_same(std::mt19937 &rng) {
+        EXPECT_EQ(contents(ref), contents(table));
+        for (int i = 0; i < 20000; i++) {
+            unsigned int ip = rng();
+            ASSERT_EQ(prefix_table_check(ref, ip),
+                      prefix_table_check(table, ip));
+        }
+    }
+
+    prefix_stats_t stats(const prefix_table_t *t) {
+        prefix_stats_t s;
+        EXPECT_EQ(0, prefix_table_stats(t, &s, PREFIX_STATS_DEPTH));
+        return s;
+    }
+
+    prefix_table_t *table = nullptr;
+    prefix_table_t *ref = nullptr;
+};
+
+// TC-LAYOUT-1: Invalid arguments
+TEST_F(LayoutTest, InvalidArguments) {
+    EXPECT_EQ(-1, prefix_table_relayout(nullptr, PREFIX_LAYOUT_VEB));
+    EXPECT_EQ(-1, prefix_table_relayout(table,
+                                        static_cast<prefix_layout_t>(9)));
+    EXPECT_EQ(-1, prefix_mgmt_relayout(PREFIX_LAYOUT_VEB));
+
+    // Empty table (root only)
+    EXPECT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_VEB));
+    EXPECT_EQ(-1, prefix_table_check(table, 0x0A000001));
+}
+
+// TC-LAYOUT-2: Every layout keeps the table's contents and shape
+TEST_F(LayoutTest, SameResults) {
+    std::mt19937 rng(38);
+    mutate(rng, 20000);
+    prefix_stats_t before = stats(table);
+
+    for (prefix_layout_t layout : kLayouts) {
+        ASSERT_EQ(0, prefix_table_relayout(table, layout));
+        expect_same(rng);
+
+        prefix_stats_t after = stats(table);
+        EXPECT_EQ(before.nodes, after.nodes);
+        EXPECT_EQ(before.dead_nodes, after.dead_nodes);
+        EXPECT_EQ(before.max_depth, after.max_depth);
+        EXPECT_GE(after.node_bytes, after.nodes * sizeof(void *));
+    }
+}
+
+// TC-LAYOUT-3: Adds and deletes keep working after a relayout
+TEST_F(LayoutTest, ModifyAfterRelayout) {
+    // Arena table, so freed nodes go to both kinds of free list
+    prefix_table_opts_t opts = {};
+    opts.alloc = PREFIX_ALLOC_HUGEPAGE;
+    prefix_table_destroy(table);
+    table = prefix_table_create_ex(&opts);
+    ASSERT_NE(nullptr, table);
+
+    std::mt19937 rng(3);
+    mutate(rng, 5000);
+    ASSERT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_VEB));
+
+    for (int round = 0; round < 3; round++) {
+        mutate(rng, 20000);
+        expect_same(rng);
+        ASSERT_EQ(0, prefix_table_relayout(table, kLayouts[round]));
+        expect_same(rng);
+    }
+
+    // Delete everything, nodes inside and outside the buffer alike
+    for (const Prefix &p : contents(ref)) {
+        ASSERT_EQ(0, prefix_table_del(table, p.first,
+                                      static_cast<char>(p.second)));
+    }
+    EXPECT_TRUE(contents(table).empty());
+    EXPECT_EQ(0u, stats(table).prefixes);
+}
+
+// TC-LAYOUT-4: Aggregation into and from a re-laid-out table
+TEST_F(LayoutTest, Aggregate) {
+    prefix_table_add(table, 0x0A000000, 9);
+    prefix_table_add(table, 0x0A800000, 9);
+    ASSERT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_BFS));
+    ASSERT_EQ(0, prefix_table_aggregate(table, ref, PREFIX_AGGREGATE_MATCH,
+                                        nullptr));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}), contents(ref));
+
+    ASSERT_EQ(0, prefix_table_aggregate(ref, table, PREFIX_AGGREGATE_EXACT,
+                                        nullptr));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}), contents(table));
+}
+
+// TC-LAYOUT-5: Global table
+TEST(LayoutGlobalTest, Global) {
+    ASSERT_EQ(0, prefix_mgmt_init());
+    EXPECT_EQ(0, add(0xC0A80100, 24));
+    EXPECT_EQ(0, add(0xC0A80000, 16));
+    EXPECT_EQ(0, prefix_mgmt_relayout(PREFIX_LAYOUT_VEB));
+    EXPECT_EQ(24, check(0xC0A80101));
+    EXPECT_EQ(16, check(0xC0A80201));
+    EXPECT_EQ(0, del(0xC0A80100, 24));
+    EXPECT_EQ(16, check(0xC0A80101));
+    prefix_mgmt_cleanup();
+}
+
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+
+namespace {
+
+void collect(unsigned int base, char mask, uint64_t hits, void *ctx) {
+    (*static_cast<std::map<Prefix, uint64_t> *>(ctx))[{base, mask}] = hits;
+}
+
+} // namespace
+
+// TC-LAYOUT-6: Hit counters move with the nodes
+TEST_F(LayoutTest, KeepsHits) {
+    prefix_table_add(table, 0x0A000000, 8);
+    prefix_table_add(table, 0x0A140000, 16);
+    for (int i = 0; i < 3; i++) {
+        prefix_table_check(table, 0x0A140001);
+    }
+    ASSERT_EQ(0, prefix_table_relayout(table, PREFIX_LAYOUT_VEB));
+    prefix_table_check(table, 0x0A010101);
+
+    std::map<Prefix, uint64_t> h;
+    ASSERT_LE(0, prefix_table_hits(table, collect, &h));
+    EXPECT_EQ(1u, (h[{0x0A000000, 8}]));
+    EXPECT_EQ(3u, (h[{0x0A140000, 16}]));
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+class ProfileTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ref = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+        ASSERT_NE(nullptr, ref);
+
+        // Same random content in both tables
+        std::mt19937 rng(39);
+        for (int i = 0; i < 10000; i++) {
+            int mask = 8 + static_cast<int>(rng() % 25);
+            unsigned int base = rng() & (~0U << (32 - mask));
+            prefix_table_add(table, base, static_cast<char>(mask));
+            prefix_table_add(ref, base, static_cast<char>(mask));
+        }
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(table);
+        prefix_table_destroy(ref);
+    }
+
+    prefix_table_t *table = nullptr;
+    prefix_table_t *ref = nullptr;
+};
+
+// TC-PROF-1: Invalid arguments
+TEST_F(ProfileTest, InvalidArguments) {
+    prefix_reorder_report_t r;
+    EXPECT_EQ(-1, prefix_table_reorder(table, &r)); // not started
+    EXPECT_EQ(-1, prefix_table_reorder(nullptr, &r));
+    EXPECT_EQ(-1, prefix_table_profile_start(nullptr, 1, 10));
+    EXPECT_EQ(-1, prefix_table_profile_start(table, 0, 10));
+    EXPECT_EQ(-1, prefix_table_profile_start(table, 1, 0));
+    EXPECT_EQ(-1, prefix_table_profile_stop(nullptr));
+
+    ASSERT_EQ(0, prefix_table_profile_start(table, 1, 10));
+    ASSERT_EQ(0, prefix_table_profile_stop(table));
+    EXPECT_EQ(-1, prefix_table_reorder(table, &r));
+}
+
+// TC-PROF-2: Reordering keeps lookup results
+TEST_F(ProfileTest, SameResults) {
+    ASSERT_EQ(0, prefix_table_profile_start(table, 1, 4096));
+    std::mt19937 rng(2);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 5000; i++) {
+            prefix_table_check(table, rng() % 65536 << 16);
+        }
+        ASSERT_EQ(0, prefix_table_reorder(table, nullptr));
+        for (int i = 0; i < 20000; i++) {
+            unsigned int ip = rng();
+            ASSERT_EQ(prefix_table_check(ref, ip),
+                      prefix_table_check(table, ip));
+        }
+        prefix_table_add(table, 0xC0A80000 + round, 32);
+        prefix_table_add(ref, 0xC0A80000 + round, 32);
+    }
+    EXPECT_EQ(32, prefix_table_check(table, 0xC0A80002));
+}
+
+// TC-PROF-3: Hot paths are packed together
+TEST_F(ProfileTest, HotPathFirst) {
+    ASSERT_EQ(0, prefix_table_profile_start(table, 1, 100000));
+    std::mt19937 rng(3);
+    for (int i = 0; i < 10000; i++) {
+        // 90% of the traffic to 8 addresses
+        unsigned int ip = (rng() % 10 != 0) ? (rng() % 8) * 0x1F000000 : rng();
+        prefix_table_check(table, ip);
+    }
+
+    prefix_reorder_report_t r;
+    ASSERT_EQ(0, prefix_table_reorder(table, &r));
+    prefix_stats_t st;
+    ASSERT_EQ(0, prefix_table_stats(table, &st, 0));
+
+    EXPECT_EQ(10000u, r.samples);
+    EXPECT_LE(r.hot_nodes_50, r.hot_nodes_90);
+    EXPECT_LE(r.hot_nodes_90, r.hot_nodes_99);
+    EXPECT_LE(r.hot_nodes_99, r.visited_nodes);
+    EXPECT_LT(r.visited_nodes, st.nodes);
+    EXPECT_LT(r.hot_nodes_90, r.visited_nodes / 2);
+
+    EXPECT_LE(r.lines_after, r.lines_before);
+    EXPECT_LE(r.pages_after, r.pages_before);
+    EXPECT_LT(r.pages_after, 1.5);
+    EXPECT_GT(r.ns_before, 0.0);
+}
+
+// TC-PROF-4: Sampling period and ring size
+TEST_F(ProfileTest, Sampling) {
+    ASSERT_EQ(0, prefix_table_profile_start(table, 10, 1000));
+    for (int i = 0; i < 1000; i++) {
+        prefix_table_check(table, static_cast<unsigned int>(i));
+    }
+    prefix_reorder_report_t r;
+    ASSERT_EQ(0, prefix_table_reorder(table, &r));
+    EXPECT_EQ(100u, r.samples);
+
+    // Samples are cleared by a reorder
+    ASSERT_EQ(0, prefix_table_reorder(table, &r));
+    EXPECT_EQ(0u, r.samples);
+    EXPECT_EQ(0u, r.visited_nodes);
+
+    // The ring keeps the newest addresses only
+    ASSERT_EQ(0, prefix_table_profile_start(table, 1, 50));
+    for (int i = 0; i < 1000; i++) {
+        prefix_table_check(table, static_cast<unsigned int>(i));
+    }
+    ASSERT_EQ(0, prefix_table_reorder(table, &r));
+    EXPECT_EQ(50u, r.samples);
+}
+
+// TC-PROF-5: Global table
+TEST(ProfileGlobalTest, Global) {
+    EXPECT_EQ(-1, prefix_mgmt_profile_start(1, 100));
+    ASSERT_EQ(0, prefix_mgmt_init());
+    EXPECT_EQ(0, add(0x0A000000, 8));
+    EXPECT_EQ(0, add(0x0A010000, 16));
+    ASSERT_EQ(0, prefix_mgmt_profile_start(1, 100));
+    for (int i = 0; i < 20; i++) {
+        check(0x0A010203);
+    }
+
+    prefix_reorder_report_t r;
+    ASSERT_EQ(0, prefix_mgmt_reorder(&r));
+    EXPECT_EQ(20u, r.samples);
+    EXPECT_EQ(16, check(0x0A010203));
+    EXPECT_EQ(8, check(0x0A020203));
+    EXPECT_EQ(0, prefix_mgmt_profile_stop());
+    EXPECT_EQ(-1, prefix_mgmt_reorder(&r));
+    prefix_mgmt_cleanup();
+}
@@ -0,0 +1,298 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+void collect(unsigned int base, char mask, void *ctx) {
+    static_cast<std::vector<Prefix> *>(ctx)->emplace_back(base, mask);
+}
+
+unsigned int mask_bits(int mask) { return mask == 0 ? 0 : ~0U << (32 - mask); }
+
+struct Segment {
+    unsigned int first;
+    unsigned int last;
+    int mask;
+};
+
+void collect_segment(unsigned int first, unsigned int last, char mask,
+                     void *ctx) {
+    static_cast<std::vector<Segment> *>(ctx)->push_back({first, last, mask});
+}
+
+} // namespace
+
+class QueryTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        prefix_mgmt_init();
+        for (const Prefix &p : stored) {
+            add(p.first, static_cast<char>(p.second));
+        }
+    }
+
+    void TearDown() override { prefix_mgmt_cleanup(); }
+
+    std::vector<Prefix> covered(unsigned int base, char mask) {
+        std::vector<Prefix> out;
+        EXPECT_EQ(static_cast<int>(find_covered(base, mask, nullptr, nullptr)),
+                  find_covered(base, mask, collect, &out));
+        return out;
+    }
+
+    std::vector<Prefix> covering(unsigned int base, char mask) {
+        std::vector<Prefix> out;
+        EXPECT_EQ(static_cast<int>(find_covering(base, mask, nullptr, nullptr)),
+                  find_covering(base, mask, collect, &out));
+        return out;
+    }
+
+    const std::vector<Prefix> stored = {
+        {0x0A000000, 8},  // 10.0.0.0/8
+        {0x0A140000, 16}, // 10.20.0.0/16
+        {0x0A141E00, 24}, // 10.20.30.0/24
+        {0x0A141F00, 24}, // 10.20.31.0/24
+        {0x0B000000, 8},  // 11.0.0.0/8
+        {0xC0A80100, 24}, // 192.168.1.0/24
+    };
+};
+
+// TC-QRY-1: Prefixes inside 10.0.0.0/8
+TEST_F(QueryTest, CoveredBySlash8) {
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8},
+                                   {0x0A140000, 16},
+                                   {0x0A141E00, 24},
+                                   {0x0A141F00, 24}}),
+              covered(0x0A000000, 8));
+}
+
+// TC-QRY-2: Covered query on a prefix that is not stored
+TEST_F(QueryTest, CoveredByUnstoredPrefix) {
+    // 10.20.30.0/23 contains both /24s but not the /16
+    EXPECT_EQ((std::vector<Prefix>{{0x0A141E00, 24}, {0x0A141F00, 24}}),
+              covered(0x0A141E00, 23));
+    // 10.0.0.0/7 contains 10/8 subtree and 11/8
+    EXPECT_EQ(5u, covered(0x0A000000, 7).size());
+    EXPECT_TRUE(covered(0xC0A80200, 23).empty());
+    EXPECT_TRUE(covered(0x0A141E80, 25).empty());
+    EXPECT_EQ(6u, covered(0, 0).size());
+}
+
+// TC-QRY-3: Prefixes covering 10.20.30.0/24
+TEST_F(QueryTest, CoveringSlash24) {
+    EXPECT_EQ((std::vector<Prefix>{
+                  {0x0A000000, 8}, {0x0A140000, 16}, {0x0A141E00, 24}}),
+              covering(0x0A141E00, 24));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}, {0x0A140000, 16}}),
+              covering(0x0A140000, 20));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}),
+              covering(0x0A000000, 8));
+    EXPECT_TRUE(covering(0x0C000000, 8).empty());
+}
+
+// TC-QRY-4: Invalid arguments and missing table
+TEST_F(QueryTest, InvalidArguments) {
+    EXPECT_EQ(-1, find_covered(0x0A000001, 8, nullptr, nullptr));
+    EXPECT_EQ(-1, find_covering(0x0A000000, 33, nullptr, nullptr));
+
+    prefix_mgmt_cleanup();
+    EXPECT_EQ(-1, find_covered(0x0A000000, 8, nullptr, nullptr));
+    EXPECT_EQ(-1, find_covering(0x0A000000, 8, nullptr, nullptr));
+}
+
+// TC-QRY-5: Random table - both queries match a brute-force reference
+TEST_F(QueryTest, RandomTableMatchesReference) {
+    std::mt19937 rng(29);
+    std::set<Prefix> ref(stored.begin(), stored.end());
+
+    for (int i = 0; i < 3000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = (0x0A000000 | (rng() & 0x00FFFFFF)) &
+                            mask_bits(mask);
+        add(base, static_cast<char>(mask));
+        ref.emplace(base, mask);
+    }
+
+    for (int i = 0; i < 300; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = (0x0A000000 | (rng() & 0x00FFFFFF)) &
+                            mask_bits(mask);
+
+        std::vector<Prefix> inside, outside;
+        for (const Prefix &p : ref) {
+            if (p.second >= mask && (p.first & mask_bits(mask)) == base) {
+                inside.push_back(p);
+            }
+            if (p.second <= mask &&
+                (base & mask_bits(p.second)) == p.first) {
+                outside.push_back(p);
+            }
+        }
+
+        EXPECT_EQ(inside, covered(base, static_cast<char>(mask)));
+        EXPECT_EQ(outside, covering(base, static_cast<char>(mask)));
+    }
+}
+
+// TC-QRY-6: All containing prefixes of an address
+TEST_F(QueryTest, CheckAll) {
+    add(0x00000000, 0);
+    char masks[33];
+
+    ASSERT_EQ(4, check_all(0x0A141E05, masks, 33)); // 10.20.30.5
+    EXPECT_EQ(0, masks[0]);
+    EXPECT_EQ(8, masks[1]);
+    EXPECT_EQ(16, masks[2]);
+    EXPECT_EQ(24, masks[3]);
+
+    ASSERT_EQ(2, check_all(0x0A0A0A0A, masks, 33)); // 10.10.10.10
+    EXPECT_EQ(8, masks[1]);
+
+    ASSERT_EQ(1, check_all(0x08080808, masks, 33)); // 8.8.8.8
+    EXPECT_EQ(0, masks[0]);
+
+    del(0x00000000, 0);
+    EXPECT_EQ(0, check_all(0x08080808, masks, 33));
+}
+
+// TC-QRY-7: Truncated output still reports the full count
+TEST_F(QueryTest, CheckAllTruncated) {
+    char masks[2] = {-1, -1};
+    EXPECT_EQ(3, check_all(0x0A141E05, masks, 1));
+    EXPECT_EQ(8, masks[0]);
+    EXPECT_EQ(-1, masks[1]);
+    EXPECT_EQ(3, check_all(0x0A141E05, nullptr, 0));
+
+    EXPECT_EQ(-1, check_all(0x0A141E05, nullptr, 1));
+    EXPECT_EQ(-1, check_all(0x0A141E05, masks, -1));
+}
+
+// TC-QRY-8: Batched lookup agrees with check() and check_all()
+TEST_F(QueryTest, CheckAllBatch) {
+    std::mt19937 rng(30);
+    std::vector<unsigned int> ips;
+    for (int i = 0; i < 1000; i++) {
+        ips.push_back(0x0A000000 | (rng() & 0x01FFFFFF));
+    }
+
+    const int max = 33;
+    std::vector<char> masks(ips.size() * max);
+    std::vector<int> counts(ips.size());
+    ASSERT_EQ(0, check_all_batch(ips.data(), ips.size(), masks.data(), max,
+                                 counts.data()));
+
+    for (size_t i = 0; i < ips.size(); i++) {
+        char single[33];
+        ASSERT_EQ(check_all(ips[i], single, max), counts[i]);
+        for (int k = 0; k < counts[i]; k++) {
+            EXPECT_EQ(single[k], masks[i * max + k]);
+        }
+        EXPECT_EQ(check(ips[i]),
+                  counts[i] == 0 ? -1 : masks[i * max + counts[i] - 1]);
+    }
+
+    EXPECT_EQ(-1, check_all_batch(ips.data(), 1, masks.data(), max, nullptr));
+}
+
+// TC-QRY-9: Range segments on the sample table
+TEST_F(QueryTest, CheckRange) {
+    std::vector<Segment> segs;
+    prefix_range_report_t rep;
+    ASSERT_EQ(0, check_range(0x0A141D00, 0x0A141F0F, &rep, collect_segment,
+                             &segs));
+    ASSERT_FALSE(segs.empty());
+    EXPECT_EQ(segs.size(), rep.segments);
+    EXPECT_EQ(0x0A141D00u, segs.front().first);
+    EXPECT_EQ(0x0A141F0Fu, segs.back().last);
+    for (size_t i = 0; i < segs.size(); i++) {
+        if (i > 0) {
+            EXPECT_EQ(segs[i - 1].last + 1, segs[i].first);
+            EXPECT_NE(segs[i - 1].mask, segs[i].mask);
+        }
+        EXPECT_EQ(check(segs[i].first), segs[i].mask);
+        EXPECT_EQ(check(segs[i].last), segs[i].mask);
+    }
+
+    // The whole address space, with and without a /0
+    ASSERT_EQ(0, check_range(0, 0xFFFFFFFF, &rep, nullptr, nullptr));
+    EXPECT_FALSE(rep.covered);
+    EXPECT_EQ(8, rep.min_mask);
+    EXPECT_EQ(24, rep.max_mask);
+    ASSERT_EQ(0, add(0, 0));
+    ASSERT_EQ(0, check_range(0, 0xFFFFFFFF, &rep, nullptr, nullptr));
+    EXPECT_TRUE(rep.covered);
+    EXPECT_EQ(0, rep.min_mask);
+
+    // Single address
+    segs.clear();
+    ASSERT_EQ(0, check_range(0xFFFFFFFF, 0xFFFFFFFF, &rep, collect_segment,
+                             &segs));
+    ASSERT_EQ(1u, segs.size());
+    EXPECT_EQ(check(0xFFFFFFFF), segs[0].mask);
+    EXPECT_EQ(rep.min_mask, rep.max_mask);
+
+    EXPECT_EQ(-1, check_range(2, 1, &rep, nullptr, nullptr));
+    EXPECT_EQ(-1, prefix_table_check_range(nullptr, 0, 1, &rep, nullptr,
+                                           nullptr));
+}
+
+// TC-QRY-10: Random tables - segments match check() on every address
+TEST_F(QueryTest, CheckRangeMatchesCheck) {
+    std::mt19937 rng(49);
+    for (int round = 0; round < 20; round++) {
+        prefix_table_t *t = prefix_table_create();
+        ASSERT_NE(nullptr, t);
+        for (int i = 0; i < 200; i++) {
+            int mask = 16 + static_cast<int>(rng() % 17);
+            unsigned int ip = 0xC0A80000 | (rng() & 0x3FFF);
+            prefix_table_add(t, ip & mask_bits(mask), static_cast<char>(mask));
+        }
+        if (round % 4 == 0) {
+            prefix_table_add(t, 0xC0000000, 4);
+        }
+
+        unsigned int lo = 0xC0A7FF00 + (rng() & 0x3FFF);
+        unsigned int hi = lo + (rng() & 0x1FFF);
+        std::vector<Segment> segs;
+        prefix_range_report_t rep;
+        ASSERT_EQ(0, prefix_table_check_range(t, lo, hi, &rep,
+                                              collect_segment, &segs));
+        ASSERT_EQ(segs.size(), rep.segments);
+
+        bool covered = true;
+        int min_mask = -1, max_mask = -1;
+        unsigned int ip = lo;
+        for (size_t i = 0; i < segs.size(); i++) {
+            ASSERT_EQ(ip, segs[i].first);
+            ASSERT_LE(segs[i].first, segs[i].last);
+            if (i > 0) {
+                ASSERT_NE(segs[i - 1].mask, segs[i].mask);
+            }
+            for (; ip != segs[i].last + 1; ip++) {
+                ASSERT_EQ(prefix_table_check(t, ip), segs[i].mask)
+                    << std::hex << ip;
+            }
+            if (segs[i].mask < 0) {
+                covered = false;
+            } else {
+                if (min_mask < 0 || segs[i].mask < min_mask) {
+                    min_mask = segs[i].mask;
+                }
+                max_mask = std::max(max_mask, segs[i].mask);
+            }
+        }
+        EXPECT_EQ(hi + 1, ip);
+        EXPECT_EQ(covered, rep.covered);
+        EXPECT_EQ(min_mask, rep.min_mask);
+        EXPECT_EQ(max_mask, rep.max_mask);
+        prefix_table_destroy(t);
+    }
+}
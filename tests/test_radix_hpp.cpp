@@ -0,0 +1,206 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt/radix.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using prefix_mgmt::Ipv4Key;
+using prefix_mgmt::RadixTree;
+
+using Tree4 = RadixTree<Ipv4Key>;
+
+static_assert(!std::is_copy_constructible<Tree4>::value, "copyable");
+static_assert(std::is_nothrow_move_constructible<Tree4>::value, "move");
+static_assert(std::is_nothrow_move_assignable<Tree4>::value, "move");
+
+// TC-RADIX-1: The IPv4 instance gives the same results as the C table
+TEST(RadixHppTest, Ipv4MatchesC) {
+    Tree4 tree;
+    prefix_table_t *table = prefix_table_create();
+    ASSERT_NE(nullptr, table);
+
+    std::mt19937 rng(45);
+    for (int i = 0; i < 20000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        Ipv4Key base = (mask == 0) ? 0 : rng() & (~0U << (32 - mask));
+        if (rng() % 50 == 0) {
+            base |= 1; // sometimes misaligned
+        }
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(prefix_table_del(table, base, static_cast<char>(mask)),
+                      tree.del(base, mask));
+        } else {
+            ASSERT_EQ(prefix_table_add(table, base, static_cast<char>(mask)),
+                      tree.add(base, mask));
+        }
+        Ipv4Key ip = rng();
+        ASSERT_EQ(prefix_table_check(table, ip), tree.check(ip));
+        ASSERT_EQ(prefix_table_check(table, base), tree.check(base));
+    }
+
+    prefix_stats_t st;
+    ASSERT_EQ(0, prefix_table_stats(table, &st, 0));
+    EXPECT_EQ(st.prefixes, tree.prefixes());
+    EXPECT_EQ(st.nodes, tree.nodes());
+
+    EXPECT_EQ(-1, tree.add(0, 33));
+    EXPECT_EQ(-1, tree.add(0, -1));
+    EXPECT_EQ(-1, tree.del(0x0A000001, 8));
+    prefix_table_destroy(table);
+}
+
+// TC-RADIX-2: Moves hand over the tree
+TEST(RadixHppTest, Move) {
+    Tree4 a;
+    a.add(0, 0);
+    a.add(0x0A000000, 8);
+
+    Tree4 b(std::move(a));
+    EXPECT_EQ(8, b.check(0x0A000001));
+    EXPECT_EQ(0, b.check(0x0B000001));
+    EXPECT_EQ(2u, b.prefixes());
+    EXPECT_EQ(0u, a.prefixes()); // NOLINT: moved-from state is specified
+    EXPECT_EQ(0u, a.nodes());    // NOLINT
+    EXPECT_EQ(-1, a.check(0x0A000001));
+
+    a.add(0xC0A80000, 16);
+    b = std::move(a);
+    EXPECT_EQ(16, b.check(0xC0A80101));
+    EXPECT_EQ(-1, b.check(0x0A000001));
+    EXPECT_EQ(2u, b.nodes());
+}
+
+#ifdef __SIZEOF_INT128__
+using prefix_mgmt::Ipv6Key;
+using prefix_mgmt::ipv6_key;
+
+using Tree6 = RadixTree<Ipv6Key>;
+
+/**
+ * @brief Longest match by scanning a prefix list.
+ */
+static int brute_check(const std::vector<std::pair<Ipv6Key, int>> &list,
+                       Ipv6Key ip) {
+    int best = -1;
+    for (const auto &p : list) {
+        Ipv6Key net = (p.second == 0) ? 0 : ip >> (128 - p.second);
+        Ipv6Key base = (p.second == 0) ? 0 : p.first >> (128 - p.second);
+        if (net == base && p.second > best) {
+            best = p.second;
+        }
+    }
+    return best;
+}
+
+// TC-RADIX-3: IPv6 boundaries and invalid arguments
+TEST(RadixHppTest, Ipv6Basic) {
+    Tree6 tree;
+    Ipv6Key doc = ipv6_key(0x20010DB800000000ULL, 0);
+    Ipv6Key host = ipv6_key(0x20010DB800000000ULL, 1);
+
+    EXPECT_EQ(-1, tree.check(host));
+    EXPECT_EQ(0, tree.add(doc, 32));
+    EXPECT_EQ(32, tree.check(host));
+    EXPECT_EQ(0, tree.add(host, 128));
+    EXPECT_EQ(128, tree.check(host));
+    EXPECT_EQ(32, tree.check(host + 1));
+    EXPECT_EQ(0, tree.add(0, 0));
+    EXPECT_EQ(0, tree.check(ipv6_key(~0ULL, ~0ULL)));
+
+    // Prefixes that differ only in the last 64 bits
+    EXPECT_EQ(0, tree.add(ipv6_key(0x20010DB800000000ULL, 1ULL << 63), 65));
+    EXPECT_EQ(65, tree.check(ipv6_key(0x20010DB800000000ULL, ~0ULL)));
+    EXPECT_EQ(128, tree.check(host));
+
+    EXPECT_EQ(-1, tree.add(host, 64));
+    EXPECT_EQ(-1, tree.add(doc, 129));
+    EXPECT_EQ(-1, tree.del(host, 127));
+    EXPECT_EQ(4u, tree.prefixes());
+
+    EXPECT_EQ(0, tree.del(host, 128));
+    EXPECT_EQ(32, tree.check(host));
+    EXPECT_EQ(0, tree.del(0, 0));
+    EXPECT_EQ(-1, tree.check(ipv6_key(~0ULL, ~0ULL)));
+    EXPECT_EQ(2u, tree.prefixes());
+}
+
+// TC-RADIX-4: IPv6 random operations against a linear scan
+TEST(RadixHppTest, Ipv6Random) {
+    Tree6 tree;
+    std::vector<std::pair<Ipv6Key, int>> list;
+    std::mt19937_64 rng(45);
+
+    auto random_key = [&rng] {
+        // Few distinct top bits, so prefixes nest and share paths
+        return ipv6_key(0x2001000000000000ULL | (rng() & 0x00FF00000000FFFFULL),
+                        rng());
+    };
+
+    for (int i = 0; i < 3000; i++) {
+        int mask = static_cast<int>(rng() % 129);
+        Ipv6Key base = random_key();
+        if (mask < 128) {
+            base &= ~((~Ipv6Key(0)) >> mask);
+        }
+        if (!list.empty() && rng() % 3 == 0) {
+            std::size_t pick = rng() % list.size();
+            ASSERT_EQ(0, tree.del(list[pick].first, list[pick].second));
+            list.erase(list.begin() + static_cast<std::ptrdiff_t>(pick));
+        } else {
+            ASSERT_EQ(0, tree.add(base, mask));
+            bool found = false;
+            for (const auto &p : list) {
+                found = found || (p.first == base && p.second == mask);
+            }
+            if (!found) {
+                list.emplace_back(base, mask);
+            }
+        }
+        ASSERT_EQ(list.size(), tree.prefixes());
+
+        Ipv6Key ip = random_key();
+        ASSERT_EQ(brute_check(list, ip), tree.check(ip));
+        ASSERT_EQ(brute_check(list, base), tree.check(base));
+    }
+}
+
+// TC-RADIX-5: The C IPv6 table behind RadixTree<Ipv6Key>
+TEST(RadixHppTest, Ipv6CTable) {
+    prefix6_table_t *t = prefix6_table_create();
+    ASSERT_NE(nullptr, t);
+    EXPECT_EQ(1u, prefix6_table_nodes(t));
+
+    prefix6_addr_t doc = {0x20010DB800000000ULL, 0};
+    prefix6_addr_t sub = {0x20010DB800010000ULL, 0};
+    prefix6_addr_t host = {0x20010DB800010000ULL, 1};
+    EXPECT_EQ(0, prefix6_table_add(t, doc, 32));
+    EXPECT_EQ(0, prefix6_table_add(t, sub, 48));
+    EXPECT_EQ(0, prefix6_table_add(t, host, 128));
+    EXPECT_EQ(128, prefix6_table_check(t, host));
+    EXPECT_EQ(48, prefix6_table_check(t, prefix6_addr_t{sub.hi, 2}));
+    EXPECT_EQ(32, prefix6_table_check(t, prefix6_addr_t{doc.hi, 2}));
+    EXPECT_EQ(3u, prefix6_table_prefixes(t));
+    EXPECT_EQ(4u, prefix6_table_nodes(t));
+
+    // Deleting the middle prefix merges its node with the /128 below
+    EXPECT_EQ(0, prefix6_table_del(t, sub, 48));
+    EXPECT_EQ(32, prefix6_table_check(t, prefix6_addr_t{sub.hi, 2}));
+    EXPECT_EQ(128, prefix6_table_check(t, host));
+    EXPECT_EQ(3u, prefix6_table_nodes(t));
+
+    EXPECT_EQ(-1, prefix6_table_add(t, host, 64));
+    EXPECT_EQ(-1, prefix6_table_add(t, doc, 129));
+    EXPECT_EQ(-1, prefix6_table_del(t, doc, -1));
+    EXPECT_EQ(-1, prefix6_table_add(nullptr, doc, 32));
+    EXPECT_EQ(-1, prefix6_table_del(nullptr, doc, 32));
+    EXPECT_EQ(-1, prefix6_table_check(nullptr, doc));
+    EXPECT_EQ(0u, prefix6_table_prefixes(nullptr));
+    EXPECT_EQ(0u, prefix6_table_nodes(nullptr));
+    prefix6_table_destroy(t);
+    prefix6_table_destroy(nullptr);
+}
+#endif
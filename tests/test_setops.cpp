@@ -0,0 +1,285 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+typedef std::pair<unsigned int, int> Prefix;
+
+std::vector<Prefix> contents(const prefix_table_t *table) {
+    std::vector<Prefix> out;
+    prefix_iter_t it;
+    unsigned int base;
+    char mask;
+    prefix_iter_init(&it, table);
+    while (prefix_iter_next(&it, &base, &mask)) {
+        out.emplace_back(base, mask);
+    }
+    return out;
+}
+
+unsigned int net(int mask) { return mask == 0 ? 0 : ~0U << (32 - mask); }
+
+// Prefixes crowded into 10.0.0.0/12 so the two tables overlap a lot
+Prefix random_prefix(std::mt19937 &rng) {
+    int mask = static_cast<int>(rng() % 29) + 4;
+    unsigned int base = (0x0A000000 | (rng() & 0x000FFFFF)) & net(mask);
+    if (rng() % 16 == 0) {
+        mask = static_cast<int>(rng() % 12);
+        base &= net(mask);
+    }
+    return {base, mask};
+}
+
+// Random adds and deletes, leaving dead nodes behind
+void fill(prefix_table_t *table, std::mt19937 &rng, int ops) {
+    std::vector<Prefix> added;
+    for (int i = 0; i < ops; i++) {
+        if (!added.empty() && rng() % 4 == 0) {
+            const Prefix &p = added[rng() % added.size()];
+            prefix_table_del(table, p.first, static_cast<char>(p.second));
+        } else {
+            Prefix p = random_prefix(rng);
+            prefix_table_add(table, p.first, static_cast<char>(p.second));
+            added.push_back(p);
+        }
+    }
+}
+
+bool set_op(prefix_set_op_t op, bool in_a, bool in_b) {
+    switch (op) {
+    case PREFIX_SET_UNION:
+        return in_a || in_b;
+    case PREFIX_SET_INTERSECT:
+        return in_a && in_b;
+    default:
+        return in_a && !in_b;
+    }
+}
+
+const prefix_set_op_t kOps[] = {PREFIX_SET_UNION, PREFIX_SET_INTERSECT,
+                                PREFIX_SET_DIFF};
+
+} // namespace
+
+class SetOpsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        a = prefix_table_create();
+        b = prefix_table_create();
+        out = prefix_table_create();
+        ASSERT_NE(nullptr, a);
+        ASSERT_NE(nullptr, b);
+        ASSERT_NE(nullptr, out);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(a);
+        prefix_table_destroy(b);
+        prefix_table_destroy(out);
+    }
+
+    void add(prefix_table_t *t, std::vector<Prefix> prefixes) {
+        for (const Prefix &p : prefixes) {
+            ASSERT_EQ(0, prefix_table_add(t, p.first,
+                                          static_cast<char>(p.second)));
+        }
+    }
+
+    std::vector<Prefix> combine(prefix_set_op_t op, prefix_set_mode_t mode) {
+        EXPECT_EQ(0, prefix_table_combine(a, b, out, op, mode));
+        return contents(out);
+    }
+
+    // The result has no dead nodes and its counters match its contents
+    void expect_tidy() {
+        prefix_stats_t s;
+        ASSERT_EQ(0, prefix_table_stats(out, &s, PREFIX_STATS_DEPTH));
+        EXPECT_EQ(0u, s.dead_nodes);
+        EXPECT_EQ(contents(out).size(), s.prefixes);
+    }
+
+    prefix_table_t *a = nullptr;
+    prefix_table_t *b = nullptr;
+    prefix_table_t *out = nullptr;
+};
+
+// TC-SET-1: Invalid arguments
+TEST_F(SetOpsTest, InvalidArguments) {
+    add(out, {{0x0A000000, 8}});
+    EXPECT_EQ(-1, prefix_table_combine(nullptr, b, out, PREFIX_SET_UNION,
+                                       PREFIX_SET_PREFIXES));
+    EXPECT_EQ(-1, prefix_table_combine(a, nullptr, out, PREFIX_SET_UNION,
+                                       PREFIX_SET_PREFIXES));
+    EXPECT_EQ(-1, prefix_table_combine(a, b, nullptr, PREFIX_SET_UNION,
+                                       PREFIX_SET_PREFIXES));
+    EXPECT_EQ(-1, prefix_table_combine(a, b, out,
+                                       static_cast<prefix_set_op_t>(3),
+                                       PREFIX_SET_PREFIXES));
+    EXPECT_EQ(-1, prefix_table_combine(a, b, out, PREFIX_SET_UNION,
+                                       static_cast<prefix_set_mode_t>(2)));
+
+    // Failed calls leave dst alone
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}), contents(out));
+
+    // Empty operands give an empty result
+    EXPECT_TRUE(combine(PREFIX_SET_UNION, PREFIX_SET_ADDRESSES).empty());
+}
+
+// TC-SET-2: Prefix sets
+TEST_F(SetOpsTest, Prefixes) {
+    add(a, {{0, 0}, {0x0A000000, 8}, {0x0A010000, 16}, {0xC0A80000, 16}});
+    add(b, {{0x0A000000, 8}, {0x0A010100, 24}, {0xC0A80000, 24}});
+
+    EXPECT_EQ((std::vector<Prefix>{{0, 0},
+                                   {0x0A000000, 8},
+                                   {0x0A010000, 16},
+                                   {0x0A010100, 24},
+                                   {0xC0A80000, 16},
+                                   {0xC0A80000, 24}}),
+              combine(PREFIX_SET_UNION, PREFIX_SET_PREFIXES));
+    expect_tidy();
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}),
+              combine(PREFIX_SET_INTERSECT, PREFIX_SET_PREFIXES));
+    expect_tidy();
+    EXPECT_EQ(
+        (std::vector<Prefix>{{0, 0}, {0x0A010000, 16}, {0xC0A80000, 16}}),
+        combine(PREFIX_SET_DIFF, PREFIX_SET_PREFIXES));
+    expect_tidy();
+}
+
+// TC-SET-3: Address sets
+TEST_F(SetOpsTest, Addresses) {
+    add(a, {{0x0A000000, 8}, {0x0A010000, 16}});
+    add(b, {{0x0A000000, 9}, {0x0A800000, 10}});
+
+    // 10.0/9 + 10.128/10 + 10.192/10 = 10/8
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}),
+              combine(PREFIX_SET_UNION, PREFIX_SET_ADDRESSES));
+    expect_tidy();
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 9}, {0x0A800000, 10}}),
+              combine(PREFIX_SET_INTERSECT, PREFIX_SET_ADDRESSES));
+    expect_tidy();
+    EXPECT_EQ((std::vector<Prefix>{{0x0AC00000, 10}}),
+              combine(PREFIX_SET_DIFF, PREFIX_SET_ADDRESSES));
+    expect_tidy();
+
+    // Everything minus one /32: one prefix per bit of its address
+    prefix_table_t *all = prefix_table_create();
+    prefix_table_t *host = prefix_table_create();
+    ASSERT_NE(nullptr, all);
+    ASSERT_NE(nullptr, host);
+    add(all, {{0, 0}});
+    add(host, {{0xC0A80101, 32}});
+    ASSERT_EQ(0, prefix_table_combine(all, host, out, PREFIX_SET_DIFF,
+                                      PREFIX_SET_ADDRESSES));
+    prefix_table_destroy(all);
+    prefix_table_destroy(host);
+    EXPECT_EQ(32u, contents(out).size());
+    EXPECT_EQ(1, prefix_table_check(out, 0x0A000001));
+    EXPECT_EQ(-1, prefix_table_check(out, 0xC0A80101));
+    EXPECT_EQ(32, prefix_table_check(out, 0xC0A80100));
+    EXPECT_EQ(2, prefix_table_check(out, 0x80000001));
+    expect_tidy();
+}
+
+// TC-SET-4: Random prefix sets against std::set_* on the contents
+TEST_F(SetOpsTest, RandomPrefixes) {
+    std::mt19937 rng(42);
+    for (int round = 0; round < 20; round++) {
+        prefix_table_destroy(a);
+        prefix_table_destroy(b);
+        a = prefix_table_create();
+        b = prefix_table_create();
+        fill(a, rng, 400);
+        fill(b, rng, 400);
+        std::vector<Prefix> ca = contents(a);
+        std::vector<Prefix> cb = contents(b);
+
+        std::vector<Prefix> expected;
+        std::set_union(ca.begin(), ca.end(), cb.begin(), cb.end(),
+                       std::back_inserter(expected));
+        ASSERT_EQ(expected, combine(PREFIX_SET_UNION, PREFIX_SET_PREFIXES));
+        expect_tidy();
+
+        expected.clear();
+        std::set_intersection(ca.begin(), ca.end(), cb.begin(), cb.end(),
+                              std::back_inserter(expected));
+        ASSERT_EQ(expected,
+                  combine(PREFIX_SET_INTERSECT, PREFIX_SET_PREFIXES));
+        expect_tidy();
+
+        expected.clear();
+        std::set_difference(ca.begin(), ca.end(), cb.begin(), cb.end(),
+                            std::back_inserter(expected));
+        ASSERT_EQ(expected, combine(PREFIX_SET_DIFF, PREFIX_SET_PREFIXES));
+        expect_tidy();
+    }
+}
+
+// TC-SET-5: Random address sets against check() on both operands
+TEST_F(SetOpsTest, RandomAddresses) {
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20; round++) {
+        prefix_table_destroy(a);
+        prefix_table_destroy(b);
+        a = prefix_table_create();
+        b = prefix_table_create();
+        fill(a, rng, 300);
+        fill(b, rng, 300);
+
+        // First and last address of every prefix, plus random ones
+        std::vector<unsigned int> ips;
+        for (const prefix_table_t *t : {a, b}) {
+            for (const Prefix &p : contents(t)) {
+                ips.push_back(p.first);
+                ips.push_back(p.first | ~net(p.second));
+                ips.push_back(p.first - 1);
+                ips.push_back((p.first | ~net(p.second)) + 1);
+            }
+        }
+        for (int i = 0; i < 2000; i++) {
+            ips.push_back(0x0A000000 | (rng() & 0x000FFFFF));
+        }
+
+        for (prefix_set_op_t op : kOps) {
+            ASSERT_EQ(0, prefix_table_combine(a, b, out, op,
+                                              PREFIX_SET_ADDRESSES));
+            expect_tidy();
+            for (unsigned int ip : ips) {
+                bool expected = set_op(op, prefix_table_check(a, ip) >= 0,
+                                       prefix_table_check(b, ip) >= 0);
+                ASSERT_EQ(expected, prefix_table_check(out, ip) >= 0)
+                    << "op " << op << " ip " << std::hex << ip;
+            }
+
+            // Already the minimal prefix set
+            std::vector<Prefix> before = contents(out);
+            ASSERT_EQ(0, prefix_table_aggregate(out, out,
+                                                PREFIX_AGGREGATE_MATCH,
+                                                nullptr));
+            EXPECT_EQ(before, contents(out));
+        }
+    }
+}
+
+// TC-SET-6: Result written over an operand
+TEST_F(SetOpsTest, InPlace) {
+    add(a, {{0x0A000000, 8}, {0xC0A80000, 16}});
+    add(b, {{0xC0A80000, 16}, {0xAC100000, 12}});
+
+    ASSERT_EQ(0, prefix_table_combine(a, b, a, PREFIX_SET_UNION,
+                                      PREFIX_SET_PREFIXES));
+    EXPECT_EQ((std::vector<Prefix>{
+                  {0x0A000000, 8}, {0xAC100000, 12}, {0xC0A80000, 16}}),
+              contents(a));
+    ASSERT_EQ(0, prefix_table_combine(a, b, b, PREFIX_SET_DIFF,
+                                      PREFIX_SET_ADDRESSES));
+    EXPECT_EQ((std::vector<Prefix>{{0x0A000000, 8}}), contents(b));
+    EXPECT_EQ(8, prefix_table_check(b, 0x0A010101));
+}
@@ -0,0 +1,124 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include "prefix_mgmt/static_table.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using prefix_mgmt::StaticPrefix;
+using prefix_mgmt::StaticTable;
+
+namespace {
+
+// Full IPv4 bogon list plus a few more specifics inside it
+constexpr StaticPrefix kBogons[] = {
+    {0x00000000, 8},  {0x0A000000, 8},  {0x64400000, 10}, {0x7F000000, 8},
+    {0xA9FE0000, 16}, {0xAC100000, 12}, {0xC0000000, 24}, {0xC0000200, 24},
+    {0xC0A80000, 16}, {0xC6120000, 15}, {0xC6336400, 24}, {0xCB007100, 24},
+    {0xE0000000, 4},  {0xF0000000, 4},  {0xFFFFFFFF, 32}, {0x0A0A0000, 16},
+    {0xC0A80100, 24}, {0xC0A80101, 32},
+};
+
+constexpr StaticTable kBogonTable(kBogons);
+
+// Evaluated by the compiler
+static_assert(kBogonTable.valid(), "bogon list rejected");
+static_assert(kBogonTable.check(0x08080808) == -1, "8.8.8.8 is public");
+static_assert(kBogonTable.check(0x0A010101) == 8, "10/8");
+static_assert(kBogonTable.check(0x0A0A0101) == 16, "10.10/16");
+static_assert(kBogonTable.check(0xC0A80101) == 32, "192.168.1.1/32");
+static_assert(kBogonTable.check(0xFFFFFFFF) == 32, "broadcast");
+static_assert(kBogonTable.check(0xFFFFFFFE) == 4, "240/4");
+
+struct RandomList {
+    StaticPrefix p[300];
+};
+
+// Overlapping prefixes from a small LCG, built at compile time
+constexpr RandomList make_random_list() {
+    RandomList list{};
+    std::uint32_t x = 12345;
+    for (StaticPrefix &p : list.p) {
+        x = x * 1664525U + 1013904223U;
+        int mask = static_cast<int>((x >> 8) % 33);
+        x = x * 1664525U + 1013904223U;
+        std::uint32_t base = 0xC0000000U | (x >> 4);
+        p.base = (mask == 0) ? 0 : base & (0xFFFFFFFFU << (32 - mask));
+        p.mask = mask;
+    }
+    return list;
+}
+
+constexpr RandomList kRandomList = make_random_list();
+constexpr StaticTable<300> kRandomTable(kRandomList.p);
+
+template <std::size_t N>
+prefix_table_t *runtime_table(const StaticPrefix (&prefixes)[N]) {
+    prefix_table_t *table = prefix_table_create();
+    for (const StaticPrefix &p : prefixes) {
+        prefix_table_add(table, p.base, static_cast<char>(p.mask));
+    }
+    return table;
+}
+
+// Every prefix boundary and its neighbours, plus random addresses
+template <std::size_t N>
+void expect_same(const StaticTable<N> &st, const StaticPrefix (&prefixes)[N],
+                 const prefix_table_t *table) {
+    std::vector<std::uint32_t> ips;
+    for (const StaticPrefix &p : prefixes) {
+        std::uint32_t last =
+            p.base | ((p.mask == 0) ? 0xFFFFFFFFU : ~(~0U << (32 - p.mask)));
+        for (std::uint32_t ip : {p.base, last}) {
+            ips.push_back(ip - 1);
+            ips.push_back(ip);
+            ips.push_back(ip + 1);
+        }
+    }
+    std::mt19937 rng(43);
+    for (int i = 0; i < 100000; i++) {
+        ips.push_back(rng());
+    }
+    for (std::uint32_t ip : ips) {
+        ASSERT_EQ(prefix_table_check(table, ip), st.check(ip))
+            << std::hex << ip;
+    }
+}
+
+} // namespace
+
+// TC-STATIC-1: Bogon list matches the runtime tree
+TEST(StaticTableTest, Bogons) {
+    prefix_table_t *table = runtime_table(kBogons);
+    ASSERT_NE(nullptr, table);
+    expect_same(kBogonTable, kBogons, table);
+    prefix_table_destroy(table);
+}
+
+// TC-STATIC-2: Random overlapping list matches the runtime tree
+TEST(StaticTableTest, RandomList) {
+    prefix_table_t *table = runtime_table(kRandomList.p);
+    ASSERT_NE(nullptr, table);
+    expect_same(kRandomTable, kRandomList.p, table);
+    EXPECT_LE(kRandomTable.ranges(), StaticTable<300>::kCapacity);
+    prefix_table_destroy(table);
+}
+
+// TC-STATIC-3: Edge cases
+TEST(StaticTableTest, EdgeCases) {
+    // Invalid prefixes are skipped as add() rejects them
+    constexpr StaticPrefix bad[] = {
+        {0x0A000001, 8}, {0x0A000000, 33}, {0x0A000000, -1}, {0xC0A80000, 16}};
+    constexpr StaticTable bad_table(bad);
+    static_assert(!bad_table.valid(), "invalid prefixes accepted");
+    EXPECT_EQ(-1, bad_table.check(0x0A000001));
+    EXPECT_EQ(16, bad_table.check(0xC0A80001));
+
+    // Default route and duplicates
+    constexpr StaticPrefix all[] = {{0, 0}, {0, 0}, {0x80000000, 1}};
+    constexpr StaticTable all_table(all);
+    EXPECT_EQ(0, all_table.check(0x00000001));
+    EXPECT_EQ(1, all_table.check(0xFFFFFFFF));
+    EXPECT_EQ(2u, all_table.ranges());
+}
@@ -0,0 +1,157 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+
+namespace {
+
+// Statistics recomputed from the tree itself
+void walk(const radix_node_t *node, const radix_node_t *root,
+          prefix_stats_t *s) {
+    if (node == nullptr) {
+        return;
+    }
+    s->nodes++;
+    if (node->is_prefix) {
+        s->prefixes++;
+        s->mask_count[static_cast<int>(node->mask)]++;
+    } else if (node != root &&
+               (node->left == nullptr || node->right == nullptr)) {
+        s->dead_nodes++;
+    }
+    walk(node->left, root, s);
+    walk(node->right, root, s);
+}
+
+} // namespace
+
+class StatsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override { prefix_table_destroy(table); }
+
+    prefix_stats_t stats(unsigned int flags = 0) {
+        prefix_stats_t s;
+        EXPECT_EQ(0, prefix_table_stats(table, &s, flags));
+        return s;
+    }
+
+    prefix_table_t *table = nullptr;
+};
+
+// TC-STAT-1: Empty table
+TEST_F(StatsTest, Empty) {
+    prefix_stats_t s = stats(PREFIX_STATS_DEPTH);
+    EXPECT_EQ(0u, s.prefixes);
+    EXPECT_EQ(1u, s.nodes);
+    EXPECT_EQ(1u, s.branch_nodes);
+    EXPECT_EQ(0u, s.dead_nodes);
+    EXPECT_GE(s.bytes, sizeof(radix_node_t));
+    EXPECT_EQ(-1, s.max_depth);
+    EXPECT_EQ(0.0, s.avg_depth);
+
+    EXPECT_EQ(-1, prefix_table_stats(nullptr, &s, 0));
+    EXPECT_EQ(-1, prefix_table_stats(table, nullptr, 0));
+}
+
+// TC-STAT-2: Prefix counts, mask histogram and depth
+TEST_F(StatsTest, CountsAndDepth) {
+    prefix_table_add(table, 0x00000000, 0);
+    prefix_table_add(table, 0x0A000000, 8);
+    prefix_table_add(table, 0x0A140000, 16);
+    prefix_table_add(table, 0x0A140100, 24);
+    prefix_table_add(table, 0x0A140100, 24); // duplicate
+
+    prefix_stats_t s = stats();
+    EXPECT_EQ(4u, s.prefixes);
+    EXPECT_EQ(4u, s.nodes);
+    EXPECT_EQ(0u, s.branch_nodes);
+    EXPECT_EQ(1u, s.mask_count[0]);
+    EXPECT_EQ(1u, s.mask_count[8]);
+    EXPECT_EQ(1u, s.mask_count[16]);
+    EXPECT_EQ(1u, s.mask_count[24]);
+    EXPECT_EQ(-1, s.max_depth); // not requested
+
+    s = stats(PREFIX_STATS_DEPTH);
+    EXPECT_EQ(3, s.max_depth);
+    EXPECT_DOUBLE_EQ(1.5, s.avg_depth);
+    for (int d = 0; d <= 3; d++) {
+        EXPECT_EQ(1u, s.depth_count[d]);
+    }
+
+    prefix_table_del(table, 0x0A140100, 24);
+    s = stats();
+    EXPECT_EQ(3u, s.prefixes);
+    EXPECT_EQ(3u, s.nodes);
+    EXPECT_EQ(0u, s.mask_count[24]);
+    EXPECT_GE(s.bytes, 3 * sizeof(radix_node_t));
+}
+
+// TC-STAT-3: Dead branch nodes appear on delete and disappear on reuse
+TEST_F(StatsTest, DeadNodes) {
+    prefix_table_add(table, 0x0A010000, 24); // 10.1.0.0/24
+    prefix_table_add(table, 0x0A020000, 24); // 10.2.0.0/24, split at /14
+    EXPECT_EQ(0u, stats().dead_nodes);
+    EXPECT_EQ(2u, stats().branch_nodes); // root and the split
+
+    prefix_table_del(table, 0x0A010000, 24);
+    EXPECT_EQ(1u, stats().dead_nodes);
+
+    prefix_table_add(table, 0x0A010000, 24); // split gets its child back
+    EXPECT_EQ(0u, stats().dead_nodes);
+
+    prefix_table_del(table, 0x0A010000, 24);
+    prefix_table_add(table, 0x0A000000, 14); // split becomes a prefix
+    EXPECT_EQ(0u, stats().dead_nodes);
+
+    prefix_table_del(table, 0x0A000000, 14); // merged with its one child
+    prefix_stats_t s = stats();
+    EXPECT_EQ(0u, s.dead_nodes);
+    EXPECT_EQ(2u, s.nodes);
+}
+
+// TC-STAT-4: Incremental counts match the tree after random changes
+TEST_F(StatsTest, RandomMatchesTree) {
+    std::mt19937 rng(33);
+    for (int i = 0; i < 4000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        // Few distinct values so deletes hit stored prefixes
+        unsigned int base = (rng() % 16) * 0x11111111u;
+        base &= mask == 0 ? 0 : ~0U << (32 - mask);
+        if (rng() % 3 == 0) {
+            prefix_table_del(table, base, static_cast<char>(mask));
+        } else {
+            prefix_table_add(table, base, static_cast<char>(mask));
+        }
+
+        prefix_stats_t expected;
+        std::memset(&expected, 0, sizeof(expected));
+        walk(prefix_table_root(table), prefix_table_root(table), &expected);
+
+        prefix_stats_t s = stats();
+        ASSERT_EQ(expected.nodes, s.nodes) << "step " << i;
+        ASSERT_EQ(expected.prefixes, s.prefixes) << "step " << i;
+        ASSERT_EQ(expected.dead_nodes, s.dead_nodes) << "step " << i;
+        ASSERT_EQ(0, std::memcmp(expected.mask_count, s.mask_count,
+                                 sizeof(s.mask_count)))
+            << "step " << i;
+    }
+}
+
+// TC-STAT-5: Global table
+TEST(StatsGlobalTest, GlobalTable) {
+    prefix_stats_t s;
+    ASSERT_EQ(0, prefix_mgmt_init());
+    add(0xC0A80100, 24);
+    ASSERT_EQ(0, prefix_mgmt_stats(&s, 0));
+    EXPECT_EQ(1u, s.prefixes);
+    EXPECT_EQ(2u, s.nodes);
+    prefix_mgmt_cleanup();
+
+    EXPECT_EQ(-1, prefix_mgmt_stats(&s, 0));
+}
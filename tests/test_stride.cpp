@@ -0,0 +1,128 @@
+#include "mirror_test.h"
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Compares one address of every /16 (and the given low bits).
+ */
+void sweep(const prefix_table_t *expected, const prefix_table_t *actual,
+           unsigned int low) {
+    for (unsigned int v = 0; v < 65536; v++) {
+        unsigned int ip = (v << 16) | (low & 0xFFFF);
+        ASSERT_EQ(prefix_table_check(expected, ip),
+                  prefix_table_check(actual, ip))
+            << std::hex << ip;
+    }
+}
+
+} // namespace
+
+class StrideTest : public MirrorTest {
+  protected:
+    // The other operand also carries the host set
+    StrideTest()
+        : MirrorTest(PREFIX_OPT_STRIDE16,
+                     PREFIX_OPT_STRIDE16 | PREFIX_OPT_HOST_HASH) {}
+};
+
+// TC-STRIDE-1: Splits and merges within the first 16 bits
+TEST_F(StrideTest, Basic) {
+    EXPECT_EQ(-1, prefix_table_check(table, 0x0A000001));
+    add_both(0x0A000000, 8);
+    EXPECT_EQ(8, prefix_table_check(table, 0x0A010001));
+    add_both(0x0A010000, 16);
+    EXPECT_EQ(16, prefix_table_check(table, 0x0A010001));
+    add_both(0x0A010100, 24);
+    EXPECT_EQ(24, prefix_table_check(table, 0x0A010101));
+
+    // Splits 10.0.0.0/8 - 10.1.0.0/16 at bit 12
+    add_both(0x0A100000, 12);
+    EXPECT_EQ(12, prefix_table_check(table, 0x0A1F0001));
+    EXPECT_EQ(16, prefix_table_check(table, 0x0A010001));
+    add_both(0x00000000, 0);
+    EXPECT_EQ(0, prefix_table_check(table, 0xC0A80001));
+    sweep(plain, table, 0x0101);
+
+    // Merges the /16 node with its only child
+    del_both(0x0A010000, 16);
+    EXPECT_EQ(8, prefix_table_check(table, 0x0A010001));
+    EXPECT_EQ(24, prefix_table_check(table, 0x0A010101));
+    del_both(0x0A000000, 8);
+    EXPECT_EQ(0, prefix_table_check(table, 0x0A020001));
+    del_both(0x00000000, 0);
+    EXPECT_EQ(-1, prefix_table_check(table, 0x0A020001));
+    sweep(plain, table, 0x0101);
+
+    del_covered_both(0x0A000000, 8);
+    EXPECT_EQ(-1, prefix_table_check(table, 0x0A010101));
+
+    // The index is counted in the table size
+    prefix_stats_t with, without;
+#ifdef PREFIX_MGMT_HIT_COUNTERS
+    // The flag is accepted but no index is built
+    prefix_table_t *empty_stride = create(PREFIX_OPT_STRIDE16);
+    prefix_table_t *empty = prefix_table_create();
+    ASSERT_EQ(0, prefix_table_stats(empty_stride, &with, 0));
+    ASSERT_EQ(0, prefix_table_stats(empty, &without, 0));
+    EXPECT_EQ(without.bytes, with.bytes);
+    prefix_table_destroy(empty_stride);
+    prefix_table_destroy(empty);
+#else
+    ASSERT_EQ(0, prefix_table_stats(table, &with, 0));
+    ASSERT_EQ(0, prefix_table_stats(plain, &without, 0));
+    EXPECT_GE(with.bytes, without.bytes + 65536 * 2);
+#endif
+}
+
+// TC-STRIDE-2: Random operations near the top of the tree
+TEST_F(StrideTest, SameResultsAsTree) {
+    std::mt19937 rng(47);
+    std::vector<std::pair<unsigned int, int>> stored;
+    for (int i = 0; i < 20000; i++) {
+        unsigned int r = rng() % 100;
+        // Clustered upper bits, so paths split and merge above bit 16
+        unsigned int ip = (rng() & 0x3C3FFFFF) | 0x81000000;
+        int mask = (rng() % 4 == 0) ? static_cast<int>(rng() % 33)
+                                    : 4 + static_cast<int>(rng() % 17);
+        if (r < 60) {
+            add_both(net(ip, mask), mask);
+            stored.emplace_back(net(ip, mask), mask);
+        } else if (r < 95 && !stored.empty()) {
+            std::size_t pick = rng() % stored.size();
+            del_both(stored[pick].first, stored[pick].second);
+        } else {
+            mask = 6 + static_cast<int>(rng() % 15);
+            del_covered_both(net(ip, mask), mask);
+        }
+
+        ASSERT_EQ(prefix_table_check(plain, ip),
+                  prefix_table_check(table, ip));
+        unsigned int other = rng();
+        ASSERT_EQ(prefix_table_check(plain, other),
+                  prefix_table_check(table, other));
+        if (i % 2000 == 0) {
+            sweep(plain, table, rng());
+        }
+    }
+    sweep(plain, table, rng());
+}
+
+// TC-STRIDE-3: Tables rebuilt or moved as a whole
+TEST_F(StrideTest, RebuiltTables) {
+    std::mt19937 rng(147);
+    auto gen = [&] {
+        unsigned int ip = (rng() & 0x3C3FFFFF) | 0x81000000;
+        int mask = 4 + static_cast<int>(rng() % 29);
+        return std::make_pair(net(ip, mask), mask);
+    };
+    rebuilt_tables(rng, 3000, gen,
+                   [&](const prefix_table_t *expected,
+                       const prefix_table_t *actual) {
+                       sweep(expected, actual, rng());
+                   });
+}
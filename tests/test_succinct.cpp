@@ -0,0 +1,107 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+class SuccinctTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        table = prefix_table_create();
+        ASSERT_NE(nullptr, table);
+    }
+
+    void TearDown() override {
+        prefix_succinct_destroy(s);
+        prefix_table_destroy(table);
+    }
+
+    void build() {
+        prefix_succinct_destroy(s);
+        s = prefix_succinct_build(table);
+        ASSERT_NE(nullptr, s);
+    }
+
+    prefix_table_t *table = nullptr;
+    prefix_succinct_t *s = nullptr;
+};
+
+// TC-SUCC-1: NULL and empty tables
+TEST_F(SuccinctTest, Empty) {
+    EXPECT_EQ(nullptr, prefix_succinct_build(nullptr));
+    EXPECT_EQ(-1, prefix_succinct_check(nullptr, 0));
+    EXPECT_EQ(0u, prefix_succinct_bytes(nullptr));
+    prefix_succinct_destroy(nullptr);
+
+    build();
+    EXPECT_EQ(-1, prefix_succinct_check(s, 0x0A000001));
+    EXPECT_EQ(0u, prefix_succinct_prefixes(s));
+    EXPECT_GT(prefix_succinct_bytes(s), 0u);
+
+    prefix_table_add(table, 0, 0);
+    build();
+    EXPECT_EQ(0, prefix_succinct_check(s, 0x0A000001));
+}
+
+// TC-SUCC-2: Nested prefixes and host routes
+TEST_F(SuccinctTest, Basic) {
+    prefix_table_add(table, 0x0A000000, 8);  // 10.0.0.0/8
+    prefix_table_add(table, 0x0A140000, 16); // 10.20.0.0/16
+    prefix_table_add(table, 0x0A140100, 24); // 10.20.1.0/24
+    prefix_table_add(table, 0x0A140101, 32); // 10.20.1.1/32
+    prefix_table_add(table, 0x80000000, 1);  // 128.0.0.0/1
+    build();
+
+    EXPECT_EQ(5u, prefix_succinct_prefixes(s));
+    EXPECT_EQ(32, prefix_succinct_check(s, 0x0A140101));
+    EXPECT_EQ(24, prefix_succinct_check(s, 0x0A140102));
+    EXPECT_EQ(16, prefix_succinct_check(s, 0x0A140201));
+    EXPECT_EQ(8, prefix_succinct_check(s, 0x0A150000));
+    EXPECT_EQ(1, prefix_succinct_check(s, 0xC0A80101));
+    EXPECT_EQ(-1, prefix_succinct_check(s, 0x0B000000));
+}
+
+// TC-SUCC-3: Random tables give the same results as the tree
+TEST_F(SuccinctTest, MatchesTree) {
+    std::mt19937 rng(40);
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 5000; i++) {
+            int mask = static_cast<int>(rng() % 33);
+            unsigned int base = rng() & (mask == 0 ? 0 : ~0U << (32 - mask));
+            // Deletes leave single-child branch nodes to be merged
+            if (rng() % 3 == 0) {
+                prefix_table_del(table, base, static_cast<char>(mask));
+            } else {
+                prefix_table_add(table, base, static_cast<char>(mask));
+            }
+        }
+        build();
+
+        prefix_stats_t st;
+        ASSERT_EQ(0, prefix_table_stats(table, &st, 0));
+        EXPECT_EQ(st.prefixes, prefix_succinct_prefixes(s));
+        for (int i = 0; i < 50000; i++) {
+            unsigned int ip = rng();
+            ASSERT_EQ(prefix_table_check(table, ip),
+                      prefix_succinct_check(s, ip))
+                << "ip " << std::hex << ip;
+        }
+    }
+}
+
+// TC-SUCC-4: Much smaller than the pointer tree
+TEST_F(SuccinctTest, Size) {
+    std::mt19937 rng(4);
+    for (int i = 0; i < 100000; i++) {
+        int mask = 16 + static_cast<int>(rng() % 9);
+        prefix_table_add(table, rng() & (~0U << (32 - mask)),
+                         static_cast<char>(mask));
+    }
+    build();
+
+    prefix_stats_t st;
+    ASSERT_EQ(0, prefix_table_stats(table, &st, 0));
+    double per_prefix = static_cast<double>(prefix_succinct_bytes(s)) /
+                        static_cast<double>(st.prefixes);
+    EXPECT_LT(per_prefix, 8.0);
+    EXPECT_LT(prefix_succinct_bytes(s) * 8, st.node_bytes);
+}
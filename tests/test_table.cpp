@@ -0,0 +1,144 @@
+#include "prefix_mgmt/prefix_mgmt.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+class TableTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        a = prefix_table_create();
+        b = prefix_table_create();
+        ASSERT_NE(nullptr, a);
+        ASSERT_NE(nullptr, b);
+    }
+
+    void TearDown() override {
+        prefix_table_destroy(a);
+        prefix_table_destroy(b);
+        prefix_mgmt_cleanup();
+    }
+
+    prefix_table_t *a = nullptr;
+    prefix_table_t *b = nullptr;
+};
+
+// TC-TBL-1: Tables are independent
+TEST_F(TableTest, TablesAreIndependent) {
+    EXPECT_EQ(0, prefix_table_add(a, 0x0A000000, 8)); // 10.0.0.0/8
+    EXPECT_EQ(0, prefix_table_add(b, 0x0A140000, 16)); // 10.20.0.0/16
+
+    EXPECT_EQ(8, prefix_table_check(a, 0x0A140001));
+    EXPECT_EQ(16, prefix_table_check(b, 0x0A140001));
+    EXPECT_EQ(-1, prefix_table_check(b, 0x0A000001));
+
+    EXPECT_EQ(0, prefix_table_del(a, 0x0A000000, 8));
+    EXPECT_EQ(-1, prefix_table_check(a, 0x0A140001));
+    EXPECT_EQ(16, prefix_table_check(b, 0x0A140001));
+}
+
+// TC-TBL-2: NULL table is rejected
+TEST_F(TableTest, NullTable) {
+    EXPECT_EQ(-1, prefix_table_add(nullptr, 0x0A000000, 8));
+    EXPECT_EQ(-1, prefix_table_del(nullptr, 0x0A000000, 8));
+    EXPECT_EQ(-1, prefix_table_check(nullptr, 0x0A000000));
+    EXPECT_EQ(nullptr, prefix_table_root(nullptr));
+    prefix_table_destroy(nullptr);
+}
+
+// TC-TBL-3: Invalid arguments are rejected
+TEST_F(TableTest, InvalidArguments) {
+    EXPECT_EQ(-1, prefix_table_add(a, 0x0A000000, 33));
+    EXPECT_EQ(-1, prefix_table_add(a, 0x0A000001, 8));
+    EXPECT_EQ(-1, prefix_table_del(a, 0x0A000000, -1));
+}
+
+// TC-TBL-4: Global API uses its own table
+TEST_F(TableTest, GlobalTable) {
+    EXPECT_EQ(nullptr, prefix_mgmt_table());
+
+    ASSERT_EQ(0, prefix_mgmt_init());
+    ASSERT_NE(nullptr, prefix_mgmt_table());
+    EXPECT_EQ(get_root_addr(), prefix_table_root(prefix_mgmt_table()));
+
+    EXPECT_EQ(0, add(0xC0A80000, 16));
+    EXPECT_EQ(16, prefix_table_check(prefix_mgmt_table(), 0xC0A80101));
+    EXPECT_EQ(-1, prefix_table_check(a, 0xC0A80101));
+
+    prefix_mgmt_cleanup();
+    EXPECT_EQ(nullptr, prefix_mgmt_table());
+}
+
+// TC-TBL-5: Batch lookups
+TEST_F(TableTest, CheckBatch) {
+    EXPECT_EQ(0, prefix_table_add(a, 0x0A000000, 8));
+    EXPECT_EQ(0, prefix_table_add(a, 0x0A140000, 16));
+
+    const unsigned int ips[] = {0x0A140001, 0x0A000001, 0x0B000001};
+    char masks[3] = {0, 0, 0};
+    ASSERT_EQ(0, prefix_table_check_batch(a, ips, 3, masks));
+    EXPECT_EQ(16, masks[0]);
+    EXPECT_EQ(8, masks[1]);
+    EXPECT_EQ(-1, masks[2]);
+
+    EXPECT_EQ(0, prefix_table_check_batch(a, nullptr, 0, nullptr));
+    EXPECT_EQ(-1, prefix_table_check_batch(nullptr, ips, 3, masks));
+    EXPECT_EQ(-1, prefix_table_check_batch(a, nullptr, 3, masks));
+    EXPECT_EQ(-1, prefix_table_check_batch(a, ips, 3, nullptr));
+
+    // Global table
+    EXPECT_EQ(-1, check_batch(ips, 3, masks));
+    ASSERT_EQ(0, prefix_mgmt_init());
+    EXPECT_EQ(0, add(0x0B000000, 8));
+    ASSERT_EQ(0, check_batch(ips, 3, masks));
+    EXPECT_EQ(-1, masks[0]);
+    EXPECT_EQ(8, masks[2]);
+}
+
+// TC-TBL-6: Sorted batch lookups
+TEST_F(TableTest, CheckSorted) {
+    std::mt19937 rng(48);
+    for (int i = 0; i < 3000; i++) {
+        int mask = static_cast<int>(rng() % 33);
+        unsigned int base = (mask == 0) ? 0 : rng() & (~0U << (32 - mask));
+        prefix_table_add(a, base, static_cast<char>(mask));
+    }
+    prefix_table_del(a, 0, 0);
+
+    std::vector<unsigned int> ips(20000);
+    for (unsigned int &ip : ips) {
+        ip = rng() >> (rng() % 8); // dense low ranges
+    }
+    ips.push_back(0);
+    ips.push_back(0xFFFFFFFF);
+    std::sort(ips.begin(), ips.end());
+    ips.push_back(0x0A000001); // out of order: still correct
+
+    std::vector<char> masks(ips.size());
+    ASSERT_EQ(0, prefix_table_check_sorted(a, ips.data(), ips.size(),
+                                           masks.data()));
+    for (std::size_t i = 0; i < ips.size(); i++) {
+        ASSERT_EQ(prefix_table_check(a, ips[i]), masks[i]) << i;
+    }
+
+    EXPECT_EQ(0, prefix_table_check_sorted(a, nullptr, 0, nullptr));
+    EXPECT_EQ(-1, prefix_table_check_sorted(nullptr, ips.data(), 1,
+                                            masks.data()));
+    EXPECT_EQ(-1, prefix_table_check_sorted(a, nullptr, 1, masks.data()));
+    EXPECT_EQ(-1, prefix_table_check_sorted(a, ips.data(), 1, nullptr));
+
+    // Global table, with a /0 at the root
+    EXPECT_EQ(-1, check_sorted(ips.data(), 1, masks.data()));
+    ASSERT_EQ(0, prefix_mgmt_init());
+    EXPECT_EQ(0, add(0, 0));
+    EXPECT_EQ(0, add(0x0A000000, 8));
+    const unsigned int sorted[] = {0x09FFFFFF, 0x0A000000, 0x0AFFFFFF,
+                                   0x0B000000};
+    char out[4];
+    ASSERT_EQ(0, check_sorted(sorted, 4, out));
+    EXPECT_EQ(0, out[0]);
+    EXPECT_EQ(8, out[1]);
+    EXPECT_EQ(8, out[2]);
+    EXPECT_EQ(0, out[3]);
+}
@@ -0,0 +1,122 @@
+#include "prefix_mgmt/table.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using prefix_mgmt::Table;
+
+static_assert(!std::is_copy_constructible<Table>::value, "copyable");
+static_assert(!std::is_copy_assignable<Table>::value, "copyable");
+static_assert(std::is_nothrow_move_constructible<Table>::value, "move");
+static_assert(std::is_nothrow_move_assignable<Table>::value, "move");
+
+// TC-CXX-1: Basic operations
+TEST(TableHppTest, Basic) {
+    Table t;
+    ASSERT_TRUE(t);
+    EXPECT_EQ(0, t.add(0x0A000000, 8));
+    EXPECT_EQ(0, t.add(0x0A140000, 16));
+    EXPECT_EQ(-1, t.add(0x0A000001, 8));
+    EXPECT_EQ(16, t.check(0x0A140001));
+    EXPECT_EQ(8, t.check(0x0A000001));
+    EXPECT_EQ(0, t.del(0x0A140000, 16));
+    EXPECT_EQ(8, t.check(0x0A140001));
+    EXPECT_EQ(1, t.del_covered(0x0A000000, 8));
+    EXPECT_EQ(-1, t.check(0x0A000001));
+
+    // Masks outside 0-32 are rejected before they reach the char argument
+    EXPECT_EQ(0, t.add(0x0A000000, 8));
+    for (int mask : {-1, 33, 256, 264, -256}) {
+        EXPECT_EQ(-1, t.add(0, mask));
+        EXPECT_EQ(-1, t.del(0, mask));
+        EXPECT_EQ(-1, t.del_covered(0, mask));
+    }
+    EXPECT_EQ(-1, t.check(0x01020304));
+    EXPECT_EQ(8, t.check(0x0A000001));
+    EXPECT_EQ(1, t.del_covered(0x0A000000, 8));
+
+    // The global table is not involved
+    EXPECT_EQ(nullptr, prefix_mgmt_table());
+
+    // Options are passed through
+    prefix_table_opts_t opts = {PREFIX_ALLOC_HUGEPAGE, 0, 0};
+    Table arena(opts);
+    EXPECT_EQ(0, arena.add(0xC0A80000, 16));
+    EXPECT_EQ(16, arena.check(0xC0A80101));
+
+    prefix_table_opts_t bad = {static_cast<prefix_alloc_mode_t>(7), 0, 0};
+    EXPECT_THROW(Table{bad}, std::bad_alloc);
+}
+
+// TC-CXX-2: Moves hand over the tree without copying it
+TEST(TableHppTest, Move) {
+    Table a;
+    a.add(0x0A000000, 8);
+    prefix_table_t *raw = a.get();
+
+    Table b(std::move(a));
+    EXPECT_EQ(raw, b.get());
+    EXPECT_FALSE(a); // NOLINT: moved-from state is specified
+    EXPECT_EQ(-1, a.check(0x0A000001));
+    EXPECT_EQ(-1, a.add(0x0A000000, 8));
+    EXPECT_EQ(8, b.check(0x0A000001));
+
+    Table c;
+    c.add(0xC0A80000, 16);
+    c = std::move(b);
+    EXPECT_EQ(raw, c.get());
+    EXPECT_EQ(8, c.check(0x0A000001));
+    EXPECT_EQ(-1, c.check(0xC0A80101));
+
+    // Moved-from objects can be reused by assignment
+    a = Table();
+    EXPECT_EQ(0, a.add(0xC0A80000, 16));
+    swap(a, c);
+    EXPECT_EQ(16, c.check(0xC0A80101));
+    EXPECT_EQ(8, a.check(0x0A000001));
+}
+
+// TC-CXX-3: Built on a worker thread, moved into place
+TEST(TableHppTest, BuildOnWorker) {
+    Table current;
+    current.add(0x0A000000, 8);
+
+    Table next;
+    std::thread worker([&next] {
+        Table built;
+        for (std::uint32_t i = 0; i < 1000; i++) {
+            built.add(0xC0000000 | (i << 8), 24);
+        }
+        next = std::move(built);
+    });
+    worker.join();
+
+    current = std::move(next);
+    EXPECT_EQ(24, current.check(0xC0000301));
+    EXPECT_EQ(-1, current.check(0x0A000001));
+}
+
+// TC-CXX-4: Batch lookups match single ones
+TEST(TableHppTest, Batch) {
+    Table t;
+    std::mt19937 rng(44);
+    for (int i = 0; i < 2000; i++) {
+        int mask = static_cast<int>(rng() % 25) + 8;
+        t.add(rng() & (~0U << (32 - mask)), mask);
+    }
+
+    std::vector<std::uint32_t> ips(5000);
+    for (std::uint32_t &ip : ips) {
+        ip = rng();
+    }
+    std::vector<std::int8_t> masks(ips.size());
+    ASSERT_EQ(0, t.check(ips.data(), ips.size(), masks.data()));
+    for (std::size_t i = 0; i < ips.size(); i++) {
+        ASSERT_EQ(t.check(ips[i]), masks[i]);
+    }
+}
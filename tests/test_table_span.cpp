@@ -0,0 +1,50 @@
+#include "prefix_mgmt/table.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#ifndef PREFIX_MGMT_HAS_SPAN
+#error "table.hpp must provide the std::span overload under C++20"
+#endif
+
+using prefix_mgmt::Table;
+
+// TC-CXX-5: std::span batch overload (C++20)
+TEST(TableSpanTest, Batch) {
+    Table t;
+    std::mt19937 rng(144);
+    for (int i = 0; i < 2000; i++) {
+        int mask = static_cast<int>(rng() % 25) + 8;
+        t.add(rng() & (~0U << (32 - mask)), mask);
+    }
+
+    std::vector<std::uint32_t> ips(5000);
+    for (std::uint32_t &ip : ips) {
+        ip = rng();
+    }
+    std::vector<std::int8_t> masks(ips.size());
+    ASSERT_EQ(0, t.check(std::span<const std::uint32_t>(ips),
+                         std::span<std::int8_t>(masks)));
+    for (std::size_t i = 0; i < ips.size(); i++) {
+        ASSERT_EQ(t.check(ips[i]), masks[i]);
+    }
+
+    // Sub-spans and fixed extents convert implicitly
+    std::int8_t few[4] = {9, 9, 9, 9};
+    ASSERT_EQ(0, t.check(std::span<const std::uint32_t>(ips).first(4), few));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(masks[i], few[i]);
+    }
+
+    // Empty input succeeds; short output and a moved-from table fail
+    EXPECT_EQ(0, t.check(std::span<const std::uint32_t>(),
+                         std::span<std::int8_t>()));
+    EXPECT_EQ(-1, t.check(std::span<const std::uint32_t>(ips),
+                          std::span<std::int8_t>(masks).first(10)));
+    Table moved(std::move(t));
+    EXPECT_EQ(-1, t.check(std::span<const std::uint32_t>(ips),
+                          std::span<std::int8_t>(masks)));
+}